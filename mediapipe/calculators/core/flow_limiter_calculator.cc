@@ -18,6 +18,7 @@
 
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/header_util.h"
@@ -109,6 +110,16 @@ class FlowLimiterCalculator : public CalculatorBase {
     }
   }
 
+  // Reports a packet dropped from an input stream to the GraphProfiler.
+  void LogDroppedPacket(int input_index, CalculatorContext* cc) {
+    mediapipe::LogEvent(
+        cc->GetProfilingContext(),
+        TraceEvent(TraceEvent::PACKET_DROPPED)
+            .set_node_id(cc->NodeId())
+            .set_stream_id(&cc->Inputs().Get("", input_index).Name())
+            .set_event_data(1));
+  }
+
   // Sets the timestamp bound or closes an output stream.
   void SetNextTimestampBound(Timestamp bound, OutputStream* stream) {
     if (bound > Timestamp::Max()) {
@@ -135,6 +146,8 @@ class FlowLimiterCalculator : public CalculatorBase {
         input_queues_[i].pop_front();
         if (IsInFlight(packet.Timestamp())) {
           cc->Outputs().Get("", i).AddPacket(packet);
+        } else {
+          LogDroppedPacket(i, cc);
         }
       }
 
@@ -200,6 +213,7 @@ class FlowLimiterCalculator : public CalculatorBase {
       Packet packet = input_queue.front();
       input_queue.pop_front();
       SendAllow(false, packet.Timestamp(), cc);
+      LogDroppedPacket(0, cc);
     }
 
     // Propagate the input timestamp bound.
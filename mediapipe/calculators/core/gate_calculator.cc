@@ -128,6 +128,7 @@ class GateCalculator : public CalculatorBase {
     if (cc->Outputs().HasTag("STATE_CHANGE")) {
       cc->Outputs().Tag("STATE_CHANGE").Set<bool>();
     }
+    cc->SetRunInline(true);
 
     return absl::OkStatus();
   }
@@ -43,6 +43,7 @@ class MakePairCalculator : public Node {
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
     RET_CHECK_EQ(kIn(cc).Count(), 2);
+    cc->SetRunInline(true);
     return absl::OkStatus();
   }
 
@@ -52,6 +52,7 @@ class PacketClonerCalculator : public CalculatorBase {
       cc->Outputs().Index(i).SetSameAs(&cc->Inputs().Index(i));
     }
     cc->Inputs().Index(tick_signal_index).SetAny();
+    cc->SetRunInline(true);
     return absl::OkStatus();
   }
 
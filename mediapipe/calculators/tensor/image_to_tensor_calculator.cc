@@ -18,7 +18,7 @@
 
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
-#include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -82,6 +82,10 @@ using GpuBuffer = mediapipe::GpuBuffer;
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     The tensor is kFloat32 for output_tensor_float_range, kUInt8 for
+//     output_tensor_uint_range and kInt8 for output_tensor_int_range. Integer
+//     ranges are supported on CPU only. Integer tensors carry quantization
+//     parameters that map their values to pixel values in [0, 1].
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix which
 //     can be used to map a point on the output tensor to a point on the input
@@ -138,11 +142,40 @@ class ImageToTensorCalculator : public Node {
     const auto& options =
         cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
 
-    RET_CHECK(options.has_output_tensor_float_range())
+    RET_CHECK(options.has_output_tensor_float_range() ||
+              options.has_output_tensor_uint_range() ||
+              options.has_output_tensor_int_range())
         << "Output tensor range is required.";
-    RET_CHECK_LT(options.output_tensor_float_range().min(),
-                 options.output_tensor_float_range().max())
-        << "Valid output tensor range is required.";
+    if (options.has_output_tensor_float_range()) {
+      RET_CHECK_LT(options.output_tensor_float_range().min(),
+                   options.output_tensor_float_range().max())
+          << "Valid output tensor range is required.";
+    }
+    if (options.has_output_tensor_uint_range()) {
+      RET_CHECK_LT(options.output_tensor_uint_range().min(),
+                   options.output_tensor_uint_range().max())
+          << "Valid output tensor range is required.";
+      RET_CHECK_GE(options.output_tensor_uint_range().min(), 0)
+          << "The minimum of the output tensor range must be non-negative.";
+      RET_CHECK_LE(options.output_tensor_uint_range().max(), 255)
+          << "The maximum of the output tensor range must be less than or "
+             "equal to 255.";
+    }
+    if (options.has_output_tensor_int_range()) {
+      RET_CHECK_LT(options.output_tensor_int_range().min(),
+                   options.output_tensor_int_range().max())
+          << "Valid output tensor range is required.";
+      RET_CHECK_GE(options.output_tensor_int_range().min(), -128)
+          << "The minimum of the output tensor range must be greater than or "
+             "equal to -128.";
+      RET_CHECK_LE(options.output_tensor_int_range().max(), 127)
+          << "The maximum of the output tensor range must be less than or "
+             "equal to 127.";
+    }
+    if (!options.has_output_tensor_float_range()) {
+      RET_CHECK(!kInGpu(cc).IsConnected())
+          << "Integer output tensor ranges are supported on CPU only.";
+    }
     RET_CHECK_GT(options.output_tensor_width(), 0)
         << "Valid output tensor width is required.";
     RET_CHECK_GT(options.output_tensor_height(), 0)
@@ -171,8 +204,21 @@ class ImageToTensorCalculator : public Node {
     options_ = cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
     output_width_ = options_.output_tensor_width();
     output_height_ = options_.output_tensor_height();
-    range_min_ = options_.output_tensor_float_range().min();
-    range_max_ = options_.output_tensor_float_range().max();
+    if (options_.has_output_tensor_uint_range()) {
+      range_min_ =
+          static_cast<float>(options_.output_tensor_uint_range().min());
+      range_max_ =
+          static_cast<float>(options_.output_tensor_uint_range().max());
+      tensor_type_ = Tensor::ElementType::kUInt8;
+    } else if (options_.has_output_tensor_int_range()) {
+      range_min_ = static_cast<float>(options_.output_tensor_int_range().min());
+      range_max_ = static_cast<float>(options_.output_tensor_int_range().max());
+      tensor_type_ = Tensor::ElementType::kInt8;
+    } else {
+      range_min_ = options_.output_tensor_float_range().min();
+      range_max_ = options_.output_tensor_float_range().max();
+      tensor_type_ = Tensor::ElementType::kFloat32;
+    }
 
     return absl::OkStatus();
   }
@@ -282,6 +328,8 @@ class ImageToTensorCalculator : public Node {
   absl::Status InitConverterIfNecessary(CalculatorContext* cc, bool use_gpu) {
     // Lazy initialization of the GPU or CPU converter.
     if (use_gpu) {
+      RET_CHECK(tensor_type_ == Tensor::ElementType::kFloat32)
+          << "Integer output tensor ranges are supported on CPU only.";
       if (!gpu_converter_) {
 #if !MEDIAPIPE_DISABLE_GPU
 #if MEDIAPIPE_METAL_ENABLED
@@ -301,7 +349,8 @@ class ImageToTensorCalculator : public Node {
     } else {
       if (!cpu_converter_) {
         ASSIGN_OR_RETURN(cpu_converter_,
-                         CreateOpenCvConverter(cc, GetBorderMode()));
+                         CreateFusedConverter(cc, GetBorderMode(),
+                                              tensor_type_));
       }
     }
     return absl::OkStatus();
@@ -314,6 +363,7 @@ class ImageToTensorCalculator : public Node {
   int output_height_ = 0;
   float range_min_ = 0.0f;
   float range_max_ = 1.0f;
+  Tensor::ElementType tensor_type_ = Tensor::ElementType::kFloat32;
 };
 
 MEDIAPIPE_REGISTER_NODE(ImageToTensorCalculator);
@@ -433,5 +433,89 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeBorderZero) {
           BorderMode::kZero, roi);
 }
 
+// Runs the calculator over the whole image with an integer output range and
+// checks the tensor type and values. @range_name is "output_tensor_uint_range"
+// or "output_tensor_int_range".
+void RunIntegerRangeTest(absl::string_view range_name, int range_min,
+                         int range_max, Tensor::ElementType expected_type) {
+  cv::Mat input = GetRgba(
+      "/mediapipe/calculators/tensor/testdata/image_to_tensor/input.jpg");
+  cv::Mat expected_result = GetRgb(
+      "/mediapipe/calculators/"
+      "tensor/testdata/image_to_tensor/noop_except_range.png");
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"(
+        input_stream: "input_image"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 64
+              output_tensor_height: 128
+              keep_aspect_ratio: true
+              $0 {
+                min: $1
+                max: $2
+              }
+            }
+          }
+        }
+        )",
+                       range_name, range_min, range_max));
+
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("input_image", MakeImagePacket(input)));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_THAT(tensor_vec, testing::SizeIs(1));
+  const Tensor& tensor = tensor_vec[0];
+  EXPECT_EQ(tensor.element_type(), expected_type);
+  // Quantized values map back to pixel values in [0, 1].
+  EXPECT_FLOAT_EQ(tensor.quantization_parameters().scale,
+                  1.0f / (range_max - range_min));
+  EXPECT_EQ(tensor.quantization_parameters().zero_point, range_min);
+
+  auto view = tensor.GetCpuReadView();
+  cv::Mat tensor_mat(
+      128, 64,
+      expected_type == Tensor::ElementType::kUInt8 ? CV_8UC3 : CV_8SC3,
+      const_cast<void*>(view.buffer<void>()));
+  cv::Mat result_rgb;
+  auto transformation =
+      GetValueRangeTransformation(range_min, range_max, 0.0f, 255.0f).value();
+  tensor_mat.convertTo(result_rgb, CV_8UC3, transformation.scale,
+                       transformation.offset);
+
+  cv::Mat diff;
+  cv::absdiff(result_rgb, expected_result, diff);
+  double max_val;
+  cv::minMaxLoc(diff, nullptr, &max_val);
+  EXPECT_LE(max_val, 5);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(ImageToTensorCalculatorTest, NoOpExceptRangeUInt8) {
+  RunIntegerRangeTest("output_tensor_uint_range", 0, 255,
+                      Tensor::ElementType::kUInt8);
+}
+
+TEST(ImageToTensorCalculatorTest, NoOpExceptRangeInt8) {
+  RunIntegerRangeTest("output_tensor_int_range", -128, 127,
+                      Tensor::ElementType::kInt8);
+}
+
 }  // namespace
 }  // namespace mediapipe
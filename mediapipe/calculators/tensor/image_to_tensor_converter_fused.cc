@@ -0,0 +1,376 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/statusor.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MEDIAPIPE_FUSED_CONVERTER_SSE 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MEDIAPIPE_FUSED_CONVERTER_NEON 1
+#endif
+
+namespace mediapipe {
+
+namespace {
+
+constexpr int kNumChannels = 3;
+
+// 8-bit RGB or RGBA source pixels.
+struct SourceImage {
+  const uint8_t* data;
+  int width;
+  int height;
+  int step;
+  int channels;
+};
+
+// Returns the RGB channels at |p| packed into the low three bytes.
+inline uint32_t PackRgb(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16);
+}
+
+// Same as PackRgb, for a pixel with |kChannels| channels. The alpha channel of
+// RGBA pixels is kept in the high byte and ignored by the callers.
+template <int kChannels>
+inline uint32_t LoadRgb(const uint8_t* p) {
+  if (kChannels == 4) {
+    uint32_t rgba;
+    std::memcpy(&rgba, p, sizeof(rgba));
+    return rgba;
+  }
+  return PackRgb(p);
+}
+
+// Returns the packed RGB channels of pixel (x, y). Pixels outside of the image
+// are either replicated from the closest edge pixel or zero.
+inline uint32_t LoadPixel(const SourceImage& image, int x, int y,
+                          bool replicate) {
+  if (x < 0 || y < 0 || x >= image.width || y >= image.height) {
+    if (!replicate) return 0;
+    x = std::min(std::max(x, 0), image.width - 1);
+    y = std::min(std::max(y, 0), image.height - 1);
+  }
+  return PackRgb(image.data + y * image.step + x * image.channels);
+}
+
+// Four float lanes holding the R, G, B channels of a pixel (the fourth lane is
+// unused), with the few operations the kernel needs.
+#if MEDIAPIPE_FUSED_CONVERTER_SSE
+
+using PixelF = __m128;
+
+inline PixelF Unpack(uint32_t rgb) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(rgb));
+  return _mm_cvtepi32_ps(
+      _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+}
+inline PixelF Broadcast(float value) { return _mm_set1_ps(value); }
+// Returns a + (b - a) * t.
+inline PixelF Lerp(PixelF a, PixelF b, PixelF t) {
+  return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+// Returns a * b + c.
+inline PixelF MulAdd(PixelF a, PixelF b, PixelF c) {
+  return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+inline void StoreFloats(PixelF value, float* out) {
+  _mm_storeu_ps(out, value);
+}
+// Rounds to nearest even and saturates each lane to 8 bits.
+inline uint32_t PackUInt8(PixelF value) {
+  __m128i packed = _mm_cvtps_epi32(value);
+  packed = _mm_packs_epi32(packed, packed);
+  return static_cast<uint32_t>(
+      _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed)));
+}
+inline uint32_t PackInt8(PixelF value) {
+  __m128i packed = _mm_cvtps_epi32(value);
+  packed = _mm_packs_epi32(packed, packed);
+  return static_cast<uint32_t>(
+      _mm_cvtsi128_si32(_mm_packs_epi16(packed, packed)));
+}
+
+#elif MEDIAPIPE_FUSED_CONVERTER_NEON
+
+using PixelF = float32x4_t;
+
+inline PixelF Unpack(uint32_t rgb) {
+  const uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(rgb));
+  return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+}
+inline PixelF Broadcast(float value) { return vdupq_n_f32(value); }
+inline PixelF Lerp(PixelF a, PixelF b, PixelF t) {
+  return vmlaq_f32(a, vsubq_f32(b, a), t);
+}
+inline PixelF MulAdd(PixelF a, PixelF b, PixelF c) {
+  return vmlaq_f32(c, a, b);
+}
+inline void StoreFloats(PixelF value, float* out) { vst1q_f32(out, value); }
+inline uint32_t PackUInt8(PixelF value) {
+  const int16x4_t narrow = vqmovn_s32(vcvtnq_s32_f32(value));
+  return vget_lane_u32(
+      vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(narrow, narrow))), 0);
+}
+inline uint32_t PackInt8(PixelF value) {
+  const int16x4_t narrow = vqmovn_s32(vcvtnq_s32_f32(value));
+  return vget_lane_u32(
+      vreinterpret_u32_s8(vqmovn_s16(vcombine_s16(narrow, narrow))), 0);
+}
+
+#else
+
+struct PixelF {
+  float lanes[4];
+};
+
+inline PixelF Unpack(uint32_t rgb) {
+  return {{static_cast<float>(rgb & 0xff),
+           static_cast<float>((rgb >> 8) & 0xff),
+           static_cast<float>((rgb >> 16) & 0xff), 0.0f}};
+}
+inline PixelF Broadcast(float value) { return {{value, value, value, value}}; }
+inline PixelF Lerp(PixelF a, PixelF b, PixelF t) {
+  PixelF result;
+  for (int i = 0; i < 4; ++i) {
+    result.lanes[i] = a.lanes[i] + (b.lanes[i] - a.lanes[i]) * t.lanes[i];
+  }
+  return result;
+}
+inline PixelF MulAdd(PixelF a, PixelF b, PixelF c) {
+  PixelF result;
+  for (int i = 0; i < 4; ++i) {
+    result.lanes[i] = a.lanes[i] * b.lanes[i] + c.lanes[i];
+  }
+  return result;
+}
+inline void StoreFloats(PixelF value, float* out) {
+  std::memcpy(out, value.lanes, sizeof(value.lanes));
+}
+inline uint32_t PackSaturated(PixelF value, float min, float max,
+                              uint32_t mask) {
+  uint32_t packed = 0;
+  for (int i = 0; i < 4; ++i) {
+    const float rounded =
+        std::min(std::max(std::nearbyint(value.lanes[i]), min), max);
+    packed |= (static_cast<uint32_t>(static_cast<int>(rounded)) & mask)
+              << (8 * i);
+  }
+  return packed;
+}
+inline uint32_t PackUInt8(PixelF value) {
+  return PackSaturated(value, 0.0f, 255.0f, 0xff);
+}
+inline uint32_t PackInt8(PixelF value) {
+  return PackSaturated(value, -128.0f, 127.0f, 0xff);
+}
+
+#endif  // MEDIAPIPE_FUSED_CONVERTER_SSE
+
+// Writes the RGB channels of |value| to |out|. Unless |last|, four elements
+// are written; the fourth one belongs to the next pixel and is overwritten
+// when that pixel is stored.
+inline void StorePixel(PixelF value, bool last, float* out) {
+  if (!last) {
+    StoreFloats(value, out);
+  } else {
+    float lanes[4];
+    StoreFloats(value, lanes);
+    std::memcpy(out, lanes, kNumChannels * sizeof(float));
+  }
+}
+
+inline void StorePackedPixel(uint32_t packed, bool last, void* out) {
+  if (!last) {
+    std::memcpy(out, &packed, 4);
+  } else {
+    std::memcpy(out, &packed, kNumChannels);
+  }
+}
+
+inline void StorePixel(PixelF value, bool last, uint8_t* out) {
+  StorePackedPixel(PackUInt8(value), last, out);
+}
+
+inline void StorePixel(PixelF value, bool last, int8_t* out) {
+  StorePackedPixel(PackInt8(value), last, out);
+}
+
+// Samples |roi| of |image| into an |output_dims| RGB tensor, applying
+// |transform| to the 0-255 pixel values. |image| has |kChannels| channels.
+template <typename T, int kChannels>
+void ConvertRoi(const SourceImage& image, const RotatedRect& roi,
+                const Size& output_dims, bool replicate,
+                const ValueTransformation& transform, T* out) {
+  const float cos_r = std::cos(roi.rotation);
+  const float sin_r = std::sin(roi.rotation);
+  // Output pixel (x, y) samples the image at origin + x * step_x + y * step_y,
+  // which maps the output corners onto the ROI corners like the OpenCV
+  // converter does.
+  const float unit_x = roi.width / output_dims.width;
+  const float unit_y = roi.height / output_dims.height;
+  const float step_x_x = cos_r * unit_x;
+  const float step_x_y = sin_r * unit_x;
+  const float step_y_x = -sin_r * unit_y;
+  const float step_y_y = cos_r * unit_y;
+  const float origin_x =
+      roi.center_x - 0.5f * (roi.width * cos_r - roi.height * sin_r);
+  const float origin_y =
+      roi.center_y - 0.5f * (roi.width * sin_r + roi.height * cos_r);
+
+  const PixelF scale = Broadcast(transform.scale);
+  const PixelF offset = Broadcast(transform.offset);
+  for (int y = 0; y < output_dims.height; ++y) {
+    const float row_x = origin_x + y * step_y_x;
+    const float row_y = origin_y + y * step_y_y;
+    const bool last_row = y == output_dims.height - 1;
+    for (int x = 0; x < output_dims.width; ++x) {
+      const float src_x = row_x + x * step_x_x;
+      const float src_y = row_y + x * step_x_y;
+      const float floor_x = std::floor(src_x);
+      const float floor_y = std::floor(src_y);
+      const int x0 = static_cast<int>(floor_x);
+      const int y0 = static_cast<int>(floor_y);
+      uint32_t top_left, top_right, bottom_left, bottom_right;
+      if (x0 >= 0 && y0 >= 0 && x0 + 1 < image.width &&
+          y0 + 1 < image.height) {
+        const uint8_t* top = image.data + y0 * image.step + x0 * kChannels;
+        const uint8_t* bottom = top + image.step;
+        top_left = LoadRgb<kChannels>(top);
+        top_right = LoadRgb<kChannels>(top + kChannels);
+        bottom_left = LoadRgb<kChannels>(bottom);
+        bottom_right = LoadRgb<kChannels>(bottom + kChannels);
+      } else {
+        top_left = LoadPixel(image, x0, y0, replicate);
+        top_right = LoadPixel(image, x0 + 1, y0, replicate);
+        bottom_left = LoadPixel(image, x0, y0 + 1, replicate);
+        bottom_right = LoadPixel(image, x0 + 1, y0 + 1, replicate);
+      }
+      const PixelF weight_x = Broadcast(src_x - floor_x);
+      const PixelF weight_y = Broadcast(src_y - floor_y);
+      const PixelF top_value =
+          Lerp(Unpack(top_left), Unpack(top_right), weight_x);
+      const PixelF bottom_value =
+          Lerp(Unpack(bottom_left), Unpack(bottom_right), weight_x);
+      const PixelF value =
+          MulAdd(Lerp(top_value, bottom_value, weight_y), scale, offset);
+      StorePixel(value, last_row && x == output_dims.width - 1, out);
+      out += kNumChannels;
+    }
+  }
+}
+
+class FusedProcessor : public ImageToTensorConverter {
+ public:
+  FusedProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
+      : replicate_border_(border_mode == BorderMode::kReplicate),
+        tensor_type_(tensor_type) {}
+
+  absl::StatusOr<Tensor> Convert(const mediapipe::Image& input,
+                                 const RotatedRect& roi,
+                                 const Size& output_dims, float range_min,
+                                 float range_max) override {
+    if (input.image_format() != mediapipe::ImageFormat::SRGB &&
+        input.image_format() != mediapipe::ImageFormat::SRGBA) {
+      return InvalidArgumentError(
+          absl::StrCat("Only RGBA/RGB formats are supported, passed format: ",
+                       static_cast<uint32_t>(input.image_format())));
+    }
+    constexpr float kInputImageRangeMin = 0.0f;
+    constexpr float kInputImageRangeMax = 255.0f;
+    ASSIGN_OR_RETURN(
+        auto transform,
+        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                    range_min, range_max));
+
+    mediapipe::PixelReadLock lock(input);
+    const SourceImage image = {lock.Pixels(), input.width(), input.height(),
+                               input.step(), input.channels()};
+    RET_CHECK(image.data) << "Image pixels are not available on CPU.";
+
+    Tensor tensor(
+        tensor_type_,
+        Tensor::Shape{1, output_dims.height, output_dims.width, kNumChannels},
+        GetQuantizationParameters(tensor_type_, range_min, range_max));
+    auto buffer_view = tensor.GetCpuWriteView();
+    switch (tensor_type_) {
+      case Tensor::ElementType::kUInt8:
+        Convert(image, roi, output_dims, transform,
+                buffer_view.buffer<uint8_t>());
+        break;
+      case Tensor::ElementType::kInt8:
+        Convert(image, roi, output_dims, transform,
+                buffer_view.buffer<int8_t>());
+        break;
+      default:
+        Convert(image, roi, output_dims, transform,
+                buffer_view.buffer<float>());
+        break;
+    }
+    return tensor;
+  }
+
+ private:
+  template <typename T>
+  void Convert(const SourceImage& image, const RotatedRect& roi,
+               const Size& output_dims, const ValueTransformation& transform,
+               T* out) {
+    if (image.channels == 4) {
+      ConvertRoi<T, 4>(image, roi, output_dims, replicate_border_, transform,
+                       out);
+    } else {
+      ConvertRoi<T, 3>(image, roi, output_dims, replicate_border_, transform,
+                       out);
+    }
+  }
+
+  bool replicate_border_;
+  Tensor::ElementType tensor_type_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateFusedConverter(
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type) {
+  RET_CHECK(tensor_type == Tensor::ElementType::kFloat32 ||
+            tensor_type == Tensor::ElementType::kUInt8 ||
+            tensor_type == Tensor::ElementType::kInt8)
+      << "Unsupported output tensor type.";
+  return std::unique_ptr<ImageToTensorConverter>(
+      absl::make_unique<FusedProcessor>(border_mode, tensor_type));
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,174 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Tests the fused converter against the OpenCV converter and benchmarks both.
+// $ bazel run -c opt \
+//   mediapipe/calculators/tensor:image_to_tensor_converter_fused_test -- \
+//   --benchmark_filter=all
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_fused.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns an image filled with a smooth gradient plus noise, so that
+// interpolation differences show up but stay small.
+Image MakeImage(ImageFormat::Format format, int width, int height) {
+  auto frame = std::make_shared<ImageFrame>(format, width, height);
+  const int channels = frame->NumberOfChannels();
+  std::mt19937 rng(0);
+  for (int y = 0; y < height; ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < channels; ++c) {
+        row[x * channels + c] = (x * 3 + y * 5 + c * 60 + rng() % 8) % 256;
+      }
+    }
+  }
+  return Image(std::move(frame));
+}
+
+// Returns channel |i| of |tensor| as a float.
+float GetValue(const Tensor& tensor, const Tensor::CpuReadView& view, int i) {
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kUInt8:
+      return view.buffer<uint8_t>()[i];
+    case Tensor::ElementType::kInt8:
+      return view.buffer<int8_t>()[i];
+    default:
+      return view.buffer<float>()[i];
+  }
+}
+
+struct ConverterTestCase {
+  ImageFormat::Format format;
+  BorderMode border_mode;
+  Tensor::ElementType tensor_type;
+  float range_min;
+  float range_max;
+};
+
+class FusedConverterTest : public testing::TestWithParam<ConverterTestCase> {};
+
+TEST_P(FusedConverterTest, MatchesOpenCvConverter) {
+  const ConverterTestCase& test_case = GetParam();
+  const Image image = MakeImage(test_case.format, 120, 90);
+  auto fused = CreateFusedConverter(nullptr, test_case.border_mode,
+                                    test_case.tensor_type);
+  MP_ASSERT_OK(fused);
+  auto opencv = CreateOpenCvConverter(nullptr, test_case.border_mode,
+                                      test_case.tensor_type);
+  MP_ASSERT_OK(opencv);
+  // Covers an inner crop, a rotated crop and a crop reaching past the border.
+  const RotatedRect rois[] = {{60.0f, 45.0f, 50.0f, 40.0f, 0.0f},
+                              {60.0f, 45.0f, 70.0f, 50.0f, 0.6f},
+                              {20.0f, 80.0f, 90.0f, 60.0f, -1.2f}};
+  const Size output_dims = {32, 24};
+  // Two 8-bit input levels, mapped to the output range.
+  const float tolerance =
+      2.0f * (test_case.range_max - test_case.range_min) / 255.0f;
+  for (const RotatedRect& roi : rois) {
+    auto expected_or = (*opencv)->Convert(
+        image, roi, output_dims, test_case.range_min, test_case.range_max);
+    MP_ASSERT_OK(expected_or);
+    auto actual_or = (*fused)->Convert(image, roi, output_dims,
+                                       test_case.range_min, test_case.range_max);
+    MP_ASSERT_OK(actual_or);
+    const Tensor& expected = *expected_or;
+    const Tensor& actual = *actual_or;
+    ASSERT_EQ(actual.element_type(), test_case.tensor_type);
+    ASSERT_EQ(actual.shape().dims, expected.shape().dims);
+    // Integer values map back to pixel values in [0, 1].
+    const bool is_float =
+        test_case.tensor_type == Tensor::ElementType::kFloat32;
+    EXPECT_FLOAT_EQ(
+        actual.quantization_parameters().scale,
+        is_float ? 1.0f : 1.0f / (test_case.range_max - test_case.range_min));
+    EXPECT_EQ(actual.quantization_parameters().zero_point,
+              is_float ? 0 : static_cast<int>(test_case.range_min));
+    EXPECT_EQ(actual.quantization_parameters().zero_point,
+              expected.quantization_parameters().zero_point);
+    auto expected_view = expected.GetCpuReadView();
+    auto actual_view = actual.GetCpuReadView();
+    float max_diff = 0.0f;
+    for (int i = 0; i < actual.shape().num_elements(); ++i) {
+      max_diff = std::max(max_diff,
+                          std::abs(GetValue(actual, actual_view, i) -
+                                   GetValue(expected, expected_view, i)));
+    }
+    EXPECT_LE(max_diff, tolerance) << "rotation: " << roi.rotation;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FusedConverterTests, FusedConverterTest,
+    testing::Values(
+        ConverterTestCase{ImageFormat::SRGB, BorderMode::kReplicate,
+                          Tensor::ElementType::kFloat32, 0.0f, 1.0f},
+        ConverterTestCase{ImageFormat::SRGBA, BorderMode::kReplicate,
+                          Tensor::ElementType::kFloat32, -1.0f, 1.0f},
+        ConverterTestCase{ImageFormat::SRGBA, BorderMode::kZero,
+                          Tensor::ElementType::kFloat32, 0.0f, 1.0f},
+        ConverterTestCase{ImageFormat::SRGB, BorderMode::kZero,
+                          Tensor::ElementType::kUInt8, 0.0f, 255.0f},
+        ConverterTestCase{ImageFormat::SRGBA, BorderMode::kReplicate,
+                          Tensor::ElementType::kInt8, -128.0f, 127.0f}));
+
+// Converts a rotated crop of a 1280x720 RGBA frame into a 256x256 float
+// tensor. Compare BM_ConvertOpenCv with BM_ConvertFused.
+void RunConverterBenchmark(benchmark::State& state,
+                           ImageToTensorConverter* converter) {
+  const Image image = MakeImage(ImageFormat::SRGBA, 1280, 720);
+  const RotatedRect roi = {640.0f, 360.0f, 600.0f, 600.0f, 0.3f};
+  for (auto _ : state) {
+    auto tensor = converter->Convert(image, roi, {256, 256}, -1.0f, 1.0f);
+    CHECK(tensor.ok());
+  }
+  state.SetItemsProcessed(state.iterations() * 256 * 256);
+}
+
+void BM_ConvertOpenCv(benchmark::State& state) {
+  auto converter =
+      CreateOpenCvConverter(nullptr, BorderMode::kReplicate,
+                            Tensor::ElementType::kFloat32)
+          .value();
+  RunConverterBenchmark(state, converter.get());
+}
+BENCHMARK(BM_ConvertOpenCv);
+
+void BM_ConvertFused(benchmark::State& state) {
+  auto converter = CreateFusedConverter(nullptr, BorderMode::kReplicate,
+                                        Tensor::ElementType::kFloat32)
+                       .value();
+  RunConverterBenchmark(state, converter.get());
+}
+BENCHMARK(BM_ConvertFused);
+
+}  // namespace
+}  // namespace mediapipe
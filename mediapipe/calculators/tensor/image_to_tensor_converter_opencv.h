@@ -24,8 +24,10 @@
 namespace mediapipe {
 
 // Creates OpenCV image-to-tensor converter.
+// @tensor_type must be one of kFloat32, kUInt8 or kInt8.
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
-    CalculatorContext* cc, BorderMode border_mode);
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type);
 
 }  // namespace mediapipe
 
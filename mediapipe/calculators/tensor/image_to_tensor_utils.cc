@@ -88,6 +88,15 @@ absl::StatusOr<ValueTransformation> GetValueRangeTransformation(
   return ValueTransformation{scale, offset};
 }
 
+Tensor::QuantizationParameters GetQuantizationParameters(
+    Tensor::ElementType tensor_type, float range_min, float range_max) {
+  if (tensor_type == Tensor::ElementType::kFloat32) {
+    return Tensor::QuantizationParameters();
+  }
+  return Tensor::QuantizationParameters(1.0f / (range_max - range_min),
+                                        static_cast<int>(range_min));
+}
+
 void GetRotatedSubRectToRectTransformMatrix(const RotatedRect& sub_rect,
                                             int rect_width, int rect_height,
                                             bool flip_horizontaly,
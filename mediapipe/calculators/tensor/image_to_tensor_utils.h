@@ -19,6 +19,7 @@
 
 #include "absl/types/optional.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
@@ -59,6 +60,12 @@ absl::StatusOr<ValueTransformation> GetValueRangeTransformation(
     float from_range_min, float from_range_max, float to_range_min,
     float to_range_max);
 
+// Returns the quantization parameters of an image tensor of @tensor_type,
+// whose values in [range_min, range_max] represent pixel values in [0, 1].
+// kFloat32 tensors hold those values directly and get default parameters.
+Tensor::QuantizationParameters GetQuantizationParameters(
+    Tensor::ElementType tensor_type, float range_min, float range_max);
+
 // Populates 4x4 "matrix" with row major order transformation matrix which
 // maps (x, y) in range [0, 1] (describing points of @sub_rect)
 // to (x', y') in range [0, 1]*** (describing points of a rect:
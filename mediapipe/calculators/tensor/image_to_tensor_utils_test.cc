@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
@@ -157,5 +158,20 @@ TEST(GetValueRangeTransformation, FloatToPixel) {
               EqValueTransformation(/*scale=*/255.0f, /*offset=*/0.0f));
 }
 
+TEST(GetQuantizationParameters, Float) {
+  const Tensor::QuantizationParameters params = GetQuantizationParameters(
+      Tensor::ElementType::kFloat32, /*range_min=*/-1.0f, /*range_max=*/1.0f);
+  EXPECT_EQ(params.scale, 1.0f);
+  EXPECT_EQ(params.zero_point, 0);
+}
+
+TEST(GetQuantizationParameters, Int8) {
+  const Tensor::QuantizationParameters params = GetQuantizationParameters(
+      Tensor::ElementType::kInt8, /*range_min=*/-128.0f, /*range_max=*/127.0f);
+  // Maps -128 to pixel value 0 and 127 to pixel value 1.
+  EXPECT_FLOAT_EQ(params.scale, 1.0f / 255.0f);
+  EXPECT_EQ(params.zero_point, -128);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -37,8 +37,10 @@ class InferenceCalculatorSelectorImpl
             subgraph_node);
     std::vector<absl::string_view> impls;
     const bool should_use_gpu =
-        !options.has_delegate() ||  // Use GPU delegate if not specified
-        (options.has_delegate() && options.delegate().has_gpu());
+        (!options.has_delegate() ||  // Use GPU delegate if not specified
+         (options.has_delegate() && options.delegate().has_gpu())) &&
+        // Batching and interpreter pools are only supported on CPU.
+        options.batch_size() == 1 && options.num_interpreters() == 1;
     if (should_use_gpu) {
       impls.emplace_back("Metal");
       impls.emplace_back("Gl");
@@ -91,6 +91,16 @@ namespace api2 {
 // IMPORTANT Notes:
 //  Tensors are assumed to be ordered correctly (sequentially added to model).
 //  Input tensors are assumed to be of the correct size and already normalized.
+//  With batch_size > 1 (CPU only), the input tensors of consecutive packets
+//  are stacked along the first dimension and each output packet is sent at
+//  the timestamp of its input once the batch is run.
+//  With num_interpreters > 1 (CPU only) and max_in_flight > 1 on the node,
+//  timestamps run concurrently on a pool of interpreters.
+//  Without batching, the CPU backend binds the input and output Tensor
+//  buffers directly to the interpreter instead of copying them.
+//  The CPU backend keeps its interpreters across runs of the same graph
+//  (see CalculatorBase::Reset) while the model is unchanged and no custom op
+//  resolver is used.
 
 class InferenceCalculator : public NodeIntf {
  public:
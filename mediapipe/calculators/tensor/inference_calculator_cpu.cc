@@ -12,12 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 
 #if defined(MEDIAPIPE_ANDROID)
@@ -37,7 +40,8 @@ namespace {
 
 // Returns number of threads to configure XNNPACK delegate with.
 // (Equal to user provided value if specified.  Otherwise, it returns number of
-// high cores (hard-coded to 1 for Emscripten without Threads extension))
+// high cores shared among the interpreters (hard-coded to 1 for Emscripten
+// without Threads extension))
 int GetXnnpackNumThreads(const mediapipe::InferenceCalculatorOptions& opts) {
   static constexpr int kDefaultNumThreads = -1;
   if (opts.has_delegate() && opts.delegate().has_xnnpack() &&
@@ -45,12 +49,72 @@ int GetXnnpackNumThreads(const mediapipe::InferenceCalculatorOptions& opts) {
     return opts.delegate().xnnpack().num_threads();
   }
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
-  return InferHigherCoreIds().size();
+  return std::max<int>(
+      1, InferHigherCoreIds().size() / std::max(1, opts.num_interpreters()));
 #else
   return 1;
 #endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
 }
 
+// Returns the Tensor element type that holds values of a TfLite tensor type.
+absl::StatusOr<Tensor::ElementType> GetElementType(TfLiteType type) {
+  switch (type) {
+    case kTfLiteFloat16:
+      return Tensor::ElementType::kFloat16;
+    case kTfLiteFloat32:
+      return Tensor::ElementType::kFloat32;
+    case kTfLiteUInt8:
+      return Tensor::ElementType::kUInt8;
+    case kTfLiteInt8:
+      return Tensor::ElementType::kInt8;
+    case kTfLiteInt32:
+      return Tensor::ElementType::kInt32;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported TfLite tensor type: ", TfLiteTypeGetName(type)));
+  }
+}
+
+// Returns true if the interpreter may run with |tensor| backed by a caller
+// provided buffer.
+bool CanBindTensor(const TfLiteTensor* tensor) {
+  return tensor->allocation_type == kTfLiteArenaRw ||
+         tensor->allocation_type == kTfLiteCustom;
+}
+
+// Returns true if the shape of output |tensor| is known before Invoke, so
+// that a Tensor allocated up front can hold it.
+bool HasStaticShape(const TfLiteTensor* tensor) {
+  const TfLiteIntArray* signature = tensor->dims_signature;
+  if (signature == nullptr) return true;
+  return std::find(signature->data, signature->data + signature->size, -1) ==
+         signature->data + signature->size;
+}
+
+// Returns true if |data| satisfies the alignment TfLite requires of custom
+// allocations.
+bool IsAlignedForTfLite(const void* data) {
+  return reinterpret_cast<uintptr_t>(data) % Tensor::kCpuBufferAlignment == 0;
+}
+
+// Binds |data| as the buffer of interpreter tensor |tensor_index|, unless it
+// is already bound to it as |*bound_data|. Sets |*rebound| if the binding
+// changed.
+absl::Status BindTensor(tflite::Interpreter* interpreter, int tensor_index,
+                        void* data, size_t bytes, void** bound_data,
+                        bool* rebound) {
+  if (*bound_data == data) {
+    return absl::OkStatus();
+  }
+  TfLiteCustomAllocation allocation = {data, bytes};
+  RET_CHECK_EQ(
+      interpreter->SetCustomAllocationForTensor(tensor_index, allocation),
+      kTfLiteOk);
+  *bound_data = data;
+  *rebound = true;
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 class InferenceCalculatorCpuImpl
@@ -61,15 +125,77 @@ class InferenceCalculatorCpuImpl
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
   absl::Status Close(CalculatorContext* cc) override;
+  // Keeps the interpreters for the next graph run.
+  bool Reset() override;
 
  private:
-  absl::Status LoadModel(CalculatorContext* cc);
-  absl::Status LoadDelegate(CalculatorContext* cc);
+  // An interpreter and the delegate it runs with. The delegate and the bound
+  // buffers are declared first so that they outlive the interpreter.
+  struct InterpreterState {
+    TfLiteDelegatePtr delegate;
+    // Model sized, aligned copies of bound inputs whose Tensor buffer is
+    // misaligned or smaller than the model input.
+    std::vector<std::unique_ptr<Tensor>> input_scratch;
+    // The buffers of the last run stay bound until the next one, so the
+    // packets holding them are kept.
+    Packet<std::vector<Tensor>> bound_input_packet;
+    std::vector<Tensor> bound_output_tensors;
+    Packet<std::vector<Tensor>> bound_output_packet;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    // Whether each interpreter input/output runs directly on the buffer of
+    // the corresponding Tensor. Set up by PrepareBindings.
+    std::vector<bool> bind_inputs;
+    std::vector<bool> bind_outputs;
+    // The buffers currently bound to each interpreter input/output.
+    std::vector<void*> bound_input_data;
+    std::vector<void*> bound_output_data;
+    bool bindings_prepared = false;
+  };
+
+  // Returns true if the interpreters kept from the previous graph run were
+  // built from the model and op resolver of this run.
+  bool CanReuseInterpreters(CalculatorContext* cc);
+  absl::Status LoadModel(CalculatorContext* cc, InterpreterState* state);
+  absl::Status LoadDelegate(CalculatorContext* cc, InterpreterState* state);
+  // Decides which interpreter inputs and outputs can be bound to Tensor
+  // buffers.
+  void PrepareBindings(InterpreterState* state);
+  // Runs a single input packet without copies: input Tensor buffers are bound
+  // as interpreter inputs and the interpreter writes straight into the output
+  // Tensors. Tensors that cannot be bound are copied.
+  absl::Status RunBoundInference(CalculatorContext* cc,
+                                 const Packet<std::vector<Tensor>>& input,
+                                 InterpreterState* state);
+  // Copies the input tensors into batch slot |slot| of the interpreter's
+  // input tensors.
+  absl::Status CopyInputs(const std::vector<Tensor>& input_tensors, int slot,
+                          tflite::Interpreter* interpreter);
+  // Runs the interpreter and sends one output packet per timestamp, the i-th
+  // holding batch slot i of the output tensors.
+  absl::Status RunInference(CalculatorContext* cc,
+                            tflite::Interpreter* interpreter,
+                            const std::vector<Timestamp>& timestamps);
+
+  // Blocks until an interpreter is idle and takes it.
+  InterpreterState* AcquireInterpreter();
+  // Returns an interpreter taken by AcquireInterpreter.
+  void ReleaseInterpreter(InterpreterState* state);
 
   // TfLite requires us to keep the model alive as long as the interpreter is.
   Packet<TfLiteModelPtr> model_packet_;
-  std::unique_ptr<tflite::Interpreter> interpreter_;
-  TfLiteDelegatePtr delegate_;
+  // The interpreters, all sharing model_packet_. With more than one, Process
+  // may run concurrently (see InferenceCalculatorOptions::num_interpreters)
+  // and each call borrows an idle interpreter.
+  std::vector<std::unique_ptr<InterpreterState>> interpreters_;
+  absl::Mutex pool_mutex_;
+  std::vector<InterpreterState*> idle_interpreters_
+      ABSL_GUARDED_BY(pool_mutex_);
+  // Number of input packets per invocation, see
+  // InferenceCalculatorOptions::batch_size.
+  int batch_size_ = 1;
+  // Timestamps of the inputs copied into the interpreter's input tensors and
+  // not yet run. Only used with a single interpreter.
+  std::vector<Timestamp> batch_timestamps_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -77,86 +203,349 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
   const auto& options = cc->Options<::mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  RET_CHECK_GE(options.num_interpreters(), 1);
+  RET_CHECK(options.num_interpreters() == 1 || options.batch_size() == 1)
+      << "batch_size and num_interpreters cannot be combined.";
+  if (options.batch_size() > 1) {
+    // Results are sent at the timestamps of earlier inputs once their batch
+    // is complete, so the output bound must not follow the input timestamp.
+    cc->SetTimestampOffset(TimestampDiff::Unset());
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
-  MP_RETURN_IF_ERROR(LoadModel(cc));
-  MP_RETURN_IF_ERROR(LoadDelegate(cc));
+  absl::MutexLock lock(&pool_mutex_);
+  if (CanReuseInterpreters(cc)) {
+    return absl::OkStatus();
+  }
+  idle_interpreters_.clear();
+  interpreters_.clear();
+  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
+  const int num_interpreters =
+      cc->Options<mediapipe::InferenceCalculatorOptions>().num_interpreters();
+  for (int i = 0; i < num_interpreters; ++i) {
+    interpreters_.push_back(absl::make_unique<InterpreterState>());
+    MP_RETURN_IF_ERROR(LoadModel(cc, interpreters_.back().get()));
+    MP_RETURN_IF_ERROR(LoadDelegate(cc, interpreters_.back().get()));
+    idle_interpreters_.push_back(interpreters_.back().get());
+  }
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
   if (kInTensors(cc).IsEmpty()) {
+    // Without a pending batch no output can precede the next input.
+    if (batch_size_ > 1 && batch_timestamps_.empty()) {
+      kOutTensors(cc).SetNextTimestampBound(
+          cc->InputTimestamp().NextAllowedInStream());
+    }
     return absl::OkStatus();
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
+
+  if (batch_size_ == 1) {
+    InterpreterState* state = AcquireInterpreter();
+    absl::Status status = RunBoundInference(cc, kInTensors(cc), state);
+    ReleaseInterpreter(state);
+    return status;
+  }
+
+  tflite::Interpreter* interpreter = interpreters_[0]->interpreter.get();
+  MP_RETURN_IF_ERROR(
+      CopyInputs(input_tensors, batch_timestamps_.size(), interpreter));
+  batch_timestamps_.push_back(cc->InputTimestamp());
+  if (batch_timestamps_.size() < batch_size_) {
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(RunInference(cc, interpreter, batch_timestamps_));
+  batch_timestamps_.clear();
+  return absl::OkStatus();
+}
+
+void InferenceCalculatorCpuImpl::PrepareBindings(InterpreterState* state) {
+  tflite::Interpreter* interpreter = state->interpreter.get();
+  const auto& inputs = interpreter->inputs();
+  const auto& outputs = interpreter->outputs();
+  for (int input : inputs) {
+    state->bind_inputs.push_back(CanBindTensor(interpreter->tensor(input)));
+  }
+  state->input_scratch.resize(inputs.size());
+  state->bound_input_data.resize(inputs.size(), nullptr);
+  state->bound_output_data.resize(outputs.size(), nullptr);
+  for (int output : outputs) {
+    // An output that is also an input keeps the interpreter's buffer, and so
+    // does an output whose shape is only known after Invoke.
+    const TfLiteTensor* tensor = interpreter->tensor(output);
+    state->bind_outputs.push_back(
+        CanBindTensor(tensor) && HasStaticShape(tensor) &&
+        std::find(inputs.begin(), inputs.end(), output) == inputs.end());
+  }
+  state->bindings_prepared = true;
+}
+
+absl::Status InferenceCalculatorCpuImpl::RunBoundInference(
+    CalculatorContext* cc, const Packet<std::vector<Tensor>>& input,
+    InterpreterState* state) {
+  tflite::Interpreter* interpreter = state->interpreter.get();
+  if (!state->bindings_prepared) {
+    PrepareBindings(state);
+  }
+
+  // Whether any input or output was bound to a different buffer.
+  bool rebound = false;
+
+  // The read views keep the input buffers valid until Invoke returns.
+  const std::vector<Tensor>& input_tensors = *input;
+  std::vector<Tensor::CpuReadView> input_views;
+  input_views.reserve(input_tensors.size());
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    const Tensor& input_tensor = input_tensors[i];
+    TfLiteTensor* local_tensor = interpreter->input_tensor(i);
+    ASSIGN_OR_RETURN(auto element_type, GetElementType(local_tensor->type));
+    RET_CHECK(input_tensor.element_type() == element_type)
+        << "Input tensor " << i << " does not match the model input type "
+        << TfLiteTypeGetName(local_tensor->type) << ".";
+    const size_t bytes = input_tensor.bytes();
+    RET_CHECK_LE(bytes, local_tensor->bytes);
+    input_views.push_back(input_tensor.GetCpuReadView());
+    const void* data = input_views.back().buffer<void>();
+    if (!state->bind_inputs[i]) {
+      std::memcpy(local_tensor->data.raw, data, bytes);
+      continue;
+    }
+    if (bytes != local_tensor->bytes || !IsAlignedForTfLite(data)) {
+      auto& scratch = state->input_scratch[i];
+      if (!scratch || scratch->bytes() != local_tensor->bytes) {
+        scratch = absl::make_unique<Tensor>(
+            element_type,
+            Tensor::Shape{std::vector<int>(
+                local_tensor->dims->data,
+                local_tensor->dims->data + local_tensor->dims->size)});
+      }
+      auto scratch_view = scratch->GetCpuWriteView();
+      std::memcpy(scratch_view.buffer<void>(), data, bytes);
+      data = scratch_view.buffer<void>();
+    }
+    // TfLite only reads input buffers.
+    MP_RETURN_IF_ERROR(BindTensor(
+        interpreter, interpreter->inputs()[i], const_cast<void*>(data),
+        local_tensor->bytes, &state->bound_input_data[i], &rebound));
+  }
+  state->bound_input_packet = input;
+
+  // Allocate the bound output tensors up front so the interpreter writes into
+  // them. Their shapes are static, see PrepareBindings.
+  const auto& tensor_indexes = interpreter->outputs();
+  state->bound_output_tensors.clear();
+  // The views below point into these Tensors, which must not be moved.
+  state->bound_output_tensors.reserve(tensor_indexes.size());
+  std::vector<Tensor::CpuWriteView> output_views;
+  output_views.reserve(tensor_indexes.size());
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    if (!state->bind_outputs[i]) continue;
+    TfLiteTensor* tensor = interpreter->tensor(tensor_indexes[i]);
+    ASSIGN_OR_RETURN(auto element_type, GetElementType(tensor->type));
+    state->bound_output_tensors.emplace_back(
+        element_type,
+        Tensor::Shape{std::vector<int>(
+            tensor->dims->data, tensor->dims->data + tensor->dims->size)},
+        Tensor::QuantizationParameters(tensor->params.scale,
+                                       tensor->params.zero_point));
+    Tensor& output_tensor = state->bound_output_tensors.back();
+    RET_CHECK_EQ(output_tensor.bytes(), tensor->bytes);
+    output_views.push_back(output_tensor.GetCpuWriteView());
+    MP_RETURN_IF_ERROR(BindTensor(interpreter, tensor_indexes[i],
+                                  output_views.back().buffer<void>(),
+                                  tensor->bytes, &state->bound_output_data[i],
+                                  &rebound));
+  }
+  // Let the interpreter pick up new custom allocations. Buffers that are
+  // bound again, such as reused input scratch buffers, need no update.
+  if (rebound) {
+    RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  }
+
+  RET_CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+  output_views.clear();
+  input_views.clear();
+
+  // Unbound outputs are created after Invoke, which sets dynamic shapes.
   auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+  output_tensors->reserve(tensor_indexes.size());
+  auto bound_tensor = state->bound_output_tensors.begin();
+  for (int i = 0; i < tensor_indexes.size(); ++i) {
+    if (state->bind_outputs[i]) {
+      output_tensors->push_back(std::move(*bound_tensor++));
+      continue;
+    }
+    TfLiteTensor* tensor = interpreter->tensor(tensor_indexes[i]);
+    ASSIGN_OR_RETURN(auto element_type, GetElementType(tensor->type));
+    output_tensors->emplace_back(
+        element_type,
+        Tensor::Shape{std::vector<int>(
+            tensor->dims->data, tensor->dims->data + tensor->dims->size)},
+        Tensor::QuantizationParameters(tensor->params.scale,
+                                       tensor->params.zero_point));
+    Tensor& output_tensor = output_tensors->back();
+    RET_CHECK_EQ(output_tensor.bytes(), tensor->bytes);
+    auto cpu_view = output_tensor.GetCpuWriteView();
+    std::memcpy(cpu_view.buffer<void>(), tensor->data.raw, tensor->bytes);
+  }
+  state->bound_output_tensors.clear();
+  state->bound_output_packet =
+      PacketAdopting(std::move(output_tensors)).At(cc->InputTimestamp());
+  kOutTensors(cc).Send(state->bound_output_packet);
+  return absl::OkStatus();
+}
 
+absl::Status InferenceCalculatorCpuImpl::CopyInputs(
+    const std::vector<Tensor>& input_tensors, int slot,
+    tflite::Interpreter* interpreter) {
   // Read CPU input into tensors.
   for (int i = 0; i < input_tensors.size(); ++i) {
     const Tensor* input_tensor = &input_tensors[i];
+    TfLiteTensor* local_tensor = interpreter->input_tensor(i);
+    ASSIGN_OR_RETURN(auto element_type, GetElementType(local_tensor->type));
+    RET_CHECK(input_tensor->element_type() == element_type)
+        << "Input tensor " << i << " does not match the model input type "
+        << TfLiteTypeGetName(local_tensor->type) << ".";
+    RET_CHECK_LE(static_cast<size_t>((slot + 1) * input_tensor->bytes()),
+                 local_tensor->bytes);
     auto input_tensor_view = input_tensor->GetCpuReadView();
-    auto input_tensor_buffer = input_tensor_view.buffer<float>();
-    float* local_tensor_buffer = interpreter_->typed_input_tensor<float>(i);
-    std::memcpy(local_tensor_buffer, input_tensor_buffer,
-                input_tensor->bytes());
+    std::memcpy(local_tensor->data.raw + slot * input_tensor->bytes(),
+                input_tensor_view.buffer<char>(), input_tensor->bytes());
   }
+  return absl::OkStatus();
+}
 
+absl::Status InferenceCalculatorCpuImpl::RunInference(
+    CalculatorContext* cc, tflite::Interpreter* interpreter,
+    const std::vector<Timestamp>& timestamps) {
   // Run inference.
-  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
-
-  // Output result tensors (CPU).
-  const auto& tensor_indexes = interpreter_->outputs();
-  output_tensors->reserve(tensor_indexes.size());
+  RET_CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+
+  // Output result tensors (CPU), split along the batch dimension.
+  const int num_results = timestamps.size();
+  std::vector<std::unique_ptr<std::vector<Tensor>>> output_tensors(
+      num_results);
+  const auto& tensor_indexes = interpreter->outputs();
+  for (auto& result_tensors : output_tensors) {
+    result_tensors = absl::make_unique<std::vector<Tensor>>();
+    result_tensors->reserve(tensor_indexes.size());
+  }
   for (int i = 0; i < tensor_indexes.size(); ++i) {
-    TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{std::vector<int>{
-            tensor->dims->data, tensor->dims->data + tensor->dims->size}});
-    auto cpu_view = output_tensors->back().GetCpuWriteView();
-    std::memcpy(cpu_view.buffer<float>(), tensor->data.f,
-                output_tensors->back().bytes());
-  }
-  kOutTensors(cc).Send(std::move(output_tensors));
+    TfLiteTensor* tensor = interpreter->tensor(tensor_indexes[i]);
+    ASSIGN_OR_RETURN(auto element_type, GetElementType(tensor->type));
+    const Tensor::QuantizationParameters quantization_parameters(
+        tensor->params.scale, tensor->params.zero_point);
+    std::vector<int> dims(tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size);
+    if (batch_size_ > 1) {
+      RET_CHECK(!dims.empty() && dims[0] == batch_size_)
+          << "Output tensor " << i << " has no batch dimension.";
+      dims[0] = 1;
+    }
+    for (int j = 0; j < num_results; ++j) {
+      auto& result_tensors = *output_tensors[j];
+      result_tensors.emplace_back(element_type, Tensor::Shape{dims},
+                                  quantization_parameters);
+      const size_t bytes = result_tensors.back().bytes();
+      auto cpu_view = result_tensors.back().GetCpuWriteView();
+      std::memcpy(cpu_view.buffer<char>(), tensor->data.raw + j * bytes,
+                  bytes);
+    }
+  }
+  for (int j = 0; j < num_results; ++j) {
+    kOutTensors(cc).Send(std::move(output_tensors[j]), timestamps[j]);
+  }
   return absl::OkStatus();
 }
 
+InferenceCalculatorCpuImpl::InterpreterState*
+InferenceCalculatorCpuImpl::AcquireInterpreter() {
+  pool_mutex_.LockWhen(absl::Condition(
+      +[](std::vector<InterpreterState*>* idle) { return !idle->empty(); },
+      &idle_interpreters_));
+  InterpreterState* state = idle_interpreters_.back();
+  idle_interpreters_.pop_back();
+  pool_mutex_.Unlock();
+  return state;
+}
+
+void InferenceCalculatorCpuImpl::ReleaseInterpreter(InterpreterState* state) {
+  absl::MutexLock lock(&pool_mutex_);
+  idle_interpreters_.push_back(state);
+}
+
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
-  interpreter_ = nullptr;
-  delegate_ = nullptr;
+  // Run the last, partially filled batch. The unused slots hold stale inputs
+  // whose results are discarded.
+  if (!batch_timestamps_.empty()) {
+    MP_RETURN_IF_ERROR(RunInference(cc, interpreters_[0]->interpreter.get(),
+                                    batch_timestamps_));
+    batch_timestamps_.clear();
+  }
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
-  ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
+bool InferenceCalculatorCpuImpl::Reset() {
+  batch_timestamps_.clear();
+  return true;
+}
+
+bool InferenceCalculatorCpuImpl::CanReuseInterpreters(CalculatorContext* cc) {
+  if (interpreters_.empty() || kSideInCustomOpResolver(cc).IsConnected()) {
+    return false;
+  }
+  // A model side packet must hold the same model as in the previous run.
+  return !kSideInModel(cc).IsConnected() ||
+         (!kSideInModel(cc).IsEmpty() &&
+          &*kSideInModel(cc) == &model_packet_.Get());
+}
+
+absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc,
+                                                   InterpreterState* state) {
   const auto& model = *model_packet_.Get();
   tflite::ops::builtin::BuiltinOpResolver op_resolver =
       kSideInCustomOpResolver(cc).GetOr(
           tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates());
 
-  tflite::InterpreterBuilder(model, op_resolver)(&interpreter_);
-  RET_CHECK(interpreter_);
+  auto& interpreter = state->interpreter;
+  tflite::InterpreterBuilder(model, op_resolver)(&interpreter);
+  RET_CHECK(interpreter);
 
 #if defined(__EMSCRIPTEN__)
-  interpreter_->SetNumThreads(1);
+  interpreter->SetNumThreads(1);
 #else
-  interpreter_->SetNumThreads(
+  interpreter->SetNumThreads(
       cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread());
 #endif  // __EMSCRIPTEN__
 
-  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
-  // TODO: Support quantized tensors.
-  CHECK(interpreter_->tensor(interpreter_->inputs()[0])->quantization.type !=
-        kTfLiteAffineQuantization);
+  batch_size_ =
+      cc->Options<mediapipe::InferenceCalculatorOptions>().batch_size();
+  RET_CHECK_GE(batch_size_, 1);
+  if (batch_size_ > 1) {
+    for (int input : interpreter->inputs()) {
+      const TfLiteIntArray* dims = interpreter->tensor(input)->dims;
+      RET_CHECK(dims->size > 0 && dims->data[0] == 1)
+          << "Batched inference requires a model batch dimension of 1.";
+      std::vector<int> batch_dims(dims->data, dims->data + dims->size);
+      batch_dims[0] = batch_size_;
+      RET_CHECK_EQ(interpreter->ResizeInputTensor(input, batch_dims),
+                   kTfLiteOk);
+    }
+  }
+
+  RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
 
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
+absl::Status InferenceCalculatorCpuImpl::LoadDelegate(
+    CalculatorContext* cc, InterpreterState* state) {
   const auto& calculator_opts =
       cc->Options<mediapipe::InferenceCalculatorOptions>();
   if (calculator_opts.has_delegate() &&
@@ -164,6 +553,7 @@ absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
     // Default tflite inference requeqsted - no need to modify graph.
     return absl::OkStatus();
   }
+  tflite::Interpreter* interpreter = state->interpreter.get();
 
 #if defined(MEDIAPIPE_ANDROID)
   const bool nnapi_requested = calculator_opts.has_delegate()
@@ -172,11 +562,13 @@ absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
   if (nnapi_requested) {
     // Attempt to use NNAPI.
     // If not supported, the default CPU delegate will be created and used.
-    interpreter_->SetAllowFp16PrecisionForFp32(1);
-    delegate_ = TfLiteDelegatePtr(tflite::NnApiDelegate(), [](TfLiteDelegate*) {
-      // No need to free according to tflite::NnApiDelegate() documentation.
-    });
-    RET_CHECK_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+    interpreter->SetAllowFp16PrecisionForFp32(1);
+    state->delegate =
+        TfLiteDelegatePtr(tflite::NnApiDelegate(), [](TfLiteDelegate*) {
+          // No need to free according to tflite::NnApiDelegate()
+          // documentation.
+        });
+    RET_CHECK_EQ(interpreter->ModifyGraphWithDelegate(state->delegate.get()),
                  kTfLiteOk);
     return absl::OkStatus();
   }
@@ -190,11 +582,14 @@ absl::Status InferenceCalculatorCpuImpl::LoadDelegate(CalculatorContext* cc) {
 #endif  // defined(__EMSCRIPTEN__)
 
   if (use_xnnpack) {
+    // Each interpreter gets its own delegate, since a delegate instance must
+    // not be used by several interpreters at once.
     TfLiteXNNPackDelegateOptions xnnpack_opts{};
     xnnpack_opts.num_threads = GetXnnpackNumThreads(calculator_opts);
-    delegate_ = TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
-                                  &TfLiteXNNPackDelegateDelete);
-    RET_CHECK_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+    state->delegate =
+        TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
+                          &TfLiteXNNPackDelegateDelete);
+    RET_CHECK_EQ(interpreter->ModifyGraphWithDelegate(state->delegate.get()),
                  kTfLiteOk);
   }
 
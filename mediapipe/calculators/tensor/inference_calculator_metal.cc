@@ -116,6 +116,8 @@ absl::Status InferenceCalculatorMetalImpl::UpdateContract(
   const auto& options = cc->Options<::mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  RET_CHECK(options.batch_size() == 1 && options.num_interpreters() == 1)
+      << "Batched inference and interpreter pools are only supported on CPU.";
 
   MP_RETURN_IF_ERROR([MPPMetalHelper updateContract:cc]);
   return absl::OkStatus();
@@ -12,12 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
@@ -32,6 +35,7 @@
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 
 #ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
@@ -159,4 +163,327 @@ TEST(InferenceCalculatorTest, SmokeTest_ModelAsInputSidePacket) {
   DoSmokeTest(graph_proto);
 }
 
+// Runs three packets through the add model in batches of two and checks that
+// each result arrives at the timestamp of its input.
+TEST(InferenceCalculatorTest, BatchedCpuInference) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { xnnpack {} }
+              batch_size: 2
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  const Tensor::Shape shape{1, 8, 8, 3};
+  for (int t = 0; t < 3; ++t) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32, shape);
+    auto view = input_vec->back().GetCpuWriteView();
+    std::fill_n(view.buffer<float>(), shape.num_elements(), t + 1.0f);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  // The third packet waits for a second one to complete its batch.
+  EXPECT_EQ(2, output_packets.size());
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(3, output_packets.size());
+  for (int t = 0; t < 3; ++t) {
+    EXPECT_EQ(Timestamp(t), output_packets[t].Timestamp());
+    const auto& result_vec = output_packets[t].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(shape.dims, result_vec[0].shape().dims);
+    auto view = result_vec[0].GetCpuReadView();
+    EXPECT_EQ(3 * (t + 1.0f), view.buffer<float>()[0]);
+  }
+}
+
+// Runs timestamps concurrently on two interpreters and checks that the
+// results stay in timestamp order.
+TEST(InferenceCalculatorTest, InterpreterPool) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          max_in_flight: 2
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { xnnpack {} }
+              num_interpreters: 2
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  constexpr int kNumPackets = 20;
+  const Tensor::Shape shape{1, 8, 8, 3};
+  for (int t = 0; t < kNumPackets; ++t) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32, shape);
+    auto view = input_vec->back().GetCpuWriteView();
+    std::fill_n(view.buffer<float>(), shape.num_elements(), t + 1.0f);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(kNumPackets, output_packets.size());
+  for (int t = 0; t < kNumPackets; ++t) {
+    EXPECT_EQ(Timestamp(t), output_packets[t].Timestamp());
+    const auto& result_vec = output_packets[t].Get<std::vector<Tensor>>();
+    auto view = result_vec[0].GetCpuReadView();
+    EXPECT_EQ(3 * (t + 1.0f), view.buffer<float>()[0]);
+  }
+}
+
+// Runs several packets through the add model and checks that every result is
+// computed from its own input, not from buffers bound by an earlier call.
+TEST(InferenceCalculatorTest, BoundBuffersAcrossProcessCalls) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  constexpr int kNumPackets = 5;
+  const Tensor::Shape shape{1, 8, 8, 3};
+  for (int t = 0; t < kNumPackets; ++t) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    // Every other input is smaller than the model input and is copied into
+    // an interpreter owned buffer instead of being bound.
+    const Tensor::Shape input_shape =
+        t % 2 ? Tensor::Shape{1, 4, 8, 3} : shape;
+    input_vec->emplace_back(Tensor::ElementType::kFloat32, input_shape);
+    auto view = input_vec->back().GetCpuWriteView();
+    std::fill_n(view.buffer<float>(), input_shape.num_elements(), t + 1.0f);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(t))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(kNumPackets, output_packets.size());
+  for (int t = 0; t < kNumPackets; ++t) {
+    const auto& result_vec = output_packets[t].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(shape.dims, result_vec[0].shape().dims);
+    auto view = result_vec[0].GetCpuReadView();
+    EXPECT_EQ(3 * (t + 1.0f), view.buffer<float>()[0]);
+  }
+}
+
+// Runs the add model in several runs of one graph. The calculator and its
+// interpreters are kept across runs, and every run must produce the results
+// of the first.
+TEST(InferenceCalculatorTest, ReusedAcrossGraphRuns) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+
+  constexpr int kNumRuns = 3;
+  constexpr int kNumPackets = 3;
+  const Tensor::Shape shape{1, 8, 8, 3};
+  // The output values of each packet, per run.
+  std::vector<std::vector<std::vector<float>>> results(kNumRuns);
+  for (int run = 0; run < kNumRuns; ++run) {
+    output_packets.clear();
+    MP_ASSERT_OK(graph.StartRun({}));
+    for (int t = 0; t < kNumPackets; ++t) {
+      auto input_vec = absl::make_unique<std::vector<Tensor>>();
+      input_vec->emplace_back(Tensor::ElementType::kFloat32, shape);
+      auto view = input_vec->back().GetCpuWriteView();
+      float* values = view.buffer<float>();
+      std::iota(values, values + shape.num_elements(), t + 1.0f);
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "tensor_in", Adopt(input_vec.release()).At(Timestamp(t))));
+    }
+    MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+    MP_ASSERT_OK(graph.WaitUntilDone());
+
+    ASSERT_EQ(kNumPackets, output_packets.size());
+    for (int t = 0; t < kNumPackets; ++t) {
+      EXPECT_EQ(Timestamp(t), output_packets[t].Timestamp());
+      const auto& result_vec = output_packets[t].Get<std::vector<Tensor>>();
+      ASSERT_EQ(1, result_vec.size());
+      ASSERT_EQ(shape.dims, result_vec[0].shape().dims);
+      auto view = result_vec[0].GetCpuReadView();
+      const float* values = view.buffer<float>();
+      results[run].emplace_back(values, values + shape.num_elements());
+    }
+  }
+
+  for (int t = 0; t < kNumPackets; ++t) {
+    EXPECT_EQ(3 * (t + 1.0f), results[0][t][0]);
+  }
+  for (int run = 1; run < kNumRuns; ++run) {
+    EXPECT_EQ(results[0], results[run]) << "run " << run;
+  }
+}
+
+// Returns a model that reshapes a [1, 6] float input to the shape given by a
+// second, int32 input. Its output shape is only known after Invoke.
+TfLiteModelPtr BuildReshapeModel() {
+  flatbuffers::FlatBufferBuilder builder;
+  const std::vector<flatbuffers::Offset<tflite::Buffer>> buffers = {
+      tflite::CreateBuffer(builder)};
+  const std::vector<flatbuffers::Offset<tflite::Tensor>> tensors = {
+      tflite::CreateTensor(builder, builder.CreateVector<int>({1, 6}),
+                           tflite::TensorType_FLOAT32, /*buffer=*/0,
+                           builder.CreateString("data")),
+      tflite::CreateTensor(builder, builder.CreateVector<int>({2}),
+                           tflite::TensorType_INT32, /*buffer=*/0,
+                           builder.CreateString("shape")),
+      tflite::CreateTensor(builder, builder.CreateVector<int>({1, 6}),
+                           tflite::TensorType_FLOAT32, /*buffer=*/0,
+                           builder.CreateString("output"),
+                           /*quantization=*/0, /*is_variable=*/false,
+                           /*sparsity=*/0,
+                           builder.CreateVector<int>({-1, -1}))};
+  const std::vector<int> inputs = {0, 1};
+  const std::vector<int> outputs = {2};
+  const std::vector<flatbuffers::Offset<tflite::Operator>> operators = {
+      tflite::CreateOperator(builder, /*opcode_index=*/0,
+                             builder.CreateVector(inputs),
+                             builder.CreateVector(outputs))};
+  tflite::OperatorCodeBuilder opcode_builder(builder);
+  opcode_builder.add_deprecated_builtin_code(tflite::BuiltinOperator_RESHAPE);
+  opcode_builder.add_builtin_code(tflite::BuiltinOperator_RESHAPE);
+  const std::vector<flatbuffers::Offset<tflite::OperatorCode>> opcodes = {
+      opcode_builder.Finish()};
+  const std::vector<flatbuffers::Offset<tflite::SubGraph>> subgraphs = {
+      tflite::CreateSubGraph(builder, builder.CreateVector(tensors),
+                             builder.CreateVector(inputs),
+                             builder.CreateVector(outputs),
+                             builder.CreateVector(operators))};
+  builder.Finish(tflite::CreateModel(
+      builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(opcodes),
+      builder.CreateVector(subgraphs), builder.CreateString("reshape"),
+      builder.CreateVector(buffers)));
+
+  // The model refers to the flatbuffer, which is released along with it.
+  auto* model_data = new std::string(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  return TfLiteModelPtr(
+      tflite::FlatBufferModel::BuildFromBuffer(model_data->data(),
+                                               model_data->size())
+          .release(),
+      [model_data](tflite::FlatBufferModel* model) {
+        delete model;
+        delete model_data;
+      });
+}
+
+// Runs a model whose output shape changes with every input and checks that
+// each output Tensor has the shape set by its Invoke.
+TEST(InferenceCalculatorTest, ResizableOutputs) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        input_side_packet: "model"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          input_side_packet: "MODEL:model"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              delegate { tflite {} }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun(
+      {{"model", Adopt(new TfLiteModelPtr(BuildReshapeModel()))}}));
+
+  const std::vector<std::vector<int>> output_dims = {{2, 3}, {3, 2}, {6, 1}};
+  for (int t = 0; t < output_dims.size(); ++t) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32,
+                            Tensor::Shape{1, 6});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      std::iota(view.buffer<float>(), view.buffer<float>() + 6, t * 10.0f);
+    }
+    input_vec->emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{2});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      std::copy(output_dims[t].begin(), output_dims[t].end(),
+                view.buffer<int32_t>());
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(t))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(output_dims.size(), output_packets.size());
+  for (int t = 0; t < output_dims.size(); ++t) {
+    const auto& result_vec = output_packets[t].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(output_dims[t], result_vec[0].shape().dims);
+    auto view = result_vec[0].GetCpuReadView();
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_EQ(t * 10.0f + i, view.buffer<float>()[i]);
+    }
+  }
+}
+
 }  // namespace mediapipe
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
@@ -91,6 +94,86 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
   }
 }
 
+// Returns the values of @tensor as floats. kFloat32 tensors are read in place
+// through @view; kUInt8 and kInt8 tensors are dequantized into @dequantized,
+// which must outlive the returned pointer.
+absl::StatusOr<const float*> GetFloatValues(const Tensor& tensor,
+                                            const Tensor::CpuReadView& view,
+                                            std::vector<float>* dequantized) {
+  const auto& params = tensor.quantization_parameters();
+  const int num_elements = tensor.shape().num_elements();
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kFloat32:
+      return view.buffer<float>();
+    case Tensor::ElementType::kUInt8: {
+      const uint8_t* values = view.buffer<uint8_t>();
+      dequantized->resize(num_elements);
+      for (int i = 0; i < num_elements; ++i) {
+        (*dequantized)[i] = params.scale * (values[i] - params.zero_point);
+      }
+      return dequantized->data();
+    }
+    case Tensor::ElementType::kInt8: {
+      const int8_t* values = view.buffer<int8_t>();
+      dequantized->resize(num_elements);
+      for (int i = 0; i < num_elements; ++i) {
+        (*dequantized)[i] = params.scale * (values[i] - params.zero_point);
+      }
+      return dequantized->data();
+    }
+    default:
+      return absl::InvalidArgumentError(
+          "Detection tensors must be kFloat32, kUInt8 or kInt8.");
+  }
+}
+
+// Returns the first @count values of @tensor as integers, e.g. class indices
+// or a detection count. Values are read in the tensor's element type; kUInt8
+// and kInt8 values are dequantized and rounded.
+absl::StatusOr<std::vector<int>> GetIntValues(const Tensor& tensor,
+                                              int count) {
+  RET_CHECK_GE(count, 0);
+  RET_CHECK_LE(count, tensor.shape().num_elements());
+  const auto& params = tensor.quantization_parameters();
+  auto view = tensor.GetCpuReadView();
+  std::vector<int> values(count);
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kFloat32: {
+      const float* data = view.buffer<float>();
+      for (int i = 0; i < count; ++i) {
+        values[i] = static_cast<int>(data[i]);
+      }
+      break;
+    }
+    case Tensor::ElementType::kInt32: {
+      const int32_t* data = view.buffer<int32_t>();
+      std::copy(data, data + count, values.begin());
+      break;
+    }
+    case Tensor::ElementType::kUInt8: {
+      const uint8_t* data = view.buffer<uint8_t>();
+      for (int i = 0; i < count; ++i) {
+        values[i] = static_cast<int>(
+            std::round(params.scale * (data[i] - params.zero_point)));
+      }
+      break;
+    }
+    case Tensor::ElementType::kInt8: {
+      const int8_t* data = view.buffer<int8_t>();
+      for (int i = 0; i < count; ++i) {
+        values[i] = static_cast<int>(
+            std::round(params.scale * (data[i] - params.zero_point)));
+      }
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          "Detection class and count tensors must be kFloat32, kInt32, kUInt8 "
+          "or kInt8.");
+  }
+  return values;
+}
+
 }  // namespace
 
 // Convert result Tensors from object detection models into MediaPipe
@@ -105,6 +188,10 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
 //            for anchors (e.g. for SSD models) depend on the outputs of the
 //            detection model. The size of anchor tensor must be (num_boxes *
 //            4).
+//            On CPU, box and score tensors may also be quantized kUInt8 or
+//            kInt8 tensors, which are dequantized with their quantization
+//            parameters before decoding. Class and count tensors of
+//            postprocessed models are read in their element type.
 // Output:
 //  DETECTIONS - Result MediaPipe detections.
 //
@@ -262,9 +349,15 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(raw_score_tensor->shape().dims[1], num_boxes_);
     RET_CHECK_EQ(raw_score_tensor->shape().dims[2], num_classes_);
     auto raw_box_view = raw_box_tensor->GetCpuReadView();
-    auto raw_boxes = raw_box_view.buffer<float>();
+    std::vector<float> dequantized_boxes;
+    ASSIGN_OR_RETURN(const float* raw_boxes,
+                     GetFloatValues(*raw_box_tensor, raw_box_view,
+                                    &dequantized_boxes));
     auto raw_scores_view = raw_score_tensor->GetCpuReadView();
-    auto raw_scores = raw_scores_view.buffer<float>();
+    std::vector<float> dequantized_scores;
+    ASSIGN_OR_RETURN(const float* raw_scores,
+                     GetFloatValues(*raw_score_tensor, raw_scores_view,
+                                    &dequantized_scores));
 
     // TODO: Support other options to load anchors.
     if (!anchors_init_) {
@@ -346,22 +439,25 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[0], 1);
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[1], max_detections);
 
-    auto num_boxes_view = num_boxes_tensor->GetCpuReadView();
-    auto num_boxes = num_boxes_view.buffer<float>();
+    ASSIGN_OR_RETURN(const std::vector<int> num_boxes,
+                     GetIntValues(*num_boxes_tensor, 1));
     num_boxes_ = num_boxes[0];
 
     auto detection_boxes_view = detection_boxes_tensor->GetCpuReadView();
-    auto detection_boxes = detection_boxes_view.buffer<float>();
+    std::vector<float> dequantized_boxes;
+    ASSIGN_OR_RETURN(const float* detection_boxes,
+                     GetFloatValues(*detection_boxes_tensor,
+                                    detection_boxes_view, &dequantized_boxes));
 
     auto detection_scores_view = detection_scores_tensor->GetCpuReadView();
-    auto detection_scores = detection_scores_view.buffer<float>();
-
-    auto detection_classes_view = detection_classes_tensor->GetCpuReadView();
-    auto detection_classes_ptr = detection_classes_view.buffer<float>();
-    std::vector<int> detection_classes(num_boxes_);
-    for (int i = 0; i < num_boxes_; ++i) {
-      detection_classes[i] = static_cast<int>(detection_classes_ptr[i]);
-    }
+    std::vector<float> dequantized_scores;
+    ASSIGN_OR_RETURN(const float* detection_scores,
+                     GetFloatValues(*detection_scores_tensor,
+                                    detection_scores_view,
+                                    &dequantized_scores));
+
+    ASSIGN_OR_RETURN(const std::vector<int> detection_classes,
+                     GetIntValues(*detection_classes_tensor, num_boxes_));
     MP_RETURN_IF_ERROR(ConvertToDetections(detection_boxes, detection_scores,
                                            detection_classes.data(),
                                            output_detections));
@@ -18,6 +18,7 @@
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/timestamp_arena.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -100,6 +101,11 @@ class TensorsToLandmarksCalculator : public Node {
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kFlipHorizontally, kFlipVertically,
                           kOutLandmarkList, kOutNormalizedLandmarkList);
 
+  static absl::Status UpdateContract(CalculatorContract* cc) {
+    UseTimestampArena(cc);
+    return absl::OkStatus();
+  }
+
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
 
@@ -146,11 +152,13 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
   auto view = input_tensors[0].GetCpuReadView();
   auto raw_landmarks = view.buffer<float>();
 
-  LandmarkList output_landmarks;
+  mediapipe::Packet landmarks_packet;
+  LandmarkList* output_landmarks =
+      NewOutputMessage<LandmarkList>(cc, &landmarks_packet);
 
   for (int ld = 0; ld < num_landmarks_; ++ld) {
     const int offset = ld * num_dimensions;
-    Landmark* landmark = output_landmarks.add_landmark();
+    Landmark* landmark = output_landmarks->add_landmark();
 
     if (flip_horizontally) {
       landmark->set_x(options_.input_image_width() - raw_landmarks[offset]);
@@ -180,10 +188,12 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
 
   // Output normalized landmarks if required.
   if (kOutNormalizedLandmarkList(cc).IsConnected()) {
-    NormalizedLandmarkList output_norm_landmarks;
-    for (int i = 0; i < output_landmarks.landmark_size(); ++i) {
-      const Landmark& landmark = output_landmarks.landmark(i);
-      NormalizedLandmark* norm_landmark = output_norm_landmarks.add_landmark();
+    mediapipe::Packet norm_landmarks_packet;
+    NormalizedLandmarkList* output_norm_landmarks =
+        NewOutputMessage<NormalizedLandmarkList>(cc, &norm_landmarks_packet);
+    for (int i = 0; i < output_landmarks->landmark_size(); ++i) {
+      const Landmark& landmark = output_landmarks->landmark(i);
+      NormalizedLandmark* norm_landmark = output_norm_landmarks->add_landmark();
       norm_landmark->set_x(landmark.x() / options_.input_image_width());
       norm_landmark->set_y(landmark.y() / options_.input_image_height());
       // Scale Z coordinate as X + allow additional uniform normalization.
@@ -196,12 +206,15 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
         norm_landmark->set_presence(landmark.presence());
       }
     }
-    kOutNormalizedLandmarkList(cc).Send(std::move(output_norm_landmarks));
+    kOutNormalizedLandmarkList(cc).Send(
+        FromOldPacket(std::move(norm_landmarks_packet))
+            .As<NormalizedLandmarkList>());
   }
 
   // Output absolute landmarks.
   if (kOutLandmarkList(cc).IsConnected()) {
-    kOutLandmarkList(cc).Send(std::move(output_landmarks));
+    kOutLandmarkList(cc).Send(
+        FromOldPacket(std::move(landmarks_packet)).As<LandmarkList>());
   }
 
   return absl::OkStatus();
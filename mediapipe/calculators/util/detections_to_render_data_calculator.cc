@@ -21,6 +21,7 @@
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/timestamp_arena.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
 namespace mediapipe {
@@ -139,6 +140,7 @@ absl::Status DetectionsToRenderDataCalculator::GetContract(
     cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
   }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  UseTimestampArena(cc);
   return absl::OkStatus();
 }
 
@@ -168,27 +170,29 @@ absl::Status DetectionsToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   // TODO: Add score threshold to
   // DetectionsToRenderDataCalculatorOptions.
-  auto render_data = absl::make_unique<RenderData>();
+  Packet render_data_packet;
+  RenderData* render_data =
+      NewOutputMessage<RenderData>(cc, &render_data_packet);
   render_data->set_scene_class(options.scene_class());
   if (has_detection_from_list) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionListTag).Get<DetectionList>().detection()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
     }
   }
   if (has_detection_from_vector) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, render_data);
     }
   }
   if (has_single_detection) {
     AddDetectionToRenderData(cc->Inputs().Tag(kDetectionTag).Get<Detection>(),
-                             options, render_data.get());
+                             options, render_data);
   }
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(std::move(render_data_packet));
   return absl::OkStatus();
 }
 
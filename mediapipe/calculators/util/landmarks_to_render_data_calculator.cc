@@ -22,6 +22,7 @@
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/timestamp_arena.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
 namespace mediapipe {
@@ -242,6 +243,7 @@ absl::Status LandmarksToRenderDataCalculator::GetContract(
     cc->Inputs().Tag(kRenderScaleTag).Set<float>();
   }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  UseTimestampArena(cc);
   return absl::OkStatus();
 }
 
@@ -272,7 +274,9 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
-  auto render_data = absl::make_unique<RenderData>();
+  Packet render_data_packet;
+  RenderData* render_data =
+      NewOutputMessage<RenderData>(cc, &render_data_packet);
   bool visualize_depth = options_.visualize_landmark_depth();
   float z_min = 0.f;
   float z_max = 0.f;
@@ -306,13 +310,13 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), thickness, /*normalized=*/false, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
+          z_max, min_depth_line_color, max_depth_line_color, render_data);
     } else {
       AddConnections<LandmarkList, Landmark>(
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/false, render_data.get());
+          /*normalized=*/false, render_data);
     }
     for (int i = 0; i < landmarks.landmark_size(); ++i) {
       const Landmark& landmark = landmarks.landmark(i);
@@ -325,7 +329,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
       }
 
       auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
+          options_.landmark_color(), thickness, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
                                options_.min_depth_circle_thickness(),
@@ -352,13 +356,13 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), thickness, /*normalized=*/true, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
+          z_max, min_depth_line_color, max_depth_line_color, render_data);
     } else {
       AddConnections<NormalizedLandmarkList, NormalizedLandmark>(
           landmarks, landmark_connections_, options_.utilize_visibility(),
           options_.visibility_threshold(), options_.utilize_presence(),
           options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/true, render_data.get());
+          /*normalized=*/true, render_data);
     }
     for (int i = 0; i < landmarks.landmark_size(); ++i) {
       const NormalizedLandmark& landmark = landmarks.landmark(i);
@@ -371,7 +375,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
       }
 
       auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
+          options_.landmark_color(), thickness, render_data);
       if (visualize_depth) {
         SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
                                options_.min_depth_circle_thickness(),
@@ -386,7 +390,7 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(std::move(render_data_packet));
   return absl::OkStatus();
 }
 
@@ -16,6 +16,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/timestamp_arena.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
 
@@ -128,6 +129,7 @@ absl::Status RectToRenderDataCalculator::GetContract(CalculatorContract* cc) {
     cc->Inputs().Tag(kRectsTag).Set<std::vector<Rect>>();
   }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  UseTimestampArena(cc);
 
   return absl::OkStatus();
 }
@@ -141,19 +143,21 @@ absl::Status RectToRenderDataCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
-  auto render_data = absl::make_unique<RenderData>();
+  Packet render_data_packet;
+  RenderData* render_data =
+      NewOutputMessage<RenderData>(cc, &render_data_packet);
 
   if (cc->Inputs().HasTag(kNormRectTag) &&
       !cc->Inputs().Tag(kNormRectTag).IsEmpty()) {
     const auto& rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
-    auto* rectangle = NewRect(options_, render_data.get());
+    auto* rectangle = NewRect(options_, render_data);
     SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
             rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
             rect.rotation(), rectangle);
   }
   if (cc->Inputs().HasTag(kRectTag) && !cc->Inputs().Tag(kRectTag).IsEmpty()) {
     const auto& rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
-    auto* rectangle = NewRect(options_, render_data.get());
+    auto* rectangle = NewRect(options_, render_data);
     SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
             rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
             rect.rotation(), rectangle);
@@ -163,7 +167,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
     const auto& rects =
         cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
     for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
+      auto* rectangle = NewRect(options_, render_data);
       SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
               rect.y_center() - rect.height() / 2.f, rect.width(),
               rect.height(), rect.rotation(), rectangle);
@@ -173,7 +177,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
       !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
     const auto& rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
     for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
+      auto* rectangle = NewRect(options_, render_data);
       SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
               rect.y_center() - rect.height() / 2.f, rect.width(),
               rect.height(), rect.rotation(), rectangle);
@@ -182,7 +186,7 @@ absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(std::move(render_data_packet));
 
   return absl::OkStatus();
 }
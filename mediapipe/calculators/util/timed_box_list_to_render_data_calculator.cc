@@ -21,6 +21,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/timestamp_arena.h"
 #include "mediapipe/util/color.pb.h"
 #include "mediapipe/util/render_data.pb.h"
 #include "mediapipe/util/tracking/box_tracker.pb.h"
@@ -137,6 +138,7 @@ absl::Status TimedBoxListToRenderDataCalculator::GetContract(
     cc->Inputs().Tag(kTimedBoxListTag).Set<TimedBoxProtoList>();
   }
   cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  UseTimestampArena(cc);
   return absl::OkStatus();
 }
 
@@ -149,20 +151,22 @@ absl::Status TimedBoxListToRenderDataCalculator::Open(CalculatorContext* cc) {
 
 absl::Status TimedBoxListToRenderDataCalculator::Process(
     CalculatorContext* cc) {
-  auto render_data = absl::make_unique<RenderData>();
+  Packet render_data_packet;
+  RenderData* render_data =
+      NewOutputMessage<RenderData>(cc, &render_data_packet);
 
   if (cc->Inputs().HasTag(kTimedBoxListTag)) {
     const auto& box_list =
         cc->Inputs().Tag(kTimedBoxListTag).Get<TimedBoxProtoList>();
 
     for (const auto& box : box_list.box()) {
-      AddTimedBoxProtoToRenderData(box, options_, render_data.get());
+      AddTimedBoxProtoToRenderData(box, options_, render_data);
     }
   }
 
   cc->Outputs()
       .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
+      .AddPacket(std::move(render_data_packet));
   return absl::OkStatus();
 }
 
@@ -154,6 +154,15 @@ class CalculatorBase {
   // complete, Close() must check if cc->GraphStatus() is OK.
   virtual absl::Status Close(CalculatorContext* cc) { return absl::OkStatus(); }
 
+  // Is called at the end of a successful graph run, after Close().  Returns
+  // true if the calculator has cleared its per-run state and can be reused:
+  // the next run of the same CalculatorGraph then calls Open() on this object
+  // instead of constructing a new calculator.  Calculators can override this
+  // to keep expensive resources, such as loaded models, across runs.  Open()
+  // must still handle input side packets that differ from the previous run.
+  // The default returns false, so calculators are constructed for every run.
+  virtual bool Reset() { return false; }
+
   // Returns a value according to which the framework selects
   // the next source calculator to Process(); smaller value means
   // Process() first. The default implementation returns the smallest
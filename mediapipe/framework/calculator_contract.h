@@ -130,6 +130,15 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // When true, Process and Close may run on the thread that made the inputs
+  // ready, right after the upstream calculator returns, instead of being
+  // queued as a separate executor task. Intended for trivially cheap
+  // calculators such as PassThroughCalculator, whose cost is dominated by
+  // scheduling. Calculators that block or do substantial work should not set
+  // this, since they delay the other nodes waiting for the same thread.
+  void SetRunInline(bool run_inline) { run_inline_ = run_inline; }
+  bool GetRunInline() const { return run_inline_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -175,6 +184,7 @@ class CalculatorContract {
   std::map<std::string, GraphServiceRequest> service_requests_;
   bool process_timestamps_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
+  bool run_inline_ = false;
 };
 
 }  // namespace mediapipe
@@ -56,6 +56,7 @@
 #include "mediapipe/framework/thread_pool_executor.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/framework/tool/fill_packet_set.h"
+#include "mediapipe/framework/tool/node_chain_fusion.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/framework/tool/validate.h"
@@ -229,6 +230,8 @@ absl::Status CalculatorGraph::InitializeCalculatorNodes() {
   // Check if the user has specified a maximum queue size for an input stream.
   max_queue_size_ = validated_graph_->Config().max_queue_size();
   max_queue_size_ = max_queue_size_ ? max_queue_size_ : 100;
+  max_queue_bytes_ = validated_graph_->Config().max_queue_bytes();
+  max_queue_bytes_ = max_queue_bytes_ > 0 ? max_queue_bytes_ : -1;
 
   // Use a local variable to avoid needing to lock errors_.
   std::vector<absl::Status> errors;
@@ -258,8 +261,19 @@ absl::Status CalculatorGraph::InitializeCalculatorNodes() {
         "CalculatorGraph::InitializeCalculatorNodes failed: ", errors);
   }
 
+  if (validated_graph_->Config().fuse_node_chains()) {
+    for (const std::vector<int>& chain :
+         tool::FindFusableNodeChains(*validated_graph_)) {
+      VLOG(2) << "Fusing a chain of " << chain.size() << " nodes starting at "
+              << (*nodes_)[chain.front()].DebugName();
+      for (int i = 1; i < chain.size(); ++i) {
+        (*nodes_)[chain[i]].SetRunInline(true);
+      }
+    }
+  }
+
   VLOG(2) << "Maximum input stream queue size based on graph config: "
-          << max_queue_size_;
+          << max_queue_size_ << " packets, " << max_queue_bytes_ << " bytes";
   return absl::OkStatus();
 }
 
@@ -325,6 +339,29 @@ absl::Status CalculatorGraph::InitializeExecutors() {
                                                  use_application_thread));
   }
 
+  for (const ExecutorConfig& executor_config :
+       validated_graph_->Config().executor()) {
+    if (executor_config.scheduling_policy() ==
+        ExecutorConfig::EARLIEST_DEADLINE_FIRST) {
+      MP_RETURN_IF_ERROR(
+          scheduler_.EnableDeadlineScheduling(executor_config.name()));
+    }
+    if (executor_config.queue_type() != ExecutorConfig::WORK_STEALING) {
+      continue;
+    }
+    // Use one worker queue per executor thread when the thread count is
+    // known. Extra worker queues are harmless; they are only visited when
+    // stealing.
+    int num_workers = executor_config.options()
+                          .GetExtension(ThreadPoolExecutorOptions::ext)
+                          .num_threads();
+    if (num_workers <= 0) {
+      num_workers = mediapipe::NumCPUCores();
+    }
+    MP_RETURN_IF_ERROR(
+        scheduler_.EnableWorkStealing(executor_config.name(), num_workers));
+  }
+
   return absl::OkStatus();
 }
 
@@ -497,6 +534,20 @@ absl::Status CalculatorGraph::Run(
   return WaitUntilDone();
 }
 
+absl::Status CalculatorGraph::Reset() {
+  RET_CHECK(initialized_).SetNoLogging()
+      << "CalculatorGraph is not initialized.";
+  RET_CHECK(!scheduler_.IsRunning()).SetNoLogging()
+      << "CalculatorGraph::Reset() must not be called while the graph is "
+         "running.";
+  for (auto& graph_output_stream : graph_output_streams_) {
+    graph_output_stream->Detach();
+  }
+  graph_output_streams_.clear();
+  current_run_side_packets_.clear();
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::StartRun(
     const std::map<std::string, Packet>& extra_side_packets,
     const std::map<std::string, Packet>& stream_headers) {
@@ -715,6 +766,7 @@ absl::Status CalculatorGraph::PrepareForRun(
   // streams.
   for (auto& node : *nodes_) {
     node.SetMaxInputStreamQueueSize(max_queue_size_);
+    node.SetMaxInputStreamQueueBytes(max_queue_bytes_);
   }
 
   // Allow graph input streams to override the global max queue size.
@@ -727,6 +779,15 @@ absl::Status CalculatorGraph::PrepareForRun(
         name_max.first);
     (*stream)->SetMaxQueueSize(name_max.second);
   }
+  for (const auto& name_max : graph_input_stream_max_queue_bytes_) {
+    std::unique_ptr<GraphInputStream>* stream =
+        mediapipe::FindOrNull(graph_input_streams_, name_max.first);
+    RET_CHECK(stream).SetNoLogging() << absl::Substitute(
+        "SetInputStreamMaxQueueBytes called on \"$0\" which is not a "
+        "graph input stream.",
+        name_max.first);
+    (*stream)->SetMaxQueueBytes(name_max.second);
+  }
 
   for (CalculatorNode& node : *nodes_) {
     if (node.IsSource()) {
@@ -881,6 +942,34 @@ absl::Status CalculatorGraph::SetInputStreamMaxQueueSize(
   return absl::OkStatus();
 }
 
+absl::Status CalculatorGraph::SetInputStreamMaxQueueBytes(
+    const std::string& stream_name, int64 max_queue_bytes) {
+  // As in SetInputStreamMaxQueueSize, the stream name is checked when the
+  // graph is started.
+  graph_input_stream_max_queue_bytes_[stream_name] = max_queue_bytes;
+  return absl::OkStatus();
+}
+
+std::vector<CalculatorGraph::InputStreamMemoryStats>
+CalculatorGraph::GetInputStreamMemoryStats() const {
+  std::vector<InputStreamMemoryStats> stats;
+  if (!initialized_) {
+    return stats;
+  }
+  const auto& input_stream_infos = validated_graph_->InputStreamInfos();
+  stats.reserve(input_stream_infos.size());
+  for (int i = 0; i < input_stream_infos.size(); ++i) {
+    const InputStreamManager& stream = input_stream_managers_[i];
+    InputStreamMemoryStats& stream_stats = stats.emplace_back();
+    stream_stats.stream_name = stream.Name();
+    stream_stats.node_name =
+        (*nodes_)[input_stream_infos[i].parent_node.index].DebugName();
+    stream_stats.queue_bytes = stream.QueueBytes();
+    stream_stats.peak_queue_bytes = stream.PeakQueueBytes();
+  }
+  return stats;
+}
+
 bool CalculatorGraph::HasInputStream(const std::string& stream_name) {
   return mediapipe::FindOrNull(graph_input_streams_, stream_name) != nullptr;
 }
@@ -1095,7 +1184,8 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
 
 bool CalculatorGraph::IsNodeThrottled(int node_id) {
   absl::MutexLock lock(&full_input_streams_mutex_);
-  return max_queue_size_ != -1 && !full_input_streams_[node_id].empty();
+  return (max_queue_size_ != -1 || max_queue_bytes_ != -1) &&
+         !full_input_streams_[node_id].empty();
 }
 
 // Returns true if an input stream serves as a graph-output-stream.
@@ -1137,16 +1227,32 @@ bool CalculatorGraph::UnthrottleSources() {
       RecordError(absl::UnavailableError(absl::StrCat(
           "Detected a deadlock due to input throttling for: \"", stream->Name(),
           "\". All calculators are idle while packet sources remain active "
-          "and throttled.  Consider adjusting \"max_queue_size\" or "
-          "\"resolve_deadlock\".")));
+          "and throttled.  Consider adjusting \"max_queue_size\", "
+          "\"max_queue_bytes\" or \"resolve_deadlock\".")));
       continue;
     }
-    int new_size = stream->QueueSize() + 1;
-    stream->SetMaxQueueSize(new_size);
-    LOG_EVERY_N(WARNING, 100)
-        << "Resolved a deadlock by increasing max_queue_size of input stream: "
-        << stream->Name() << " to: " << new_size
-        << ". Consider increasing max_queue_size for better performance.";
+    // Grow whichever limits the stream has reached, so that it admits one
+    // more packet.
+    const int max_size = stream->MaxQueueSize();
+    if (max_size != -1 && stream->QueueSize() >= max_size) {
+      int new_size = stream->QueueSize() + 1;
+      stream->SetMaxQueueSize(new_size);
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by increasing max_queue_size of input "
+             "stream: "
+          << stream->Name() << " to: " << new_size
+          << ". Consider increasing max_queue_size for better performance.";
+    }
+    const int64 max_bytes = stream->MaxQueueBytes();
+    if (max_bytes != -1 && stream->QueueBytes() >= max_bytes) {
+      int64 new_bytes = stream->QueueBytes() + 1;
+      stream->SetMaxQueueBytes(new_bytes);
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by increasing max_queue_bytes of input "
+             "stream: "
+          << stream->Name() << " to: " << new_bytes
+          << ". Consider increasing max_queue_bytes for better performance.";
+    }
   }
   return !full_streams.empty();
 }
@@ -100,7 +100,8 @@ class CalculatorGraph {
   // Defines possible modes for adding a packet to a graph input stream.
   // WAIT_TILL_NOT_FULL can be used to control the memory usage of a graph by
   // avoiding adding a new packet until all dependent input streams fall below
-  // the maximum queue size specified in the graph configuration.
+  // the maximum queue size and maximum queue bytes specified in the graph
+  // configuration.
   // ADD_IF_NOT_FULL could also be used to control the latency if used in a
   // real-time graph (e.g. drop camera frames if the MediaPipe graph queues are
   // full).
@@ -216,6 +217,14 @@ class CalculatorGraph {
   // be run). This function can be called only after StartRun().
   absl::Status WaitUntilDone();
 
+  // Prepares a graph whose run has finished for use by another client, as
+  // done by CalculatorGraphPool.  Removes all output stream observers and
+  // pollers and releases the side packets of the previous run.  Executors
+  // are kept, as are calculators that support CalculatorBase::Reset().
+  // The graph can then be run again, e.g. with new side packets.  Must not
+  // be called while the graph is running.
+  absl::Status Reset();
+
   // Wait until the running graph is in the idle mode, which is when nothing can
   // be scheduled and nothing is running in the worker threads. This function
   // can be called only after StartRun().
@@ -258,6 +267,28 @@ class CalculatorGraph {
   absl::Status SetInputStreamMaxQueueSize(const std::string& stream_name,
                                           int max_queue_size);
 
+  // Sets the maximum number of bytes queued for a graph input stream,
+  // overriding the graph default max_queue_bytes.
+  absl::Status SetInputStreamMaxQueueBytes(const std::string& stream_name,
+                                           int64 max_queue_bytes);
+
+  // The memory held by the packet queue of one input stream, based on the
+  // packet size hints.
+  struct InputStreamMemoryStats {
+    // The name of the stream.
+    std::string stream_name;
+    // The node reading the stream.
+    std::string node_name;
+    // The bytes currently queued.
+    int64 queue_bytes = 0;
+    // The most bytes queued at any time during the current or last run.
+    int64 peak_queue_bytes = 0;
+  };
+
+  // Returns the memory statistics of every calculator input stream. May be
+  // called at any time after the graph has been initialized.
+  std::vector<InputStreamMemoryStats> GetInputStreamMemoryStats() const;
+
   // Check if an input stream exists in the graph
   bool HasInputStream(const std::string& name);
 
@@ -310,6 +341,9 @@ class CalculatorGraph {
   // Returns the maximum input stream queue size.
   int GetMaxInputStreamQueueSize();
 
+  // Returns the maximum input stream queue bytes, or -1 if unlimited.
+  int64 GetMaxInputStreamQueueBytes() const { return max_queue_bytes_; }
+
   // Get the mode for adding packets to an input stream.
   GraphInputStreamAddMode GetGraphInputStreamAddMode() const;
 
@@ -423,6 +457,10 @@ class CalculatorGraph {
       manager_->SetMaxQueueSize(max_queue_size);
     }
 
+    void SetMaxQueueBytes(int64 max_queue_bytes) {
+      manager_->SetMaxQueueBytes(max_queue_bytes);
+    }
+
     void SetHeader(const Packet& header);
 
     void AddPacket(const Packet& packet) { shard_.AddPacket(packet); }
@@ -565,6 +603,10 @@ class CalculatorGraph {
   // restrict memory usage.
   int max_queue_size_ = -1;
 
+  // Maximum number of bytes held by an input stream queue, or -1 if queues
+  // are only limited by max_queue_size_.
+  int64 max_queue_bytes_ = -1;
+
   // Mode for adding packets to a graph input stream. Set to block until all
   // affected input streams are not full by default.
   GraphInputStreamAddMode graph_input_stream_add_mode_
@@ -589,6 +631,9 @@ class CalculatorGraph {
   // Maps graph input streams to their max queue size.
   absl::flat_hash_map<std::string, int> graph_input_stream_max_queue_size_;
 
+  // Maps graph input streams to their max queue bytes.
+  absl::flat_hash_map<std::string, int64> graph_input_stream_max_queue_bytes_;
+
   // The factory for making counters associated with this graph.
   std::unique_ptr<CounterFactory> counter_factory_;
 
@@ -0,0 +1,100 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph_pool.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/advanced_proto_lite_inc.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns a key that is equal for equal configs.
+std::string ConfigKey(const CalculatorGraphConfig& config) {
+  std::string key;
+  {
+    proto_ns::io::StringOutputStream stream(&key);
+    proto_ns::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    config.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+}  // namespace
+
+CalculatorGraphPool::CalculatorGraphPool(int max_idle_graphs_per_config)
+    : max_idle_graphs_per_config_(max_idle_graphs_per_config) {}
+
+absl::StatusOr<std::unique_ptr<CalculatorGraph>> CalculatorGraphPool::Acquire(
+    const CalculatorGraphConfig& config) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = idle_graphs_.find(ConfigKey(config));
+    if (it != idle_graphs_.end() && !it->second.empty()) {
+      std::unique_ptr<CalculatorGraph> graph = std::move(it->second.back());
+      it->second.pop_back();
+      return graph;
+    }
+  }
+  auto graph = absl::make_unique<CalculatorGraph>();
+  MP_RETURN_IF_ERROR(graph->Initialize(config));
+  return graph;
+}
+
+void CalculatorGraphPool::Release(const CalculatorGraphConfig& config,
+                                  std::unique_ptr<CalculatorGraph> graph) {
+  if (!graph) {
+    return;
+  }
+  absl::Status status = graph->Reset();
+  if (!status.ok()) {
+    LOG(WARNING) << "Destroying a graph that cannot be reset: " << status;
+    return;
+  }
+  std::unique_ptr<CalculatorGraph> excess_graph;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& graphs = idle_graphs_[ConfigKey(config)];
+    if (graphs.size() < max_idle_graphs_per_config_) {
+      graphs.push_back(std::move(graph));
+    } else {
+      excess_graph = std::move(graph);
+    }
+  }
+  // excess_graph is destroyed outside of the lock.
+}
+
+int CalculatorGraphPool::NumIdleGraphs(
+    const CalculatorGraphConfig& config) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = idle_graphs_.find(ConfigKey(config));
+  return it == idle_graphs_.end() ? 0 : it->second.size();
+}
+
+void CalculatorGraphPool::Clear() {
+  absl::flat_hash_map<std::string,
+                      std::vector<std::unique_ptr<CalculatorGraph>>>
+      idle_graphs;
+  {
+    absl::MutexLock lock(&mutex_);
+    idle_graphs.swap(idle_graphs_);
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,79 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// A thread-safe pool of initialized CalculatorGraphs, keyed by config.
+// Serving a job from a pooled graph saves graph initialization, executor
+// creation and, for calculators that support CalculatorBase::Reset(), the
+// construction and setup of calculators such as model loading.
+//
+// Example:
+//   CalculatorGraphPool pool;
+//   ...
+//   ASSIGN_OR_RETURN(auto graph, pool.Acquire(config));
+//   MP_RETURN_IF_ERROR(graph->ObserveOutputStream("out", callback));
+//   MP_RETURN_IF_ERROR(graph->Run(side_packets));
+//   pool.Release(config, std::move(graph));
+class CalculatorGraphPool {
+ public:
+  // At most |max_idle_graphs_per_config| released graphs are kept for each
+  // config; more are destroyed.
+  explicit CalculatorGraphPool(int max_idle_graphs_per_config = 4);
+
+  // Returns a graph initialized with |config|.  Reuses an idle graph released
+  // for an identical config if there is one, otherwise initializes a new one.
+  absl::StatusOr<std::unique_ptr<CalculatorGraph>> Acquire(
+      const CalculatorGraphConfig& config) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns |graph|, acquired for |config|, to the pool.  The graph must not
+  // be running.  It is reset with CalculatorGraph::Reset(), so observers and
+  // pollers must be added again after the next Acquire().  A graph that
+  // cannot be reset is destroyed.
+  void Release(const CalculatorGraphConfig& config,
+               std::unique_ptr<CalculatorGraph> graph)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of idle graphs for |config|.
+  int NumIdleGraphs(const CalculatorGraphConfig& config) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Destroys all idle graphs.
+  void Clear() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  const int max_idle_graphs_per_config_;
+  mutable absl::Mutex mutex_;
+  // Idle graphs keyed by the deterministic serialization of their config.
+  absl::flat_hash_map<std::string,
+                      std::vector<std::unique_ptr<CalculatorGraph>>>
+      idle_graphs_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
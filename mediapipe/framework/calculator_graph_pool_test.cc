@@ -0,0 +1,205 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::mediapipe::api2::Input;
+using ::mediapipe::api2::Node;
+using ::mediapipe::api2::Output;
+using ::mediapipe::api2::SideInput;
+
+std::atomic<int> num_constructed(0);
+std::atomic<int> num_opened(0);
+
+// Adds the OFFSET side packet to its input.  Counts constructions and
+// Open() calls and supports being reset.
+class ResettableAddCalculator : public Node {
+ public:
+  static constexpr Input<int> kIn{"IN"};
+  static constexpr SideInput<int> kOffset{"OFFSET"};
+  static constexpr Output<int> kOut{"OUT"};
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOffset, kOut);
+
+  ResettableAddCalculator() { ++num_constructed; }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    ++num_opened;
+    offset_ = *kOffset(cc);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    kOut(cc).Send(*kIn(cc) + offset_);
+    return absl::OkStatus();
+  }
+
+  bool Reset() override {
+    offset_ = 0;
+    return true;
+  }
+
+ private:
+  int offset_ = 0;
+};
+MEDIAPIPE_REGISTER_NODE(ResettableAddCalculator);
+
+CalculatorGraphConfig AddGraphConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    output_stream: "out"
+    input_side_packet: "offset"
+    node {
+      calculator: "ResettableAddCalculator"
+      input_stream: "IN:in"
+      input_side_packet: "OFFSET:offset"
+      output_stream: "OUT:out"
+    }
+  )pb");
+}
+
+// Runs |graph| on |input| with |offset| and returns the outputs.
+absl::StatusOr<std::vector<int>> RunAddGraph(CalculatorGraph* graph, int input,
+                                             int offset) {
+  std::vector<int> outputs;
+  MP_RETURN_IF_ERROR(
+      graph->ObserveOutputStream("out", [&outputs](const Packet& packet) {
+        outputs.push_back(packet.Get<int>());
+        return absl::OkStatus();
+      }));
+  MP_RETURN_IF_ERROR(graph->StartRun({{"offset", MakePacket<int>(offset)}}));
+  MP_RETURN_IF_ERROR(graph->AddPacketToInputStream(
+      "in", MakePacket<int>(input).At(Timestamp(0))));
+  MP_RETURN_IF_ERROR(graph->CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph->WaitUntilDone());
+  return outputs;
+}
+
+TEST(CalculatorGraphPoolTest, ReusesReleasedGraph) {
+  CalculatorGraphPool pool;
+  const CalculatorGraphConfig config = AddGraphConfig();
+  auto graph_or = pool.Acquire(config);
+  MP_ASSERT_OK(graph_or);
+  std::unique_ptr<CalculatorGraph> graph = std::move(graph_or).value();
+  CalculatorGraph* graph_ptr = graph.get();
+  auto outputs = RunAddGraph(graph.get(), 1, 10);
+  MP_ASSERT_OK(outputs);
+  EXPECT_EQ(*outputs, std::vector<int>({11}));
+  pool.Release(config, std::move(graph));
+  EXPECT_EQ(pool.NumIdleGraphs(config), 1);
+
+  graph_or = pool.Acquire(config);
+  MP_ASSERT_OK(graph_or);
+  graph = std::move(graph_or).value();
+  EXPECT_EQ(graph.get(), graph_ptr);
+  EXPECT_EQ(pool.NumIdleGraphs(config), 0);
+  // The observer of the previous run has been removed.
+  outputs = RunAddGraph(graph.get(), 2, 20);
+  MP_ASSERT_OK(outputs);
+  EXPECT_EQ(*outputs, std::vector<int>({22}));
+}
+
+TEST(CalculatorGraphPoolTest, KeysGraphsByConfig) {
+  CalculatorGraphPool pool;
+  const CalculatorGraphConfig config = AddGraphConfig();
+  CalculatorGraphConfig other_config = AddGraphConfig();
+  other_config.set_max_queue_size(3);
+  auto graph_or = pool.Acquire(config);
+  MP_ASSERT_OK(graph_or);
+  pool.Release(config, std::move(graph_or).value());
+  EXPECT_EQ(pool.NumIdleGraphs(config), 1);
+  EXPECT_EQ(pool.NumIdleGraphs(other_config), 0);
+  graph_or = pool.Acquire(other_config);
+  MP_ASSERT_OK(graph_or);
+  EXPECT_EQ(pool.NumIdleGraphs(config), 1);
+  pool.Clear();
+  EXPECT_EQ(pool.NumIdleGraphs(config), 0);
+}
+
+TEST(CalculatorGraphPoolTest, LimitsIdleGraphs) {
+  CalculatorGraphPool pool(/*max_idle_graphs_per_config=*/1);
+  const CalculatorGraphConfig config = AddGraphConfig();
+  auto graph_or_1 = pool.Acquire(config);
+  MP_ASSERT_OK(graph_or_1);
+  auto graph_or_2 = pool.Acquire(config);
+  MP_ASSERT_OK(graph_or_2);
+  pool.Release(config, std::move(graph_or_1).value());
+  pool.Release(config, std::move(graph_or_2).value());
+  EXPECT_EQ(pool.NumIdleGraphs(config), 1);
+}
+
+TEST(CalculatorGraphPoolTest, ReusesResettableCalculators) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(AddGraphConfig()));
+  num_constructed = 0;
+  num_opened = 0;
+  for (int run = 0; run < 3; ++run) {
+    auto outputs = RunAddGraph(&graph, run, 100);
+    MP_ASSERT_OK(outputs);
+    EXPECT_EQ(*outputs, std::vector<int>({run + 100}));
+    MP_ASSERT_OK(graph.Reset());
+  }
+  EXPECT_EQ(num_constructed, 1);
+  EXPECT_EQ(num_opened, 3);
+}
+
+TEST(CalculatorGraphPoolTest, ResetFailsWhileRunning) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(AddGraphConfig()));
+  MP_ASSERT_OK(graph.StartRun({{"offset", MakePacket<int>(0)}}));
+  EXPECT_FALSE(graph.Reset().ok());
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  MP_EXPECT_OK(graph.Reset());
+}
+
+TEST(CalculatorGraphPoolTest, SharedAcrossThreads) {
+  CalculatorGraphPool pool;
+  const CalculatorGraphConfig config = AddGraphConfig();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, &config, t] {
+      for (int i = 0; i < 10; ++i) {
+        auto graph_or = pool.Acquire(config);
+        MP_ASSERT_OK(graph_or);
+        std::unique_ptr<CalculatorGraph> graph = std::move(graph_or).value();
+        auto outputs = RunAddGraph(graph.get(), i, t);
+        MP_ASSERT_OK(outputs);
+        EXPECT_EQ(*outputs, std::vector<int>({i + t}));
+        pool.Release(config, std::move(graph));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(pool.NumIdleGraphs(config), 4);
+}
+
+}  // namespace
+}  // namespace mediapipe
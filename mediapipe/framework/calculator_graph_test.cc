@@ -3324,6 +3324,92 @@ TEST(CalculatorGraph, SetInputStreamMaxQueueSizeWorksSlowCalculator) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+// A payload that reports the memory it owns for byte-based queue limits.
+struct Blob {
+  std::vector<char> bytes;
+};
+
+size_t MediaPipePacketSizeHint(const Blob& blob) {
+  return sizeof(blob) + blob.bytes.size();
+}
+
+TEST(CalculatorGraph, MaxQueueBytesThrottlesLargePackets) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in_2'
+          output_stream: 'out_2'
+          input_side_packet: 'POST_SEM:post_sem_busy'
+          input_side_packet: 'WAIT_SEM:wait_sem_busy'
+        }
+        input_stream: 'in'
+        input_stream: 'in_2'
+        max_queue_size: 100
+        max_queue_bytes: 1000
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  EXPECT_EQ(1000, graph.GetMaxInputStreamQueueBytes());
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  Semaphore calc_entered_process_busy(0);
+  Semaphore calc_can_exit_process_busy(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+      {"post_sem_busy", MakePacket<Semaphore*>(&calc_entered_process_busy)},
+      {"wait_sem_busy", MakePacket<Semaphore*>(&calc_can_exit_process_busy)},
+  }));
+
+  const int64 blob_bytes = sizeof(Blob) + 1000;
+  Timestamp timestamp(0);
+  // Prevent deadlock resolution by running the "busy" SemaphoreCalculator
+  // for the duration of the test.
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream("in_2", MakePacket<int>(0).At(timestamp)));
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "in", MakePacket<Blob>(Blob{std::vector<char>(1000)}).At(timestamp++)));
+  for (int i = 1; i < 5; ++i, ++timestamp) {
+    calc_entered_process.Acquire(1);
+    // A single blob fills the 1000 byte queue even though it holds far fewer
+    // than max_queue_size packets.
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<Blob>(Blob{std::vector<char>(1000)}).At(timestamp)));
+    absl::Status status = graph.AddPacketToInputStream(
+        "in", MakePacket<Blob>(Blob{std::vector<char>(1000)})
+                  .At(timestamp + 1));
+    EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+    calc_can_exit_process.Release(1);
+  }
+  calc_can_exit_process.Release(1);
+  calc_can_exit_process_busy.Release(1);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  bool found = false;
+  for (const auto& stats : graph.GetInputStreamMemoryStats()) {
+    if (stats.stream_name == "in") {
+      found = true;
+      EXPECT_EQ(0, stats.queue_bytes);
+      EXPECT_EQ(blob_bytes, stats.peak_queue_bytes);
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
 // Verify the scheduler unthrottles the graph input stream to avoid a deadlock,
 // and won't enter a busy loop.
 TEST(CalculatorGraph, AddPacketNoBusyLoop) {
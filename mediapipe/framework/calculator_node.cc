@@ -139,6 +139,7 @@ absl::Status CalculatorNode::Initialize(
     executor_ = node_config.executor();
   }
   source_layer_ = node_config.source_layer();
+  latency_budget_usec_ = node_config.latency_budget_usec();
 
   const NodeTypeInfo& node_type_info =
       validated_graph_->CalculatorInfos()[node_id_];
@@ -147,6 +148,7 @@ absl::Status CalculatorNode::Initialize(
   uses_gpu_ =
       node_type_info.InputSidePacketTypes().HasTag(kGpuSharedTagName) ||
       ContainsKey(node_type_info.Contract().ServiceRequests(), kGpuService.key);
+  run_inline_ = contract.GetRunInline();
 
   // TODO Propagate types between calculators when SetAny is used.
 
@@ -291,6 +293,17 @@ absl::Status CalculatorNode::InitializeInputStreams(
             << " which will be connected to output stream with flat index "
             << output_stream_index;
     origin_output_stream_manager->AddMirror(input_stream_handler_.get(), id);
+    // Packets from another calculator are propagated by a single thread at a
+    // time, whereas graph input streams can be written by any thread.
+    const NodeTypeInfo::NodeType producer_type =
+        validated_graph_->OutputStreamInfos()[output_stream_index]
+            .parent_node.type;
+    // Byte-based queue limits are only supported by the locked queue.
+    if (producer_type == NodeTypeInfo::NodeType::CALCULATOR &&
+        validated_graph_->Config().max_queue_bytes() <= 0 &&
+        input_stream_handler_->SupportsLockFreeInputStreams()) {
+      input_stream_handler_->GetInputStreamManager(id)->EnableLockFreeQueue();
+    }
   }
   return absl::OkStatus();
 }
@@ -370,6 +383,11 @@ void CalculatorNode::SetMaxInputStreamQueueSize(int max_queue_size) {
   input_stream_handler_->SetMaxQueueSize(max_queue_size);
 }
 
+void CalculatorNode::SetMaxInputStreamQueueBytes(int64 max_queue_bytes) {
+  CHECK(input_stream_handler_);
+  input_stream_handler_->SetMaxQueueBytes(max_queue_bytes);
+}
+
 absl::Status CalculatorNode::PrepareForRun(
     const std::map<std::string, Packet>& all_side_packets,
     const std::map<std::string, Packet>& service_packets,
@@ -421,12 +439,15 @@ absl::Status CalculatorNode::PrepareForRun(
   MP_RETURN_IF_ERROR(calculator_context_manager_.PrepareForRun(std::bind(
       &CalculatorNode::ConnectShardsToStreams, this, std::placeholders::_1)));
 
-  ASSIGN_OR_RETURN(
-      auto calculator_factory,
-      CalculatorBaseRegistry::CreateByNameInNamespace(
-          validated_graph_->Package(), calculator_state_->CalculatorType()));
-  calculator_ = calculator_factory->CreateCalculator(
-      calculator_context_manager_.GetDefaultCalculatorContext());
+  // A calculator kept by CleanupAfterRun() is reused.
+  if (!calculator_) {
+    ASSIGN_OR_RETURN(
+        auto calculator_factory,
+        CalculatorBaseRegistry::CreateByNameInNamespace(
+            validated_graph_->Package(), calculator_state_->CalculatorType()));
+    calculator_ = calculator_factory->CreateCalculator(
+        calculator_context_manager_.GetDefaultCalculatorContext());
+  }
 
   needs_to_close_ = false;
 
@@ -636,7 +657,10 @@ void CalculatorNode::CleanupAfterRun(const absl::Status& graph_status) {
         Timestamp::Done());
     CloseNode(graph_status, /*graph_run_ended=*/true).IgnoreError();
   }
-  calculator_ = nullptr;
+  // Keep the calculator for the next run if it supports being reset.
+  if (calculator_ && !(graph_status.ok() && calculator_->Reset())) {
+    calculator_ = nullptr;
+  }
   // All pending output packets are automatically dropped when calculator
   // context manager destroys all calculator context objects.
   calculator_context_manager_.CleanupAfterRun();
@@ -161,6 +161,10 @@ class CalculatorNode {
 
   int source_layer() const { return source_layer_; }
 
+  // Returns the latency budget of the node in microseconds, or 0 if the node
+  // has none. See CalculatorGraphConfig::Node::latency_budget_usec.
+  int64 latency_budget_usec() const { return latency_budget_usec_; }
+
   // Checks if the node can be scheduled; if so, increases current_in_flight_
   // and returns true; otherwise, returns false.
   // If true is returned, the scheduler must commit to executing the node, and
@@ -197,6 +201,14 @@ class CalculatorNode {
   // Returns whether this is a GPU calculator node.
   bool UsesGpu() const { return uses_gpu_; }
 
+  // Returns true if the calculator may run inline on the thread that made its
+  // inputs ready. See CalculatorContract::SetRunInline.
+  bool RunsInline() const { return run_inline_; }
+
+  // Makes the calculator run inline regardless of its contract. Used by
+  // CalculatorGraph for fused node chains.
+  void SetRunInline(bool run_inline) { run_inline_ = run_inline; }
+
   // Returns the scheduler queue the node is assigned to.
   internal::SchedulerQueue* GetSchedulerQueue() const {
     return scheduler_queue_;
@@ -216,6 +228,10 @@ class CalculatorNode {
   // max_queue_size to trigger callbacks.
   void SetMaxInputStreamQueueSize(int max_queue_size);
 
+  // Sets each of this node's input streams to use the specified
+  // max_queue_bytes to trigger callbacks.
+  void SetMaxInputStreamQueueBytes(int64 max_queue_bytes);
+
   // Closes the node's calculator and input and output streams.
   // graph_status is the current status of the graph run. graph_run_ended
   // indicates whether the graph run has ended.
@@ -294,6 +310,8 @@ class CalculatorNode {
   std::string executor_;
   // The layer a source calculator operates on.
   int source_layer_ = 0;
+  // The time allowed for the node to process a packet, in microseconds.
+  int64 latency_budget_usec_ = 0;
   // The status of the current Calculator that this CalculatorNode
   // is wrapping.  kStateActive is currently used only for source nodes.
   enum NodeStatus {
@@ -366,6 +384,9 @@ class CalculatorNode {
   // Whether this is a GPU calculator.
   bool uses_gpu_ = false;
 
+  // Whether the calculator may run inline.
+  bool run_inline_ = false;
+
   // True if CleanupAfterRun() needs to call CloseNode().
   bool needs_to_close_ = false;
 
@@ -46,6 +46,12 @@ class ThreadOptions {
     return *this;
   }
 
+  // Binds the memory allocated by the thread to the given NUMA nodes.
+  ThreadOptions& set_numa_node_set(const std::set<int>& numa_node_set) {
+    numa_node_set_ = numa_node_set;
+    return *this;
+  }
+
   ThreadOptions& set_name_prefix(const std::string& name_prefix) {
     name_prefix_ = name_prefix;
     return *this;
@@ -57,12 +63,15 @@ class ThreadOptions {
 
   const std::set<int>& cpu_set() const { return cpu_set_; }
 
+  const std::set<int>& numa_node_set() const { return numa_node_set_; }
+
   std::string name_prefix() const { return name_prefix_; }
 
  private:
   size_t stack_size_;        // Size of thread stack
   int nice_priority_level_;  // Nice priority level of the workers
   std::set<int> cpu_set_;    // CPU set for affinity setting
+  std::set<int> numa_node_set_;  // NUMA nodes for memory binding
   std::string name_prefix_;  // Name of the thread
 };
 
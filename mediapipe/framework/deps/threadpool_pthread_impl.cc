@@ -18,6 +18,9 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 
+#include <set>
+#include <vector>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "mediapipe/framework/deps/threadpool.h"
@@ -25,6 +28,40 @@
 
 namespace mediapipe {
 
+#if defined(__linux__)
+namespace {
+
+// Restricts the memory allocations of the calling thread to the given NUMA
+// nodes, like numa_set_membind(), without a dependency on libnuma.
+void SetMemoryPolicy(const std::set<int>& numa_nodes) {
+#if defined(SYS_set_mempolicy)
+  // The MPOL_BIND mode from <linux/mempolicy.h>.
+  constexpr int kMemoryPolicyBind = 2;
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  const int max_node = *numa_nodes.rbegin() + 1;
+  std::vector<unsigned long> node_mask(  // NOLINT
+      (max_node + kBitsPerWord - 1) / kBitsPerWord, 0);
+  for (const int node : numa_nodes) {
+    node_mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+  }
+  // The kernel ignores the last bit of maxnode, so pass one extra.
+  if (syscall(SYS_set_mempolicy, kMemoryPolicyBind, node_mask.data(),
+              node_mask.size() * kBitsPerWord + 1) == 0) {
+    VLOG(1) << "Bound the thread pool executor memory to NUMA node "
+            << absl::StrJoin(numa_nodes, ", NUMA node ") << ".";
+  } else {
+    LOG(ERROR) << "Error : " << strerror(errno) << std::endl
+               << "Failed to set the memory policy. Ignore NUMA memory "
+                  "binding setting for now.";
+  }
+#else
+  LOG(ERROR) << "NUMA memory binding isn't supported on the current platform.";
+#endif  // SYS_set_mempolicy
+}
+
+}  // namespace
+#endif  // __linux__
+
 class ThreadPool::WorkerThread {
  public:
   // Creates and starts a thread that runs pool->RunWorker().
@@ -60,6 +97,8 @@ void* ThreadPool::WorkerThread::ThreadBody(void* arg) {
   int nice_priority_level =
       thread->pool_->thread_options().nice_priority_level();
   const std::set<int> selected_cpus = thread->pool_->thread_options().cpu_set();
+  const std::set<int> selected_numa_nodes =
+      thread->pool_->thread_options().numa_node_set();
 #if defined(__linux__)
   const std::string name =
       internal::CreateThreadName(thread->name_prefix_, syscall(SYS_gettid));
@@ -89,6 +128,9 @@ void* ThreadPool::WorkerThread::ThreadBody(void* arg) {
                     "affinity setting for now.";
     }
   }
+  if (!selected_numa_nodes.empty()) {
+    SetMemoryPolicy(selected_numa_nodes);
+  }
   int error = pthread_setname_np(pthread_self(), name.c_str());
   if (error != 0) {
     LOG(ERROR) << "Error : " << strerror(error) << std::endl
@@ -96,9 +138,10 @@ void* ThreadPool::WorkerThread::ThreadBody(void* arg) {
   }
 #else
   const std::string name = internal::CreateThreadName(thread->name_prefix_, 0);
-  if (nice_priority_level != 0 || !selected_cpus.empty()) {
-    LOG(ERROR) << "Thread priority and processor affinity feature aren't "
-                  "supported on the current platform.";
+  if (nice_priority_level != 0 || !selected_cpus.empty() ||
+      !selected_numa_nodes.empty()) {
+    LOG(ERROR) << "Thread priority, processor affinity and memory binding "
+                  "features aren't supported on the current platform.";
   }
 #if __APPLE__
   int error = pthread_setname_np(name.c_str());
@@ -66,9 +66,13 @@ void* ThreadPool::WorkerThread::ThreadBody(void* arg) {
   int nice_priority_level =
       thread->pool_->thread_options().nice_priority_level();
   const std::set<int> selected_cpus = thread->pool_->thread_options().cpu_set();
-  if (nice_priority_level != 0 || !selected_cpus.empty()) {
-    LOG(ERROR) << "Thread priority and processor affinity feature aren't "
-                  "supported by the std::thread threadpool implementation.";
+  const std::set<int> selected_numa_nodes =
+      thread->pool_->thread_options().numa_node_set();
+  if (nice_priority_level != 0 || !selected_cpus.empty() ||
+      !selected_numa_nodes.empty()) {
+    LOG(ERROR) << "Thread priority, processor affinity and memory binding "
+                  "features aren't supported by the std::thread threadpool "
+                  "implementation.";
   }
   thread->pool_->RunWorker();
   return nullptr;
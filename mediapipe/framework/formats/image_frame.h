@@ -35,6 +35,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_H_
 #define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_H_
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -252,6 +253,11 @@ class ImageFrame {
   std::unique_ptr<uint8[], Deleter> pixel_data_;
 };
 
+// Reports the pixel data of an ImageFrame for byte-based queue limits.
+inline size_t MediaPipePacketSizeHint(const ImageFrame& image_frame) {
+  return sizeof(ImageFrame) + image_frame.PixelDataSize();
+}
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_H_
@@ -25,7 +25,7 @@
 #include <mach/mach_init.h>
 #include <mach/vm_map.h>
 #else
-#include <cstdlib>
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #endif  // MEDIAPIPE_METAL_ENABLED
 
 namespace mediapipe {
@@ -307,6 +307,7 @@ void Tensor::Move(Tensor* src) {
   src->valid_ = kValidNone;
   shape_ = src->shape();
   element_type_ = src->element_type();
+  quantization_parameters_ = src->quantization_parameters();
   src->element_type_ = ElementType::kNone;  // Mark as invalidated.
   cpu_buffer_ = src->cpu_buffer_;
   src->cpu_buffer_ = nullptr;
@@ -335,6 +336,12 @@ void Tensor::Move(Tensor* src) {
 Tensor::Tensor(ElementType element_type, const Shape& shape)
     : element_type_(element_type), shape_(shape) {}
 
+Tensor::Tensor(ElementType element_type, const Shape& shape,
+               const QuantizationParameters& quantization_parameters)
+    : element_type_(element_type),
+      shape_(shape),
+      quantization_parameters_(quantization_parameters) {}
+
 void Tensor::Invalidate() {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
   GLuint cleanup_gl_tex = GL_INVALID_INDEX;
@@ -352,7 +359,7 @@ void Tensor::Invalidate() {
     metal_buffer_ = nil;
 #else
     if (cpu_buffer_) {
-      free(cpu_buffer_);
+      aligned_free(cpu_buffer_);
     }
 #endif  // MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = nullptr;
@@ -468,7 +475,7 @@ void Tensor::AllocateCpuBuffer() const {
 #if MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = AllocateVirtualMemory(bytes());
 #else
-    cpu_buffer_ = malloc(bytes());
+    cpu_buffer_ = aligned_malloc(bytes(), kCpuBufferAlignment);
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 }
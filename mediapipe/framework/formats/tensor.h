@@ -16,6 +16,7 @@
 #define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <initializer_list>
 #include <tuple>
 #include <type_traits>
@@ -75,8 +76,22 @@ class Tensor {
   };
 
  public:
+  // Alignment of CPU buffers, in bytes. Matches the alignment TfLite requires
+  // of custom tensor allocations so that CPU buffers can be handed to an
+  // interpreter without a copy.
+  static constexpr int kCpuBufferAlignment = 64;
+
   // No resources are allocated here.
-  enum class ElementType { kNone, kFloat16, kFloat32 };
+  enum class ElementType { kNone, kFloat16, kFloat32, kUInt8, kInt8, kInt32 };
+  // Affine quantization of kUInt8 and kInt8 tensors:
+  //   real_value = scale * (quantized_value - zero_point)
+  struct QuantizationParameters {
+    QuantizationParameters() : scale(1.0f), zero_point(0) {}
+    QuantizationParameters(float scale, int zero_point)
+        : scale(scale), zero_point(zero_point) {}
+    float scale;
+    int zero_point;
+  };
   struct Shape {
     Shape() = default;
     Shape(std::initializer_list<int> dimensions) : dims(dimensions) {}
@@ -90,6 +105,8 @@ class Tensor {
   };
 
   Tensor(ElementType element_type, const Shape& shape);
+  Tensor(ElementType element_type, const Shape& shape,
+         const QuantizationParameters& quantization_parameters);
 
   // Non-copyable.
   Tensor(const Tensor&) = delete;
@@ -207,6 +224,9 @@ class Tensor {
 
   const Shape& shape() const { return shape_; }
   ElementType element_type() const { return element_type_; }
+  const QuantizationParameters& quantization_parameters() const {
+    return quantization_parameters_;
+  }
   int element_size() const {
     switch (element_type_) {
       case ElementType::kNone:
@@ -215,6 +235,12 @@ class Tensor {
         return 2;
       case ElementType::kFloat32:
         return sizeof(float);
+      case ElementType::kUInt8:
+        return 1;
+      case ElementType::kInt8:
+        return 1;
+      case ElementType::kInt32:
+        return sizeof(int32_t);
     }
   }
   int bytes() const { return shape_.num_elements() * element_size(); }
@@ -236,6 +262,7 @@ class Tensor {
 
   ElementType element_type_;
   Shape shape_;
+  QuantizationParameters quantization_parameters_;
 
   // The flags describe the current source of truth resource type.
   enum {
@@ -274,6 +301,19 @@ class Tensor {
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 };
 
+// Report the tensor buffers for byte-based queue limits. Tensors are usually
+// sent as std::vector<Tensor>.
+inline size_t MediaPipePacketSizeHint(const Tensor& tensor) {
+  return sizeof(Tensor) + tensor.bytes();
+}
+inline size_t MediaPipePacketSizeHint(const std::vector<Tensor>& tensors) {
+  size_t size = sizeof(tensors);
+  for (const Tensor& tensor : tensors) {
+    size += MediaPipePacketSizeHint(tensor);
+  }
+  return size;
+}
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_H_
@@ -23,6 +23,27 @@ TEST(General, TestDataTypes) {
 
   Tensor t2(Tensor::ElementType::kFloat16, Tensor::Shape{4, 3, 2, 3});
   EXPECT_EQ(t2.bytes(), t2.shape().num_elements() * 2);
+
+  Tensor t3(Tensor::ElementType::kUInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t3.bytes(), t3.shape().num_elements());
+
+  Tensor t4(Tensor::ElementType::kInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t4.bytes(), t4.shape().num_elements());
+
+  Tensor t5(Tensor::ElementType::kInt32, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t5.bytes(), t5.shape().num_elements() * sizeof(int32_t));
+}
+
+TEST(General, TestQuantizationParameters) {
+  Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{1, 2, 3, 4});
+  EXPECT_EQ(t1.quantization_parameters().scale, 1.0f);
+  EXPECT_EQ(t1.quantization_parameters().zero_point, 0);
+
+  Tensor t2(Tensor::ElementType::kUInt8, Tensor::Shape{1, 2, 3, 4},
+            Tensor::QuantizationParameters(0.5f, 128));
+  Tensor t3(std::move(t2));
+  EXPECT_EQ(t3.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(t3.quantization_parameters().zero_point, 128);
 }
 
 TEST(Cpu, TestMemoryAllocation) {
@@ -32,6 +53,16 @@ TEST(Cpu, TestMemoryAllocation) {
   EXPECT_NE(f1, nullptr);
 }
 
+TEST(Cpu, TestMemoryAlignment) {
+  for (int size : {1, 3, 17, 1001}) {
+    Tensor t(Tensor::ElementType::kUInt8, Tensor::Shape{size});
+    auto view = t.GetCpuWriteView();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.buffer<uint8_t>()) %
+                  Tensor::kCpuBufferAlignment,
+              0);
+  }
+}
+
 TEST(Cpu, TestTensorMove) {
   Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{4, 3, 2, 3});
   void* p1 = t1.GetCpuWriteView().buffer<float>();
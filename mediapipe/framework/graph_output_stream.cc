@@ -38,9 +38,17 @@ absl::Status GraphOutputStream::Initialize(
   MP_RETURN_IF_ERROR(input_stream_handler_->InitializeInputStreamManagers(
       input_stream_.get()));
   output_stream_manager->AddMirror(input_stream_handler_.get(), id);
+  output_stream_manager_ = output_stream_manager;
   return absl::OkStatus();
 }
 
+void GraphOutputStream::Detach() {
+  if (output_stream_manager_) {
+    output_stream_manager_->RemoveMirror(input_stream_handler_.get());
+    output_stream_manager_ = nullptr;
+  }
+}
+
 void GraphOutputStream::PrepareForRun(
     std::function<void()> notification_callback,
     std::function<void(absl::Status)> error_callback) {
@@ -54,6 +54,10 @@ class GraphOutputStream {
                           const PacketType* packet_type,
                           OutputStreamManager* output_stream_manager);
 
+  // Detaches the graph output stream from the output stream it observes.
+  // Must not be called during a graph run.
+  void Detach();
+
   // Installs callbacks into its GraphOutputStreamHandler.
   virtual void PrepareForRun(std::function<void()> notification_callback,
                              std::function<void(absl::Status)> error_callback);
@@ -101,6 +105,8 @@ class GraphOutputStream {
 
   std::unique_ptr<InputStreamHandler> input_stream_handler_;
   std::unique_ptr<InputStreamManager> input_stream_;
+  // The observed output stream, owned by the graph.
+  OutputStreamManager* output_stream_manager_ = nullptr;
 };
 
 // OutputStreamObserver that observes the output stream and passes packets to
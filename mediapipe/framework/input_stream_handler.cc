@@ -127,6 +127,17 @@ void InputStreamHandler::SetMaxQueueSize(int max_queue_size) {
   }
 }
 
+void InputStreamHandler::SetMaxQueueBytes(CollectionItemId id,
+                                          int64 max_queue_bytes) {
+  input_stream_managers_.Get(id)->SetMaxQueueBytes(max_queue_bytes);
+}
+
+void InputStreamHandler::SetMaxQueueBytes(int64 max_queue_bytes) {
+  for (auto& stream : input_stream_managers_) {
+    stream->SetMaxQueueBytes(max_queue_bytes);
+  }
+}
+
 std::string InputStreamHandler::DebugStreamNames() const {
   std::vector<absl::string_view> stream_names;
   for (const auto& stream : input_stream_managers_) {
@@ -236,29 +247,45 @@ CalculatorContext* GetCalculatorContext(CalculatorContextManager* manager) {
              : nullptr;
 }
 
-// Logs the current queue size of an input stream.
+// Logs the arrival of each packet and the resulting queue size of an input
+// stream.
 void LogQueuedPackets(CalculatorContext* context, InputStreamManager* stream,
-                      Packet queue_tail) {
-  if (context) {
+                      const std::list<Packet>& packets) {
+  if (context && !packets.empty()) {
     TraceEvent event = TraceEvent(TraceEvent::PACKET_QUEUED)
                            .set_node_id(context->NodeId())
-                           .set_input_ts(queue_tail.Timestamp())
-                           .set_stream_id(&stream->Name())
-                           .set_event_data(stream->QueueSize() + 1);
-    mediapipe::LogEvent(context->GetProfilingContext(),
-                        event.set_packet_ts(queue_tail.Timestamp()));
-    Packet queue_head = stream->QueueHead();
-    if (!queue_head.IsEmpty()) {
+                           .set_stream_id(&stream->Name());
+    int queue_size = stream->QueueSize();
+    for (const Packet& packet : packets) {
+      event.set_input_ts(packet.Timestamp()).set_event_data(++queue_size);
       mediapipe::LogEvent(context->GetProfilingContext(),
-                          event.set_packet_ts(queue_head.Timestamp()));
+                          event.set_packet_ts(packet.Timestamp()));
     }
+    const Timestamp queue_head = stream->QueueHeadTimestamp();
+    if (queue_head != Timestamp::Unset()) {
+      mediapipe::LogEvent(context->GetProfilingContext(),
+                          event.set_packet_ts(queue_head));
+    }
+  }
+}
+
+void InputStreamHandler::LogDroppedPackets(InputStreamManager* stream,
+                                           int count) {
+  CalculatorContext* context =
+      GetCalculatorContext(calculator_context_manager_);
+  if (context && count > 0) {
+    mediapipe::LogEvent(context->GetProfilingContext(),
+                        TraceEvent(TraceEvent::PACKET_DROPPED)
+                            .set_node_id(context->NodeId())
+                            .set_stream_id(&stream->Name())
+                            .set_event_data(count));
   }
 }
 
 void InputStreamHandler::AddPackets(CollectionItemId id,
                                     const std::list<Packet>& packets) {
   LogQueuedPackets(GetCalculatorContext(calculator_context_manager_),
-                   input_stream_managers_.Get(id), packets.back());
+                   input_stream_managers_.Get(id), packets);
   bool notify = false;
   absl::Status result =
       input_stream_managers_.Get(id)->AddPackets(packets, &notify);
@@ -273,7 +300,7 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
 void InputStreamHandler::MovePackets(CollectionItemId id,
                                      std::list<Packet>* packets) {
   LogQueuedPackets(GetCalculatorContext(calculator_context_manager_),
-                   input_stream_managers_.Get(id), packets->back());
+                   input_stream_managers_.Get(id), *packets);
   bool notify = false;
   absl::Status result =
       input_stream_managers_.Get(id)->MovePackets(packets, &notify);
@@ -110,6 +110,13 @@ class InputStreamHandler {
 
   int NumInputStreams() const { return input_stream_managers_.NumEntries(); }
 
+  // Returns true if this handler only reads its input streams through
+  // MinTimestampOrBound(), PopPacketAtTimestamp() and QueueSize(), and only
+  // from the node's scheduling loop. The input streams of such a handler can
+  // use InputStreamManager::EnableLockFreeQueue() when they have a single
+  // producer.
+  virtual bool SupportsLockFreeInputStreams() const { return false; }
+
   // Returns the tag map of the input streams.
   const std::shared_ptr<tool::TagMap>& InputTagMap() const {
     return input_stream_managers_.TagMap();
@@ -127,6 +134,12 @@ class InputStreamHandler {
   // Sets max queue size of a particular stream.
   void SetMaxQueueSize(CollectionItemId id, int max_queue_size);
 
+  // Sets max queue bytes of every stream.
+  void SetMaxQueueBytes(int64 max_queue_bytes);
+
+  // Sets max queue bytes of a particular stream.
+  void SetMaxQueueBytes(CollectionItemId id, int64 max_queue_bytes);
+
   void SetQueueSizeCallbacks(
       InputStreamManager::QueueSizeCallback becomes_full_callback,
       InputStreamManager::QueueSizeCallback becomes_not_full_callback);
@@ -251,6 +264,10 @@ class InputStreamHandler {
     shard->AddPacket(std::move(value), is_done);
   }
 
+  // Records that |count| packets were dropped from an input stream without
+  // being processed.
+  void LogDroppedPackets(InputStreamManager* stream, int count);
+
   // Returns the operation the calculator node is ready for.
   // Specifically:
   // - NodeReadiness::kNotReady if the node's Process() or Close() cannot be
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -27,6 +28,13 @@
 
 namespace mediapipe {
 
+namespace {
+
+// Upper bound on the lock-free queue segment size, in packets.
+constexpr int kMaxLockFreeSegmentCapacity = 1024;
+
+}  // namespace
+
 absl::Status InputStreamManager::Initialize(const std::string& name,
                                             const PacketType* packet_type,
                                             bool back_edge) {
@@ -46,9 +54,26 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
+void InputStreamManager::EnableLockFreeQueue() { lock_free_ = true; }
+
 void InputStreamManager::PrepareForRun() {
   absl::MutexLock stream_lock(&stream_mutex_);
+  if (lock_free_) {
+    // A segment as large as the max queue size holds the whole queue while
+    // the producer is throttled, so the queue then works as a ring buffer.
+    lock_free_queue_.Reset(
+        max_queue_size_ > 0
+            ? std::min(max_queue_size_, kMaxLockFreeSegmentCapacity)
+            : LockFreePacketQueue::kDefaultSegmentCapacity);
+    lock_free_queue_size_ = 0;
+    lock_free_pushed_timestamps_.clear();
+    lock_free_bound_ = Timestamp::PreStream().Value();
+    lock_free_closed_ = false;
+    lock_free_max_queue_size_ = max_queue_size_;
+  }
   queue_.clear();
+  queue_bytes_ = 0;
+  peak_queue_bytes_ = 0;
   last_reported_stream_full_ = false;
   num_packets_added_ = 0;
   next_timestamp_bound_ = Timestamp::PreStream();
@@ -58,11 +83,19 @@ void InputStreamManager::PrepareForRun() {
 }
 
 bool InputStreamManager::IsEmpty() const {
+  if (lock_free_) {
+    return lock_free_queue_size_ == 0;
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   return queue_.empty();
 }
 
 Packet InputStreamManager::QueueHead() const {
+  if (lock_free_) {
+    // Only the consumer owns the head of the queue, see EnableLockFreeQueue.
+    auto& queue = const_cast<LockFreePacketQueue&>(lock_free_queue_);
+    return queue.Empty() ? Packet() : queue.Front();
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (queue_.empty()) {
     return Packet();
@@ -90,9 +123,58 @@ absl::Status InputStreamManager::MovePackets(std::list<Packet>* container,
   return AddOrMovePacketsInternal<std::list<Packet>&>(*container, notify);
 }
 
+absl::Status InputStreamManager::ValidatePacket(
+    const Packet& packet, Timestamp next_timestamp_bound,
+    int64 num_packets_added) const {
+  absl::Status result = packet_type_->Validate(packet);
+  if (!result.ok()) {
+    return tool::AddStatusPrefix(
+        absl::StrCat(
+            "Packet type mismatch on a calculator receiving from stream \"",
+            name_, "\": "),
+        result);
+  }
+
+  const Timestamp timestamp = packet.Timestamp();
+  if (!timestamp.IsAllowedInStream()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "In stream \"" << name_
+           << "\", timestamp not specified or set to illegal value: "
+           << timestamp.DebugString();
+  }
+  if (enable_timestamps_) {
+    // Check that PostStream(), if used, is the only timestamp used.  This
+    // is also true for PreStream() but doesn't need to be checked because
+    // Timestamp::PreStream().NextAllowedInStream() is
+    // Timestamp::OneOverPostStream().
+    if (timestamp == Timestamp::PostStream() && num_packets_added > 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "In stream \"" << name_
+             << "\", a packet at Timestamp::PostStream() must be the only "
+                "Packet in an InputStream.";
+    }
+    if (timestamp < next_timestamp_bound) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "Packet timestamp mismatch on a calculator receiving from "
+                "stream \""
+             << name_ << "\". Current minimum expected timestamp is "
+             << next_timestamp_bound.DebugString() << " but received "
+             << timestamp.DebugString()
+             << ". Are you using a custom InputStreamHandler? Note that "
+                "some InputStreamHandlers allow timestamps that are not "
+                "strictly monotonically increasing. See for example the "
+                "ImmediateInputStreamHandler class comment.";
+    }
+  }
+  return absl::OkStatus();
+}
+
 template <typename Container>
 absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                                                           bool* notify) {
+  if (lock_free_) {
+    return AddOrMovePacketsLockFree<Container>(container, notify);
+  }
   *notify = false;
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
@@ -103,51 +185,13 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
       return absl::OkStatus();
     }
     // Check if the queue was full before packets came in.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = ReachesLimits(queue_.size(), queue_bytes_);
     // Check if the queue becomes non-empty.
     queue_became_non_empty = queue_.empty() && !container.empty();
     for (auto& packet : container) {
-      absl::Status result = packet_type_->Validate(packet);
-      if (!result.ok()) {
-        return tool::AddStatusPrefix(
-            absl::StrCat(
-                "Packet type mismatch on a calculator receiving from stream \"",
-                name_, "\": "),
-            result);
-      }
-
+      MP_RETURN_IF_ERROR(
+          ValidatePacket(packet, next_timestamp_bound_, num_packets_added_));
       const Timestamp timestamp = packet.Timestamp();
-      if (!timestamp.IsAllowedInStream()) {
-        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-               << "In stream \"" << name_
-               << "\", timestamp not specified or set to illegal value: "
-               << timestamp.DebugString();
-      }
-      if (enable_timestamps_) {
-        // Check that PostStream(), if used, is the only timestamp used.  This
-        // is also true for PreStream() but doesn't need to be checked because
-        // Timestamp::PreStream().NextAllowedInStream() is
-        // Timestamp::OneOverPostStream().
-        if (timestamp == Timestamp::PostStream() && num_packets_added_ > 0) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "In stream \"" << name_
-                 << "\", a packet at Timestamp::PostStream() must be the only "
-                    "Packet in an InputStream.";
-        }
-        if (timestamp < next_timestamp_bound_) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "Packet timestamp mismatch on a calculator receiving from "
-                    "stream \""
-                 << name_ << "\". Current minimum expected timestamp is "
-                 << next_timestamp_bound_.DebugString() << " but received "
-                 << timestamp.DebugString()
-                 << ". Are you using a custom InputStreamHandler? Note that "
-                    "some InputStreamHandlers allow timestamps that are not "
-                    "strictly monotonically increasing. See for example the "
-                    "ImmediateInputStreamHandler class comment.";
-        }
-      }
       next_timestamp_bound_ = timestamp.NextAllowedInStream();
 
       // If the caller is MovePackets(), packet's underlying holder should be
@@ -155,6 +199,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
       ++num_packets_added_;
       VLOG(3) << "Input stream:" << name_
               << " has added packet at time: " << packet.Timestamp();
+      AddQueueBytes(packet.GetSizeHint());
       if (std::is_const<
               typename std::remove_reference<Container>::type>::value) {
         queue_.emplace_back(packet);
@@ -162,8 +207,8 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         queue_.emplace_back(std::move(packet));
       }
     }
-    queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
-                         queue_.size() >= max_queue_size_);
+    queue_became_full =
+        !was_queue_full && ReachesLimits(queue_.size(), queue_bytes_);
     if (queue_.size() > 1) {
       VLOG(3) << "Queue size greater than 1: stream name: " << name_
               << " queue_size: " << queue_.size();
@@ -180,8 +225,106 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
   return absl::OkStatus();
 }
 
+// Packets are pushed before the bound is raised past them, and the consumer
+// reads the bound before looking at the queue. So a consumer that sees the
+// new bound also sees the packets below it.
+template <typename Container>
+absl::Status InputStreamManager::AddOrMovePacketsLockFree(Container container,
+                                                          bool* notify)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  *notify = false;
+  if (lock_free_closed_) {
+    return absl::OkStatus();
+  }
+  const int max_queue_size = lock_free_max_queue_size_;
+  bool queue_became_full = false;
+  absl::Status status;
+  for (auto& packet : container) {
+    status = ValidatePacket(
+        packet, Timestamp::CreateNoErrorChecking(lock_free_bound_),
+        num_packets_added_);
+    if (!status.ok()) {
+      break;
+    }
+    const Timestamp timestamp = packet.Timestamp();
+    const Timestamp next_bound = timestamp.NextAllowedInStream();
+    ++num_packets_added_;
+    VLOG(3) << "Input stream:" << name_
+            << " has added packet at time: " << packet.Timestamp();
+    // Byte limits are not supported in this mode, but the statistics are
+    // still maintained.
+    AddQueueBytes(packet.GetSizeHint());
+    if (std::is_const<
+            typename std::remove_reference<Container>::type>::value) {
+      lock_free_queue_.Push(packet);
+    } else {
+      lock_free_queue_.Push(std::move(packet));
+    }
+    RaiseLockFreeBound(next_bound);
+    lock_free_pushed_timestamps_.push_back(timestamp);
+    const int queue_size_before = lock_free_queue_size_.fetch_add(1);
+    // The consumer may have drained the queue while we were pushing, so any
+    // push onto an empty queue requires a notification.
+    if (queue_size_before == 0) {
+      *notify = true;
+    }
+    if (queue_size_before + 1 == max_queue_size) {
+      queue_became_full = true;
+    }
+  }
+  TrimPushedTimestampsLockFree();
+  if (queue_became_full) {
+    VLOG(3) << "Queue became full: " << Name();
+    becomes_full_callback_(this, &last_reported_stream_full_);
+  }
+  return status;
+}
+
+void InputStreamManager::TrimPushedTimestampsLockFree() const {
+  // The consumer only shrinks the queue, so the packets still queued are the
+  // last lock_free_queue_size_ ones pushed.
+  const int queue_size = lock_free_queue_size_;
+  while (lock_free_pushed_timestamps_.size() > queue_size) {
+    lock_free_pushed_timestamps_.pop_front();
+  }
+}
+
+void InputStreamManager::RaiseLockFreeBound(Timestamp bound) {
+  int64 current = lock_free_bound_;
+  while (current < bound.Value() &&
+         !lock_free_bound_.compare_exchange_weak(current, bound.Value())) {
+  }
+}
+
+absl::Status InputStreamManager::SetNextTimestampBoundLockFree(
+    const Timestamp bound, bool* notify) {
+  *notify = false;
+  if (lock_free_closed_) {
+    return absl::OkStatus();
+  }
+  const Timestamp current =
+      Timestamp::CreateNoErrorChecking(lock_free_bound_);
+  if (enable_timestamps_ && bound < current) {
+    return mediapipe::UnknownErrorBuilder(MEDIAPIPE_LOC)
+           << "SetNextTimestampBound must be called with a timestamp greater "
+              "than or equal to the current bound. In stream \""
+           << name_ << "\". Current minimum expected timestamp is "
+           << current.DebugString() << " but received " << bound.DebugString();
+  }
+  if (bound > current) {
+    RaiseLockFreeBound(bound);
+    // If the queue is not empty, the consumer cannot observe the new bound
+    // until it pops the remaining packets, at which point it reads it anyway.
+    *notify = lock_free_queue_size_ == 0;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
                                                        bool* notify) {
+  if (lock_free_) {
+    return SetNextTimestampBoundLockFree(bound, notify);
+  }
   *notify = false;
   {
     // Scope to prevent locking the stream when notification is called.
@@ -214,9 +357,18 @@ absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
   return absl::OkStatus();
 }
 
-void InputStreamManager::DisableTimestamps() { enable_timestamps_ = false; }
+void InputStreamManager::DisableTimestamps() {
+  CHECK(!lock_free_);
+  enable_timestamps_ = false;
+}
 
 void InputStreamManager::Close() {
+  if (lock_free_) {
+    if (!lock_free_closed_.exchange(true)) {
+      lock_free_bound_ = Timestamp::Done().Value();
+    }
+    return;
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (closed_) {
     return;
@@ -227,6 +379,11 @@ void InputStreamManager::Close() {
 }
 
 Timestamp InputStreamManager::MinTimestampOrBound(bool* is_empty) const {
+  if (lock_free_) {
+    // Only the consumer calls this, and it owns the head of the queue.
+    return const_cast<InputStreamManager*>(this)->MinTimestampOrBoundLockFree(
+        is_empty);
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (is_empty) {
     *is_empty = queue_.empty();
@@ -239,10 +396,76 @@ Timestamp InputStreamManager::MinTimestampOrBoundHelper() const
   return queue_.empty() ? next_timestamp_bound_ : queue_.front().Timestamp();
 }
 
+Timestamp InputStreamManager::MinTimestampOrBoundLockFree(bool* is_empty) {
+  // The bound must be read before the queue, see AddOrMovePacketsLockFree.
+  const Timestamp bound = Timestamp::CreateNoErrorChecking(lock_free_bound_);
+  const bool empty = lock_free_queue_.Empty();
+  if (is_empty) {
+    *is_empty = empty;
+  }
+  return empty ? bound : lock_free_queue_.Front().Timestamp();
+}
+
+Packet InputStreamManager::PopPacketAtTimestampLockFree(
+    Timestamp timestamp, int* num_packets_dropped, bool* stream_is_done)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  *num_packets_dropped = -1;
+  *stream_is_done = false;
+  Packet packet;
+  // Make sure timestamp didn't decrease from last time.
+  CHECK_LE(last_select_timestamp_, timestamp);
+  last_select_timestamp_ = timestamp;
+
+  // Make sure AddPacket and SetNextTimestampBound are not called with
+  // timestamps we have already passed.
+  RaiseLockFreeBound(timestamp.NextAllowedInStream());
+
+  // Advances time to timestamp.
+  Timestamp current_timestamp = Timestamp::Unset();
+  const int max_queue_size = lock_free_max_queue_size_;
+  int num_popped = 0;
+  int64 popped_bytes = 0;
+  while (!lock_free_queue_.Empty() &&
+         lock_free_queue_.Front().Timestamp() <= timestamp) {
+    packet = lock_free_queue_.Pop();
+    popped_bytes += packet.GetSizeHint();
+    current_timestamp = packet.Timestamp();
+    ++(*num_packets_dropped);
+    ++num_popped;
+  }
+  bool queue_became_non_full = false;
+  if (num_popped > 0) {
+    const int queue_size_before = lock_free_queue_size_.fetch_sub(num_popped);
+    queue_bytes_ -= popped_bytes;
+    queue_became_non_full = max_queue_size != -1 &&
+                            queue_size_before >= max_queue_size &&
+                            queue_size_before - num_popped < max_queue_size;
+  }
+  // Clear value_ if it doesn't have exactly the right timestamp.
+  if (current_timestamp != timestamp) {
+    // The timestamp bound reported when no packet is sent.
+    Timestamp bound = MinTimestampOrBoundLockFree(nullptr);
+    packet = Packet().At(bound.PreviousAllowedInStream());
+    ++(*num_packets_dropped);
+  }
+  *stream_is_done =
+      lock_free_queue_.Empty() && lock_free_bound_ == Timestamp::Done().Value();
+
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+  return packet;
+}
+
 Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
                                                 int* num_packets_dropped,
                                                 bool* stream_is_done) {
   CHECK(enable_timestamps_);
+  if (lock_free_) {
+    return PopPacketAtTimestampLockFree(timestamp, num_packets_dropped,
+                                        stream_is_done);
+  }
   *num_packets_dropped = -1;
   *stream_is_done = false;
   bool queue_became_non_full = false;
@@ -267,12 +490,12 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     Timestamp current_timestamp = Timestamp::Unset();
 
     // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = ReachesLimits(queue_.size(), queue_bytes_);
 
     while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      queue_bytes_ -= packet.GetSizeHint();
       current_timestamp = packet.Timestamp();
       ++(*num_packets_dropped);
     }
@@ -286,7 +509,8 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full =
+        was_queue_full && !ReachesLimits(queue_.size(), queue_bytes_);
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -298,6 +522,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
 
 Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   CHECK(!enable_timestamps_);
+  CHECK(!lock_free_);
   *stream_is_done = false;
   bool queue_became_non_full = false;
   Packet packet;
@@ -307,19 +532,20 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     VLOG(3) << "Input stream " << name_ << " selecting at queue head";
 
     // Check if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = ReachesLimits(queue_.size(), queue_bytes_);
 
     if (!queue_.empty()) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      queue_bytes_ -= packet.GetSizeHint();
     } else {
       packet = Packet();
     }
 
     VLOG(3) << "Input stream removed a packet:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full =
+        was_queue_full && !ReachesLimits(queue_.size(), queue_bytes_);
     *stream_is_done = IsDone();
   }
   if (queue_became_non_full) {
@@ -329,7 +555,24 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   return packet;
 }
 
+Timestamp InputStreamManager::QueueHeadTimestamp() const {
+  if (lock_free_) {
+    TrimPushedTimestampsLockFree();
+    return lock_free_pushed_timestamps_.empty()
+               ? Timestamp::Unset()
+               : lock_free_pushed_timestamps_.front();
+  }
+  absl::MutexLock stream_lock(&stream_mutex_);
+  if (queue_.empty()) {
+    return Timestamp::Unset();
+  }
+  return queue_.front().Timestamp();
+}
+
 int InputStreamManager::QueueSize() const {
+  if (lock_free_) {
+    return lock_free_queue_size_;
+  }
   absl::MutexLock lock(&stream_mutex_);
   return static_cast<int>(queue_.size());
 }
@@ -344,9 +587,39 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   bool is_full;
   {
     absl::MutexLock lock(&stream_mutex_);
-    was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    const int queue_size = lock_free_ ? lock_free_queue_size_.load()
+                                      : static_cast<int>(queue_.size());
+    was_full = ReachesLimits(queue_size, queue_bytes_);
     max_queue_size_ = max_queue_size;
-    is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    lock_free_max_queue_size_ = max_queue_size;
+    is_full = ReachesLimits(queue_size, queue_bytes_);
+  }
+
+  // QueueSizeCallback is called with no mutexes held.
+  if (!was_full && is_full) {
+    VLOG(3) << "Queue became full: " << Name();
+    becomes_full_callback_(this, &last_reported_stream_full_);
+  } else if (was_full && !is_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+}
+
+int64 InputStreamManager::MaxQueueBytes() const {
+  absl::MutexLock lock(&stream_mutex_);
+  return max_queue_bytes_;
+}
+
+void InputStreamManager::SetMaxQueueBytes(int64 max_queue_bytes) {
+  CHECK(!lock_free_ || max_queue_bytes == -1)
+      << "Byte limits are not supported on lock-free input stream " << name_;
+  bool was_full;
+  bool is_full;
+  {
+    absl::MutexLock lock(&stream_mutex_);
+    was_full = ReachesLimits(queue_.size(), queue_bytes_);
+    max_queue_bytes_ = max_queue_bytes;
+    is_full = ReachesLimits(queue_.size(), queue_bytes_);
   }
 
   // QueueSizeCallback is called with no mutexes held.
@@ -359,12 +632,31 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   }
 }
 
+bool InputStreamManager::ReachesLimits(int64 queue_size,
+                                       int64 queue_bytes) const {
+  return (max_queue_size_ != -1 && queue_size >= max_queue_size_) ||
+         (max_queue_bytes_ != -1 && queue_bytes >= max_queue_bytes_);
+}
+
+void InputStreamManager::AddQueueBytes(int64 bytes) {
+  const int64 queue_bytes = queue_bytes_ += bytes;
+  int64 peak = peak_queue_bytes_;
+  while (peak < queue_bytes &&
+         !peak_queue_bytes_.compare_exchange_weak(peak, queue_bytes)) {
+  }
+}
+
 bool InputStreamManager::IsFull() const {
+  if (lock_free_) {
+    const int max_queue_size = lock_free_max_queue_size_;
+    return max_queue_size != -1 && lock_free_queue_size_ >= max_queue_size;
+  }
   absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
+  return ReachesLimits(queue_.size(), queue_bytes_);
 }
 
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
+  CHECK(!lock_free_);
   absl::MutexLock lock(&stream_mutex_);
   if (queue_.empty()) {
     return Timestamp::Unset();
@@ -372,26 +664,31 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
   return (queue_.cend() - std::min((size_t)n, queue_.size()))->Timestamp();
 }
 
-void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
+int InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
+  CHECK(!lock_free_);
   bool queue_became_non_full = false;
+  int num_erased = 0;
   {
     absl::MutexLock lock(&stream_mutex_);
     // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = ReachesLimits(queue_.size(), queue_bytes_);
 
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
+      queue_bytes_ -= queue_.front().GetSizeHint();
       queue_.pop_front();
+      ++num_erased;
     }
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full =
+        was_queue_full && !ReachesLimits(queue_.size(), queue_bytes_);
   }
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
   }
+  return num_erased;
 }
 
 bool InputStreamManager::IsDone() const {
@@ -15,6 +15,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <list>
@@ -22,6 +23,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/lock_free_packet_queue.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
@@ -43,6 +45,12 @@ namespace mediapipe {
 // An input stream is written to by exactly one output stream and is read by a
 // single node. None of its methods should hold a lock when they invoke a
 // callback in the scheduler.
+//
+// When the producer side (AddPackets, MovePackets, SetNextTimestampBound) is
+// only ever invoked by one thread at a time, and the consumer side
+// (MinTimestampOrBound, PopPacketAtTimestamp, QueueHead, IsEmpty) likewise,
+// EnableLockFreeQueue() replaces the mutex-guarded packet deque with a
+// LockFreePacketQueue and atomics, so that none of these methods lock.
 class InputStreamManager {
  public:
   // Function type for becomes_full_callback and becomes_not_full_callback.
@@ -66,6 +74,17 @@ class InputStreamManager {
   // Returns true if the input stream is a back edge.
   bool BackEdge() const { return back_edge_; }
 
+  // Switches the stream to a lock-free single-producer single-consumer packet
+  // queue. See the class comment for the requirements on the callers. In this
+  // mode QueueHead() may only be called by the consumer, and
+  // DisableTimestamps(), PopQueueHead(), GetMinTimestampAmongNLatest() and
+  // ErasePacketsEarlierThan() are not supported. Must be called before
+  // PrepareForRun().
+  void EnableLockFreeQueue();
+
+  // Returns true if EnableLockFreeQueue() has been called.
+  bool IsLockFree() const { return lock_free_; }
+
   // Sets the header Packet.
   absl::Status SetHeader(const Packet& header);
 
@@ -140,6 +159,11 @@ class InputStreamManager {
   // Timestamp::Done() after the pop.
   Packet PopQueueHead(bool* stream_is_done) ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Returns the timestamp of the packet at the front of the queue, or
+  // Timestamp::Unset() if the queue is empty. Unlike QueueHead(), this may
+  // also be called by the producer of a lock-free queue.
+  Timestamp QueueHeadTimestamp() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns the number of packets in the queue.
   int QueueSize() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
@@ -154,6 +178,23 @@ class InputStreamManager {
   // of -1 means that there is no maximum queue size.
   void SetMaxQueueSize(int max_queue_size) ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Returns the estimated number of bytes held by the packets in the queue,
+  // see MediaPipePacketSizeHint in packet.h.
+  int64 QueueBytes() const { return queue_bytes_; }
+
+  // Returns the largest value of QueueBytes() since PrepareForRun().
+  int64 PeakQueueBytes() const { return peak_queue_bytes_; }
+
+  // Returns the max queue bytes. -1 indicates that there is no maximum.
+  int64 MaxQueueBytes() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
+  // Sets the maximum number of bytes held by the queue. The queue is full
+  // when it reaches either this limit or the maximum queue size. A value of
+  // -1 means that there is no byte limit. Byte limits are not supported in
+  // lock-free mode.
+  void SetMaxQueueBytes(int64 max_queue_bytes)
+      ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // If there are equal to or more than n packets in the queue, this function
   // returns the min timestamp of among the latest n packets of the queue.  If
   // there are fewer than n packets in the queue, this function returns
@@ -163,13 +204,14 @@ class InputStreamManager {
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // pop_front()s packets that are earlier than the given timestamp.
+  // Returns the number of packets erased.
   // NOTE: This is a public API intended for FixedSizeInputStreamHandler only.
-  void ErasePacketsEarlierThan(Timestamp timestamp)
+  int ErasePacketsEarlierThan(Timestamp timestamp)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
-  // If a maximum queue size is specified (!= -1), these callbacks that are
-  // invoked when the input queue becomes full (>= max_queue_size_) or when it
-  // becomes non-full (< max_queue_size_).
+  // If a maximum queue size or maximum queue bytes is specified (!= -1),
+  // these callbacks are invoked when the input queue becomes full (reaches
+  // either limit) or when it becomes non-full (is below both limits).
   void SetQueueSizeCallbacks(QueueSizeCallback becomes_full_callback,
                              QueueSizeCallback becomes_not_full_callback);
 
@@ -184,9 +226,39 @@ class InputStreamManager {
   absl::Status AddOrMovePacketsInternal(Container container, bool* notify)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Lock-free counterparts of the methods above, used when lock_free_ is true.
+  template <typename Container>
+  absl::Status AddOrMovePacketsLockFree(Container container, bool* notify);
+  absl::Status SetNextTimestampBoundLockFree(Timestamp bound, bool* notify);
+  Packet PopPacketAtTimestampLockFree(Timestamp timestamp,
+                                      int* num_packets_dropped,
+                                      bool* stream_is_done);
+  Timestamp MinTimestampOrBoundLockFree(bool* is_empty);
+
+  // Returns an error if |packet| cannot be added to the stream, given the
+  // current next timestamp bound and number of packets added so far.
+  absl::Status ValidatePacket(const Packet& packet,
+                              Timestamp next_timestamp_bound,
+                              int64 num_packets_added) const;
+
+  // Raises lock_free_bound_ to |bound| if it is lower.
+  void RaiseLockFreeBound(Timestamp bound);
+
+  // Drops the timestamps of packets popped by the consumer from
+  // lock_free_pushed_timestamps_. Only called by the producer.
+  void TrimPushedTimestampsLockFree() const;
+
   // Returns true if the next timestamp bound reaches Timestamp::Done().
   bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
 
+  // Returns true if a queue of |queue_size| packets holding |queue_bytes|
+  // bytes reaches max_queue_size_ or max_queue_bytes_.
+  bool ReachesLimits(int64 queue_size, int64 queue_bytes) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Adds |bytes| to queue_bytes_ and updates peak_queue_bytes_.
+  void AddQueueBytes(int64 bytes);
+
   // Returns the smallest timestamp at which this stream might see an input.
   Timestamp MinTimestampOrBoundHelper() const;
 
@@ -211,6 +283,15 @@ class InputStreamManager {
   // The maximum queue size for this stream if set.
   int max_queue_size_ ABSL_GUARDED_BY(stream_mutex_) = -1;
 
+  // The maximum number of bytes in the queue for this stream if set.
+  int64 max_queue_bytes_ ABSL_GUARDED_BY(stream_mutex_) = -1;
+
+  // The estimated number of bytes held by the queue and its maximum over the
+  // current run. Updated under stream_mutex_, or by the producer and the
+  // consumer in lock-free mode, and read without locking.
+  std::atomic<int64> queue_bytes_{0};
+  std::atomic<int64> peak_queue_bytes_{0};
+
   // Callback to notify the framework that we have hit the maximum queue size.
   QueueSizeCallback becomes_full_callback_;
 
@@ -222,6 +303,26 @@ class InputStreamManager {
   // fullness reported in the last completed QueueSizeCallback.
   // This variable is only accessed during the QueueSizeCallback.
   bool last_reported_stream_full_ = false;
+
+  // True if the lock-free members below are used instead of queue_,
+  // next_timestamp_bound_ and closed_. In that mode num_packets_added_ is
+  // only accessed by the producer and last_select_timestamp_ only by the
+  // consumer, so neither needs stream_mutex_.
+  bool lock_free_ = false;
+  LockFreePacketQueue lock_free_queue_;
+  // Number of packets in lock_free_queue_. The producer increments it after
+  // pushing and the consumer decrements it after popping; a producer that
+  // sees 0 knows the consumer may have observed an empty queue.
+  std::atomic<int> lock_free_queue_size_{0};
+  // Timestamps of the packets pushed by the producer, trimmed to the packets
+  // that may still be queued. Only accessed by the producer, which finds the
+  // queue head from lock_free_queue_size_ without reading the queue.
+  mutable std::deque<Timestamp> lock_free_pushed_timestamps_;
+  // Value of the next timestamp bound. Only ever raised.
+  std::atomic<int64> lock_free_bound_{0};
+  std::atomic<bool> lock_free_closed_{false};
+  // The max queue size. Read by both sides, written between runs.
+  std::atomic<int> lock_free_max_queue_size_{-1};
 };
 
 }  // namespace mediapipe
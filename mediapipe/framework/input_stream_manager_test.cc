@@ -258,6 +258,7 @@ TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
       MakePacket<std::string>(expected_value_at_30).At(Timestamp(30)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
   EXPECT_TRUE(input_stream_manager_->QueueHead().IsEmpty());
+  EXPECT_EQ(Timestamp::Unset(), input_stream_manager_->QueueHeadTimestamp());
 
   MP_ASSERT_OK(
       input_stream_manager_->AddPackets(packets, &notify_));  // Notification
@@ -266,6 +267,7 @@ TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
   EXPECT_EQ(expected_value_at_10,
             input_stream_manager_->QueueHead().Get<std::string>());
   EXPECT_EQ(Timestamp(10), input_stream_manager_->QueueHead().Timestamp());
+  EXPECT_EQ(Timestamp(10), input_stream_manager_->QueueHeadTimestamp());
 
   popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
       Timestamp(5), &num_packets_dropped_, &stream_is_done_);
@@ -781,6 +783,115 @@ TEST_F(InputStreamManagerTest, QueueSizeTest) {
   expected_queue_becomes_not_full_count_ = 1;
 }
 
+TEST_F(InputStreamManagerTest, QueueBytesTest) {
+  const int64 packet_bytes = sizeof(std::string);
+  input_stream_manager_->SetMaxQueueBytes(2 * packet_bytes);
+  EXPECT_EQ(2 * packet_bytes, input_stream_manager_->MaxQueueBytes());
+
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_EQ(packet_bytes, input_stream_manager_->QueueBytes());
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_EQ(3 * packet_bytes, input_stream_manager_->QueueBytes());
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(20), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ("packet 2", popped_packet_.Get<std::string>());
+  EXPECT_EQ(packet_bytes, input_stream_manager_->QueueBytes());
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(30), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ(0, input_stream_manager_->QueueBytes());
+  EXPECT_EQ(3 * packet_bytes, input_stream_manager_->PeakQueueBytes());
+
+  // Lowering the limit below the queued bytes makes the queue full.
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet 4").At(Timestamp(40)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  input_stream_manager_->SetMaxQueueBytes(packet_bytes);
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+  input_stream_manager_->SetMaxQueueBytes(-1);
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+
+  input_stream_manager_->PrepareForRun();
+  EXPECT_EQ(0, input_stream_manager_->QueueBytes());
+  EXPECT_EQ(0, input_stream_manager_->PeakQueueBytes());
+
+  expected_queue_becomes_full_count_ = 2;
+  expected_queue_becomes_not_full_count_ = 2;
+}
+
+TEST_F(InputStreamManagerTest, LockFreeQueue) {
+  input_stream_manager_->EnableLockFreeQueue();
+  input_stream_manager_->SetMaxQueueSize(2);
+  input_stream_manager_->PrepareForRun();
+  EXPECT_TRUE(input_stream_manager_->IsLockFree());
+
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
+  MP_ASSERT_OK(
+      input_stream_manager_->AddPackets(packets, &notify_));  // Notification
+  EXPECT_TRUE(notify_);
+  EXPECT_EQ(3, input_stream_manager_->QueueSize());
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+  EXPECT_EQ(Timestamp(10), input_stream_manager_->QueueHead().Timestamp());
+  EXPECT_EQ(Timestamp(10), input_stream_manager_->QueueHeadTimestamp());
+
+  bool is_empty;
+  EXPECT_EQ(Timestamp(10),
+            input_stream_manager_->MinTimestampOrBound(&is_empty));
+  EXPECT_FALSE(is_empty);
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(20), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ("packet 2", popped_packet_.Get<std::string>());
+  EXPECT_EQ(1, num_packets_dropped_);
+  EXPECT_FALSE(stream_is_done_);
+  EXPECT_EQ(Timestamp(30), input_stream_manager_->QueueHeadTimestamp());
+
+  // Packets must still arrive in increasing timestamp order.
+  packets.clear();
+  packets.push_back(MakePacket<std::string>("packet 0").At(Timestamp(5)));
+  EXPECT_FALSE(input_stream_manager_->AddPackets(packets, &notify_).ok());
+
+  notify_ = false;
+  MP_ASSERT_OK(
+      input_stream_manager_->SetNextTimestampBound(Timestamp(40), &notify_));
+  EXPECT_FALSE(notify_);  // Packet 3 is still queued.
+  EXPECT_EQ(Timestamp(30),
+            input_stream_manager_->MinTimestampOrBound(&is_empty));
+
+  num_packets_dropped_ = 0;
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(30), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ("packet 3", popped_packet_.Get<std::string>());
+  EXPECT_EQ(0, num_packets_dropped_);
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(Timestamp::Unset(), input_stream_manager_->QueueHeadTimestamp());
+  EXPECT_EQ(Timestamp(40),
+            input_stream_manager_->MinTimestampOrBound(&is_empty));
+  EXPECT_TRUE(is_empty);
+
+  input_stream_manager_->Close();
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(50), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_TRUE(popped_packet_.IsEmpty());
+  EXPECT_TRUE(stream_is_done_);
+
+  expected_queue_becomes_full_count_ = 1;
+  expected_queue_becomes_not_full_count_ = 1;
+}
+
 TEST_F(InputStreamManagerTest, InputReleaseTest) {
   packet_type_.Set<LifetimeTracker::Object>();
   input_stream_manager_ = absl::make_unique<InputStreamManager>();
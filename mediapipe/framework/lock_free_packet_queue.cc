@@ -0,0 +1,111 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/lock_free_packet_queue.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+LockFreePacketQueue::LockFreePacketQueue(int segment_capacity)
+    : capacity_(segment_capacity) {
+  CHECK_GT(capacity_, 0);
+  head_ = tail_ = new Segment(capacity_);
+}
+
+LockFreePacketQueue::~LockFreePacketQueue() { DeleteSegments(); }
+
+void LockFreePacketQueue::Reset(int segment_capacity) {
+  CHECK_GT(segment_capacity, 0);
+  DeleteSegments();
+  capacity_ = segment_capacity;
+  head_ = tail_ = new Segment(capacity_);
+  head_index_ = 0;
+}
+
+void LockFreePacketQueue::DeleteSegments() {
+  Segment* segment = head_;
+  while (segment) {
+    Segment* next = segment->next.load(std::memory_order_relaxed);
+    delete segment;
+    segment = next;
+  }
+  delete spare_.exchange(nullptr, std::memory_order_relaxed);
+  head_ = tail_ = nullptr;
+}
+
+LockFreePacketQueue::Segment* LockFreePacketQueue::AcquireSegment() {
+  Segment* segment = spare_.exchange(nullptr, std::memory_order_acquire);
+  if (segment == nullptr) {
+    segment = new Segment(capacity_);
+  }
+  return segment;
+}
+
+void LockFreePacketQueue::ReleaseSegment(Segment* segment) {
+  segment->published.store(0, std::memory_order_relaxed);
+  segment->next.store(nullptr, std::memory_order_relaxed);
+  // If a spare segment is already waiting, the producer has not needed it
+  // yet and one is enough.
+  delete spare_.exchange(segment, std::memory_order_acq_rel);
+}
+
+void LockFreePacketQueue::Push(Packet packet) {
+  int index = tail_->published.load(std::memory_order_relaxed);
+  if (index == capacity_) {
+    Segment* segment = AcquireSegment();
+    tail_->next.store(segment, std::memory_order_release);
+    tail_ = segment;
+    index = 0;
+  }
+  tail_->packets[index] = std::move(packet);
+  tail_->published.store(index + 1, std::memory_order_release);
+}
+
+bool LockFreePacketQueue::Empty() {
+  while (true) {
+    if (head_index_ < head_->published.load(std::memory_order_acquire)) {
+      return false;
+    }
+    if (head_index_ < capacity_) {
+      return true;
+    }
+    // The head segment is drained. Move on once the producer has linked the
+    // next one; it no longer touches the drained segment after that.
+    Segment* next = head_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return true;
+    }
+    ReleaseSegment(head_);
+    head_ = next;
+    head_index_ = 0;
+  }
+}
+
+const Packet& LockFreePacketQueue::Front() {
+  CHECK(!Empty());
+  return head_->packets[head_index_];
+}
+
+Packet LockFreePacketQueue::Pop() {
+  CHECK(!Empty());
+  // Moving the packet out releases the slot's reference to the payload.
+  Packet packet = std::move(head_->packets[head_index_]);
+  ++head_index_;
+  return packet;
+}
+
+}  // namespace mediapipe
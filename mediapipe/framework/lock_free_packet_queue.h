@@ -0,0 +1,95 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_LOCK_FREE_PACKET_QUEUE_H_
+#define MEDIAPIPE_FRAMEWORK_LOCK_FREE_PACKET_QUEUE_H_
+
+#include <atomic>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+
+namespace mediapipe {
+
+// A single-producer single-consumer FIFO queue of packets that does not use
+// locks. Push() may be called by one thread while Empty(), Front() and Pop()
+// are called by another thread. Each side must be externally serialized.
+//
+// Packets are stored in fixed-size ring segments. When the producer fills a
+// segment it links a new one; when the consumer drains a segment it hands it
+// back to the producer for reuse. A queue whose size stays within one
+// segment therefore cycles through at most two segments and does not
+// allocate in steady state. The queue is not bounded; callers that want a
+// bound should size segments to it and throttle the producer.
+class LockFreePacketQueue {
+ public:
+  static constexpr int kDefaultSegmentCapacity = 64;
+
+  explicit LockFreePacketQueue(int segment_capacity = kDefaultSegmentCapacity);
+  ~LockFreePacketQueue();
+
+  LockFreePacketQueue(const LockFreePacketQueue&) = delete;
+  LockFreePacketQueue& operator=(const LockFreePacketQueue&) = delete;
+
+  // Removes all packets and sets the segment capacity. Must not be called
+  // concurrently with any other method.
+  void Reset(int segment_capacity);
+
+  // Producer side. Appends a packet to the back of the queue.
+  void Push(Packet packet);
+
+  // Consumer side. Returns true if no packet is available.
+  bool Empty();
+
+  // Consumer side. Returns the packet at the front of the queue. The queue
+  // must not be empty.
+  const Packet& Front();
+
+  // Consumer side. Removes and returns the packet at the front of the queue.
+  // The queue must not be empty.
+  Packet Pop();
+
+ private:
+  struct Segment {
+    explicit Segment(int capacity) : packets(capacity) {}
+    std::vector<Packet> packets;
+    // Number of packets written to this segment. Written by the producer.
+    std::atomic<int> published{0};
+    // The next segment, set by the producer when this segment is full.
+    std::atomic<Segment*> next{nullptr};
+  };
+
+  // Producer side. Returns an empty segment, reusing spare_ if possible.
+  Segment* AcquireSegment();
+  // Consumer side. Offers a drained segment to the producer for reuse.
+  void ReleaseSegment(Segment* segment);
+  // Deletes all segments.
+  void DeleteSegments();
+
+  int capacity_;
+
+  // Owned by the consumer.
+  Segment* head_;
+  int head_index_ = 0;
+
+  // Owned by the producer.
+  Segment* tail_;
+
+  // A drained segment waiting to be reused by the producer.
+  std::atomic<Segment*> spare_{nullptr};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_LOCK_FREE_PACKET_QUEUE_H_
@@ -0,0 +1,104 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/lock_free_packet_queue.h"
+
+#include <thread>  // NOLINT(build/c++11)
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(LockFreePacketQueueTest, FifoOrder) {
+  LockFreePacketQueue queue(/*segment_capacity=*/4);
+  EXPECT_TRUE(queue.Empty());
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(MakePacket<int>(i).At(Timestamp(i)));
+  }
+  EXPECT_FALSE(queue.Empty());
+  EXPECT_EQ(0, queue.Front().Get<int>());
+  for (int i = 0; i < 3; ++i) {
+    Packet packet = queue.Pop();
+    EXPECT_EQ(i, packet.Get<int>());
+    EXPECT_EQ(Timestamp(i), packet.Timestamp());
+  }
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(LockFreePacketQueueTest, CrossesAndReusesSegments) {
+  LockFreePacketQueue queue(/*segment_capacity=*/2);
+  int next_push = 0;
+  int next_pop = 0;
+  // Interleaves pushes and pops so that drained segments are recycled.
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      queue.Push(MakePacket<int>(next_push++));
+    }
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_FALSE(queue.Empty());
+      EXPECT_EQ(next_pop++, queue.Pop().Get<int>());
+    }
+  }
+  while (!queue.Empty()) {
+    EXPECT_EQ(next_pop++, queue.Pop().Get<int>());
+  }
+  EXPECT_EQ(next_push, next_pop);
+}
+
+TEST(LockFreePacketQueueTest, PopReleasesPayload) {
+  LockFreePacketQueue queue;
+  Packet packet = MakePacket<int>(7);
+  queue.Push(packet);
+  EXPECT_EQ(2, packet_internal::GetHolderShared(packet).use_count());
+  queue.Pop();
+  // The drained slot no longer holds a reference to the payload.
+  EXPECT_EQ(1, packet_internal::GetHolderShared(packet).use_count());
+}
+
+TEST(LockFreePacketQueueTest, Reset) {
+  LockFreePacketQueue queue(/*segment_capacity=*/2);
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(MakePacket<int>(i));
+  }
+  queue.Reset(/*segment_capacity=*/8);
+  EXPECT_TRUE(queue.Empty());
+  queue.Push(MakePacket<int>(42));
+  EXPECT_EQ(42, queue.Pop().Get<int>());
+}
+
+TEST(LockFreePacketQueueTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumPackets = 100000;
+  LockFreePacketQueue queue(/*segment_capacity=*/16);
+  std::thread producer([&queue] {
+    for (int i = 0; i < kNumPackets; ++i) {
+      queue.Push(MakePacket<int>(i));
+    }
+  });
+  int expected = 0;
+  while (expected < kNumPackets) {
+    if (queue.Empty()) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(expected, queue.Pop().Get<int>());
+    ++expected;
+  }
+  producer.join();
+  EXPECT_TRUE(queue.Empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -84,12 +84,29 @@ void OutputStreamManager::AddMirror(InputStreamHandler* input_stream_handler,
   mirrors_.emplace_back(input_stream_handler, id);
 }
 
+void OutputStreamManager::RemoveMirror(
+    InputStreamHandler* input_stream_handler) {
+  std::vector<Mirror> mirrors;
+  for (const auto& mirror : mirrors_) {
+    if (mirror.input_stream_handler != input_stream_handler) {
+      mirrors.push_back(mirror);
+    }
+  }
+  mirrors_.swap(mirrors);
+}
+
 void OutputStreamManager::SetMaxQueueSize(int max_queue_size) {
   for (auto& mirror : mirrors_) {
     mirror.input_stream_handler->SetMaxQueueSize(mirror.id, max_queue_size);
   }
 }
 
+void OutputStreamManager::SetMaxQueueBytes(int64 max_queue_bytes) {
+  for (auto& mirror : mirrors_) {
+    mirror.input_stream_handler->SetMaxQueueBytes(mirror.id, max_queue_bytes);
+  }
+}
+
 Timestamp OutputStreamManager::NextTimestampBound() const {
   absl::MutexLock lock(&stream_mutex_);
   return next_timestamp_bound_;
@@ -24,6 +24,7 @@
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
 
@@ -77,9 +78,16 @@ class OutputStreamManager {
   // The caller retains the ownership of the InputStreamHandler.
   void AddMirror(InputStreamHandler* input_stream_handler, CollectionItemId id);
 
+  // Removes the mirrors of |input_stream_handler| added by AddMirror().
+  // Must not be called during a graph run.
+  void RemoveMirror(InputStreamHandler* input_stream_handler);
+
   // Sets the maximum queue size on all mirrors.
   void SetMaxQueueSize(int max_queue_size);
 
+  // Sets the maximum queue bytes on all mirrors.
+  void SetMaxQueueBytes(int64 max_queue_bytes);
+
   // Returns the next timetstamp bound of the output stream.
   Timestamp NextTimestampBound() const;
 
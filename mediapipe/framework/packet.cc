@@ -24,6 +24,91 @@
 
 namespace mediapipe {
 namespace packet_internal {
+namespace {
+
+// Holder blocks are pooled in size classes of kBlockSizeStep bytes, up to
+// kMaxPooledBlockSize. This covers an InlineHolder of kMaxInlinePayloadSize
+// together with its shared_ptr control block.
+constexpr size_t kBlockSizeStep = 32;
+constexpr size_t kMaxPooledBlockSize = 192;
+constexpr int kNumSizeClasses = kMaxPooledBlockSize / kBlockSizeStep;
+// Bounds the memory kept by a thread that frees more blocks than it
+// allocates, e.g. the consumer end of a stream.
+constexpr int kMaxCachedBlocksPerClass = 256;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// Free lists of the calling thread.
+class HolderBlockCache {
+ public:
+  HolderBlockCache() = default;
+  ~HolderBlockCache();
+
+  FreeBlock* free_lists[kNumSizeClasses] = {};
+  int num_free[kNumSizeClasses] = {};
+};
+
+// Set once the cache of this thread is destroyed at thread exit. Blocks
+// released after that go straight back to the heap.
+thread_local bool holder_block_cache_destroyed = false;
+
+HolderBlockCache::~HolderBlockCache() {
+  for (FreeBlock* block : free_lists) {
+    while (block) {
+      FreeBlock* next = block->next;
+      ::operator delete(block);
+      block = next;
+    }
+  }
+  holder_block_cache_destroyed = true;
+}
+
+HolderBlockCache* GetHolderBlockCache() {
+  if (holder_block_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local HolderBlockCache cache;
+  return &cache;
+}
+
+}  // namespace
+
+void* AllocateHolderBlock(size_t size) {
+  if (size > kMaxPooledBlockSize) {
+    return ::operator new(size);
+  }
+  const int size_class = (size - 1) / kBlockSizeStep;
+  HolderBlockCache* cache = GetHolderBlockCache();
+  if (cache && cache->free_lists[size_class]) {
+    FreeBlock* block = cache->free_lists[size_class];
+    cache->free_lists[size_class] = block->next;
+    --cache->num_free[size_class];
+    return block;
+  }
+  // Always allocate the full size class, since the block may be recycled
+  // for another holder of the same class.
+  return ::operator new((size_class + 1) * kBlockSizeStep);
+}
+
+void DeallocateHolderBlock(void* block, size_t size) {
+  if (size > kMaxPooledBlockSize) {
+    ::operator delete(block);
+    return;
+  }
+  const int size_class = (size - 1) / kBlockSizeStep;
+  HolderBlockCache* cache = GetHolderBlockCache();
+  if (cache == nullptr ||
+      cache->num_free[size_class] >= kMaxCachedBlocksPerClass) {
+    ::operator delete(block);
+    return;
+  }
+  FreeBlock* free_block = static_cast<FreeBlock*>(block);
+  free_block->next = cache->free_lists[size_class];
+  cache->free_lists[size_class] = free_block;
+  ++cache->num_free[size_class];
+}
 
 HolderBase::~HolderBase() {}
 
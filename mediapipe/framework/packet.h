@@ -54,6 +54,8 @@ Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp);
 const HolderBase* GetHolder(const Packet& packet);
 const std::shared_ptr<HolderBase>& GetHolderShared(const Packet& packet);
 std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet);
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeHolder(Args&&... args);
 absl::StatusOr<Packet> PacketFromDynamicProto(const std::string& type_name,
                                               const std::string& serialized);
 }  // namespace packet_internal
@@ -189,6 +191,10 @@ class Packet {
   // Crashes if IsEmpty() == true.
   size_t GetTypeId() const;
 
+  // Returns an estimate of the memory held by the payload in bytes, or 0 if
+  // the packet is empty. See MediaPipePacketSizeHint below.
+  size_t GetSizeHint() const;
+
   // Returns the timestamp.
   class Timestamp Timestamp() const;
 
@@ -299,12 +305,17 @@ Packet AdoptAsSyncedPacket(const T* ptr) {
 // provided arguments. Similar to MakeUnique. Especially convenient for arrays,
 // since it ensures the packet gets the right type (see below).
 //
-// Version for scalars.
+// Version for scalars. Small payloads, such as numbers, flags, Timestamps
+// and small protos, are stored inline in a pooled holder that also carries
+// the reference count, so creating such a Packet costs no heap allocation
+// in steady state.
 template <typename T,
           typename std::enable_if<!std::is_array<T>::value>::type* = nullptr,
           typename... Args>
 Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
-  return Adopt(new T(std::forward<Args>(args)...));
+  return packet_internal::Create(
+      packet_internal::MakeHolder<T>(std::forward<Args>(args)...),
+      Timestamp::Unset());
 }
 
 // Version for arrays. We have to use reinterpret_cast because new T[N]
@@ -344,6 +355,19 @@ std::shared_ptr<const T> SharedPtrWithPacket(Packet packet) {
       ptr, [packet = std::move(packet)](const T* ptr) mutable { packet = {}; });
 }
 
+// Byte-based queue limits (see max_queue_bytes in CalculatorGraphConfig)
+// need to know how much memory a packet holds. By default a payload of type T
+// is assumed to occupy sizeof(T) bytes. Types that own memory outside of the
+// object itself, such as images, can report their actual footprint by
+// declaring the following function in the namespace of the type, where it is
+// found by argument-dependent lookup:
+//
+//   size_t MediaPipePacketSizeHint(const MyType& value);
+//
+// The hint is evaluated whenever a packet enters or leaves an input stream
+// queue, so it must be cheap and must return the same value for the lifetime
+// of the payload.
+
 //// Implementation details.
 namespace packet_internal {
 
@@ -351,6 +375,19 @@ template <typename T>
 class Holder;
 template <typename T>
 class ForeignHolder;
+template <typename T>
+class InlineHolder;
+
+// Payloads up to this size are stored inline by MakePacket.
+constexpr size_t kMaxInlinePayloadSize = 64;
+
+template <typename T>
+struct IsInlinePayload
+    : public std::integral_constant<
+          bool, !std::is_array<T>::value &&
+                    sizeof(T) <= kMaxInlinePayloadSize &&
+                    alignof(T) <= alignof(std::max_align_t) &&
+                    std::is_move_constructible<T>::value> {};
 
 class HolderBase {
  public:
@@ -367,6 +404,14 @@ class HolderBase {
   bool HolderIsOfType() const {
     return type_id_ == tool::GetTypeHash<T>();
   }
+  // Returns true if this is an InlineHolder<T>.
+  template <typename T>
+  bool HoldsInline() const {
+    if constexpr (IsInlinePayload<T>::value) {
+      return HolderIsOfType<InlineHolder<T>>();
+    }
+    return false;
+  }
   // Returns a printable std::string identifying the type stored in the holder.
   virtual const std::string DebugTypeName() const = 0;
   // Returns the registered type name if it's available, otherwise the
@@ -374,6 +419,8 @@ class HolderBase {
   virtual const std::string RegisteredTypeName() const = 0;
   // Get the type id of the underlying data type.
   virtual size_t GetTypeId() const = 0;
+  // Returns the estimated size of the payload in bytes.
+  virtual size_t GetSizeHint() const = 0;
   // Downcasts this to Holder<T>.  Returns nullptr if deserialization
   // failed or if the requested type is not what is stored.
   template <typename T>
@@ -496,6 +543,27 @@ struct HolderSupport<T,
   static void EnsureStaticInit() { CHECK(R::registration.get() != nullptr); }
 };
 
+template <typename T, typename = void>
+struct HasPacketSizeHint : std::false_type {};
+
+template <typename T>
+struct HasPacketSizeHint<
+    T, std::void_t<decltype(MediaPipePacketSizeHint(std::declval<const T&>()))>>
+    : std::true_type {};
+
+// Returns the size hint for the payload, see MediaPipePacketSizeHint.
+template <typename T>
+size_t PacketSizeHint(const T& data) {
+  if constexpr (HasPacketSizeHint<T>::value) {
+    return MediaPipePacketSizeHint(data);
+  } else if constexpr (std::is_array<T>::value && std::extent<T>::value == 0) {
+    // The length of an unbounded array is not known.
+    return 0;
+  } else {
+    return sizeof(T);
+  }
+}
+
 template <typename T>
 class Holder : public HolderBase {
  public:
@@ -509,6 +577,9 @@ class Holder : public HolderBase {
     return *ptr_;
   }
   size_t GetTypeId() const final { return tool::GetTypeHash<T>(); }
+  size_t GetSizeHint() const final {
+    return ptr_ ? PacketSizeHint(*ptr_) : 0;
+  }
   // Releases the underlying data pointer and transfers the ownership to a
   // unique pointer.
   // This method is dangerous and is only used by Packet::Consume() if the
@@ -517,6 +588,13 @@ class Holder : public HolderBase {
   absl::StatusOr<std::unique_ptr<T>> Release(
       typename std::enable_if<!std::is_array<U>::value ||
                               std::extent<U>::value != 0>::type* = 0) {
+    // Inline data shares its allocation with the holder, so it is moved
+    // into a new object instead. The caller is the sole owner of the holder.
+    if constexpr (IsInlinePayload<T>::value) {
+      if (HolderIsOfType<InlineHolder<T>>()) {
+        return absl::make_unique<T>(std::move(*const_cast<T*>(ptr_)));
+      }
+    }
     // Since C++ doesn't allow virtual, templated functions, check holder
     // type here to make sure it's not upcasted from a ForeignHolder.
     if (!HolderIsOfType<Holder<T>>()) {
@@ -584,6 +662,26 @@ class Holder : public HolderBase {
   }
 };
 
+// Like Holder, but stores its data inline instead of pointing to a separately
+// allocated object. Used by MakePacket for small payloads, see
+// IsInlinePayload.
+template <typename T>
+class InlineHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit InlineHolder(Args&&... args)
+      : Holder<T>(&value_), value_(std::forward<Args>(args)...) {
+    this->template SetHolderTypeId<InlineHolder>();
+  }
+  ~InlineHolder() override {
+    // Null out ptr_ so it doesn't get deleted by ~Holder.
+    this->ptr_ = nullptr;
+  }
+
+ private:
+  T value_;
+};
+
 // Like Holder, but does not own its data.
 template <typename T>
 class ForeignHolder : public Holder<T> {
@@ -606,7 +704,8 @@ class ForeignHolder : public Holder<T> {
 
 template <typename T>
 Holder<T>* HolderBase::As() {
-  if (HolderIsOfType<Holder<T>>() || HolderIsOfType<ForeignHolder<T>>()) {
+  if (HolderIsOfType<Holder<T>>() || HoldsInline<T>() ||
+      HolderIsOfType<ForeignHolder<T>>()) {
     return static_cast<Holder<T>*>(this);
   }
   // Does not hold a T.
@@ -615,13 +714,56 @@ Holder<T>* HolderBase::As() {
 
 template <typename T>
 const Holder<T>* HolderBase::As() const {
-  if (HolderIsOfType<Holder<T>>() || HolderIsOfType<ForeignHolder<T>>()) {
+  if (HolderIsOfType<Holder<T>>() || HoldsInline<T>() ||
+      HolderIsOfType<ForeignHolder<T>>()) {
     return static_cast<const Holder<T>*>(this);
   }
   // Does not hold a T.
   return nullptr;
 }
 
+// Allocates and frees the memory blocks of inline holders. Small blocks are
+// recycled through per-thread free lists.
+void* AllocateHolderBlock(size_t size);
+void DeallocateHolderBlock(void* block, size_t size);
+
+// A std allocator that uses AllocateHolderBlock. With std::allocate_shared,
+// the holder and its reference counts share a single pooled block.
+template <typename T>
+class HolderBlockAllocator {
+ public:
+  using value_type = T;
+
+  HolderBlockAllocator() = default;
+  template <typename U>
+  HolderBlockAllocator(const HolderBlockAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(AllocateHolderBlock(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) { DeallocateHolderBlock(p, n * sizeof(T)); }
+
+  template <typename U>
+  bool operator==(const HolderBlockAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const HolderBlockAllocator<U>&) const {
+    return false;
+  }
+};
+
+// Returns a holder owning a new T constructed from |args|.
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeHolder(Args&&... args) {
+  if constexpr (IsInlinePayload<T>::value) {
+    return std::allocate_shared<InlineHolder<T>>(
+        HolderBlockAllocator<InlineHolder<T>>(), std::forward<Args>(args)...);
+  } else {
+    return std::make_shared<Holder<T>>(new T(std::forward<Args>(args)...));
+  }
+}
+
 }  // namespace packet_internal
 
 inline Packet::Packet(const Packet& packet)
@@ -759,6 +901,10 @@ inline size_t Packet::GetTypeId() const {
   return holder_->GetTypeId();
 }
 
+inline size_t Packet::GetSizeHint() const {
+  return holder_ ? holder_->GetSizeHint() : 0;
+}
+
 template <typename T>
 inline const T& Packet::Get() const {
   packet_internal::Holder<T>* holder = IsEmpty() ? nullptr : holder_->As<T>();
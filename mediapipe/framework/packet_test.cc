@@ -17,11 +17,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -502,5 +504,130 @@ TEST(PacketTest, SharedPtrWithPacketOwnership) {
   EXPECT_EQ(exist, false);
 }
 
+// Holds a large payload that MakePacket does not store inline.
+struct LargePayload {
+  char bytes[packet_internal::kMaxInlinePayloadSize + 1];
+};
+
+// Counts live instances, and can be moved.
+class MovableCounter {
+ public:
+  explicit MovableCounter(int* live) : live_(live) { ++*live_; }
+  MovableCounter(MovableCounter&& other) : live_(other.live_) { ++*live_; }
+  ~MovableCounter() { --*live_; }
+
+ private:
+  int* live_;
+};
+
+template <typename T>
+bool HoldsInline(const Packet& packet) {
+  return packet_internal::GetHolder(packet)->HoldsInline<T>();
+}
+
+TEST(PacketTest, SmallPayloadsAreStoredInline) {
+  EXPECT_TRUE(HoldsInline<int>(MakePacket<int>(1)));
+  EXPECT_TRUE(HoldsInline<float>(MakePacket<float>(1.0f)));
+  EXPECT_TRUE(HoldsInline<Timestamp>(MakePacket<Timestamp>(Timestamp(5))));
+  EXPECT_FALSE(HoldsInline<LargePayload>(MakePacket<LargePayload>()));
+  EXPECT_FALSE(HoldsInline<int[3]>(MakePacket<int[3]>(1, 2, 3)));
+  EXPECT_FALSE(HoldsInline<int>(Adopt(new int(1))));
+
+  Packet packet = MakePacket<int>(17).At(Timestamp(3));
+  const int* data = &packet.Get<int>();
+  Packet copy = packet;
+  EXPECT_EQ(data, &copy.Get<int>());
+  EXPECT_EQ(17, copy.Get<int>());
+  EXPECT_EQ(2, packet_internal::GetHolderShared(packet).use_count());
+  MP_EXPECT_OK(copy.ValidateAsType<int>());
+  EXPECT_FALSE(copy.ValidateAsType<float>().ok());
+}
+
+TEST(PacketTest, InlinePayloadIsDestroyedWithLastPacket) {
+  int live = 0;
+  {
+    Packet packet = MakePacket<MovableCounter>(&live);
+    ASSERT_TRUE(HoldsInline<MovableCounter>(packet));
+    Packet copy = packet;
+    EXPECT_EQ(1, live);
+    packet = Packet();
+    EXPECT_EQ(1, live);
+  }
+  EXPECT_EQ(0, live);
+}
+
+TEST(PacketTest, ConsumeInlinePayload) {
+  Packet packet = MakePacket<std::string>("inline");
+  ASSERT_TRUE(HoldsInline<std::string>(packet));
+  Packet copy = packet;
+  EXPECT_FALSE(copy.Consume<std::string>().ok());
+  copy = Packet();
+
+  bool was_copied = true;
+  absl::StatusOr<std::unique_ptr<std::string>> result =
+      packet.ConsumeOrCopy<std::string>(&was_copied);
+  MP_ASSERT_OK(result);
+  EXPECT_FALSE(was_copied);
+  EXPECT_EQ("inline", *result.value());
+  EXPECT_TRUE(packet.IsEmpty());
+}
+
+TEST(PacketTest, InlinePacketsReleasedOnOtherThreads) {
+  constexpr int kNumPackets = 10000;
+  std::vector<Packet> packets;
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kNumPackets; ++i) {
+      packets.push_back(MakePacket<int64>(i).At(Timestamp(i)));
+    }
+    // Blocks freed by another thread are cached or returned to the heap
+    // there.
+    std::thread consumer([&packets] {
+      int64 sum = 0;
+      for (const Packet& packet : packets) {
+        sum += packet.Get<int64>();
+      }
+      EXPECT_EQ(int64{kNumPackets} * (kNumPackets - 1) / 2, sum);
+      packets.clear();
+    });
+    consumer.join();
+  }
+}
+
+// A payload that owns memory outside of the object itself.
+struct SizedBuffer {
+  std::vector<char> data;
+};
+
+size_t MediaPipePacketSizeHint(const SizedBuffer& buffer) {
+  return sizeof(buffer) + buffer.data.size();
+}
+
+TEST(PacketTest, SizeHint) {
+  EXPECT_EQ(0, Packet().GetSizeHint());
+  EXPECT_EQ(sizeof(int), MakePacket<int>(5).GetSizeHint());
+  EXPECT_EQ(3 * sizeof(int), (MakePacket<int[3]>(1, 2, 3).GetSizeHint()));
+  EXPECT_EQ(sizeof(SizedBuffer) + 1000,
+            MakePacket<SizedBuffer>(SizedBuffer{std::vector<char>(1000)})
+                .GetSizeHint());
+  EXPECT_EQ(sizeof(SizedBuffer) + 10,
+            Adopt(new SizedBuffer{std::vector<char>(10)}).GetSizeHint());
+}
+
+void BM_MakePacketInline(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet packet = MakePacket<float>(1.0f).At(Timestamp(1));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_MakePacketInline);
+
+void BM_AdoptPacket(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet packet = Adopt(new float(1.0f)).At(Timestamp(1));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_AdoptPacket);
+
 }  // namespace
 }  // namespace mediapipe
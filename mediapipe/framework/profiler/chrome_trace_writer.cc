@@ -0,0 +1,170 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+
+namespace {
+
+// All events belong to one process.
+constexpr int kProcessId = 1;
+
+// Returns |text| as a quoted JSON string.
+std::string JsonString(absl::string_view text) {
+  std::string result = "\"";
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&result, "\\u%04x", c);
+        } else {
+          result += c;
+        }
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+std::string NodeName(const GraphTrace& trace, int node_id) {
+  return (node_id >= 0 && node_id < trace.calculator_name_size())
+             ? trace.calculator_name(node_id)
+             : absl::StrCat("node_", node_id);
+}
+
+std::string StreamName(const GraphTrace& trace, int stream_id) {
+  return (stream_id >= 0 && stream_id < trace.stream_name_size())
+             ? trace.stream_name(stream_id)
+             : absl::StrCat("stream_", stream_id);
+}
+
+}  // namespace
+
+std::string ChromeTraceWriter::BeginFile() {
+  outputs_.clear();
+  previous_outputs_.clear();
+  threads_.clear();
+  return absl::StrCat("[\n", R"({"name":"process_name","ph":"M","pid":)",
+                      kProcessId, R"(,"args":{"name":"MediaPipe"}},)", "\n");
+}
+
+void ChromeTraceWriter::AppendTrace(const GraphTrace& trace,
+                                    std::string* output) {
+  previous_outputs_.swap(outputs_);
+  outputs_.clear();
+  const int64 base_time = trace.base_time();
+  for (const GraphTrace::CalculatorTrace& call : trace.calculator_trace()) {
+    const int32 thread_id = call.thread_id();
+    AppendThread(thread_id, output);
+
+    // Input queue sizes are shown as one counter track per node, with one
+    // series per input stream.
+    if (call.event_type() == GraphTrace::PACKET_QUEUED) {
+      const std::string counter_name = JsonString(
+          absl::StrCat(NodeName(trace, call.node_id()), " input queues"));
+      for (const GraphTrace::StreamTrace& queued : call.input_trace()) {
+        absl::StrAppend(
+            output, R"({"name":)", counter_name, R"(,"ph":"C","ts":)",
+            base_time + queued.finish_time(), R"(,"pid":)", kProcessId,
+            R"(,"args":{)", JsonString(StreamName(trace, queued.stream_id())),
+            ":", queued.event_data(), "}},\n");
+      }
+      continue;
+    }
+
+    const std::string name = JsonString(NodeName(trace, call.node_id()));
+    const std::string category =
+        JsonString(GraphTrace::EventType_Name(call.event_type()));
+    if (!call.has_start_time() || !call.has_finish_time()) {
+      const int64 time = base_time + (call.has_start_time()
+                                          ? call.start_time()
+                                          : call.finish_time());
+      absl::StrAppend(output, R"({"name":)", name, R"(,"cat":)", category,
+                      R"(,"ph":"i","s":"t","ts":)", time, R"(,"pid":)",
+                      kProcessId, R"(,"tid":)", thread_id, "},\n");
+      continue;
+    }
+
+    const int64 start_time = base_time + call.start_time();
+    const int64 finish_time = base_time + call.finish_time();
+    absl::StrAppend(output, R"({"name":)", name, R"(,"cat":)", category,
+                    R"(,"ph":"X","ts":)", start_time, R"(,"dur":)",
+                    finish_time - start_time, R"(,"pid":)", kProcessId,
+                    R"(,"tid":)", thread_id);
+    if (call.has_input_timestamp()) {
+      absl::StrAppend(output, R"(,"args":{"input_timestamp":)",
+                      trace.base_timestamp() + call.input_timestamp(), "}");
+    }
+    absl::StrAppend(output, "},\n");
+
+    // A flow arrow from the producer of each input packet to this call.
+    for (const GraphTrace::StreamTrace& input : call.input_trace()) {
+      const PacketOutput* producer =
+          FindOutput({input.stream_id(), input.packet_timestamp()});
+      if (producer == nullptr) {
+        continue;
+      }
+      const std::string stream_name =
+          JsonString(StreamName(trace, input.stream_id()));
+      const int64 flow_id = next_flow_id_++;
+      absl::StrAppend(output, R"({"name":)", stream_name,
+                      R"(,"cat":"packet","ph":"s","id":)", flow_id,
+                      R"(,"ts":)", producer->time, R"(,"pid":)", kProcessId,
+                      R"(,"tid":)", producer->thread_id, "},\n");
+      absl::StrAppend(output, R"({"name":)", stream_name,
+                      R"(,"cat":"packet","ph":"f","bp":"e","id":)", flow_id,
+                      R"(,"ts":)", start_time, R"(,"pid":)", kProcessId,
+                      R"(,"tid":)", thread_id, "},\n");
+    }
+    // Flow arrows start in the last microsecond of the producing call, so
+    // that they bind to it.
+    for (const GraphTrace::StreamTrace& out : call.output_trace()) {
+      outputs_[{out.stream_id(), out.packet_timestamp()}] = {
+          thread_id, std::max(start_time, finish_time - 1)};
+    }
+  }
+}
+
+const ChromeTraceWriter::PacketOutput* ChromeTraceWriter::FindOutput(
+    const PacketKey& key) const {
+  auto it = outputs_.find(key);
+  if (it != outputs_.end()) {
+    return &it->second;
+  }
+  it = previous_outputs_.find(key);
+  return it != previous_outputs_.end() ? &it->second : nullptr;
+}
+
+void ChromeTraceWriter::AppendThread(int32 thread_id, std::string* output) {
+  if (threads_.insert(thread_id).second) {
+    absl::StrAppend(output, R"({"name":"thread_name","ph":"M","pid":)",
+                    kProcessId, R"(,"tid":)", thread_id,
+                    R"(,"args":{"name":"Thread )", thread_id, "\"}},\n");
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,77 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Converts GraphTraces into Chrome trace-event JSON, in the "JSON Array
+// Format" read by chrome://tracing and ui.perfetto.dev.  The events of
+// successive GraphTraces are appended to the same file, so a trace can be
+// streamed while the graph runs; the array is left open, as the format
+// allows.
+//
+// Calculator calls become complete events on the track of their thread,
+// with flow arrows from the call that output a packet to each call that
+// received it.  PACKET_QUEUED events become counter tracks showing the input
+// queue sizes of each node.  Other events become instant events.
+//
+// ChromeTraceWriter is not thread-safe.  It runs on the trace log writer, so
+// it adds no work to the graph threads.
+class ChromeTraceWriter {
+ public:
+  // Returns the start of a new trace file.  Also forgets the threads and
+  // packets seen in the previous file.
+  std::string BeginFile();
+
+  // Appends the events of |trace| to |output|.  Flow arrows connect packets
+  // output in this or the previous trace.
+  void AppendTrace(const GraphTrace& trace, std::string* output);
+
+ private:
+  // The thread and time at which a packet was output.
+  struct PacketOutput {
+    int32 thread_id;
+    int64 time;
+  };
+  // Identifies a packet by stream id and packet timestamp.
+  using PacketKey = std::pair<int32, int64>;
+
+  // Returns the producer of a packet, if it was seen recently.
+  const PacketOutput* FindOutput(const PacketKey& key) const;
+
+  // Appends thread metadata the first time |thread_id| is seen.
+  void AppendThread(int32 thread_id, std::string* output);
+
+  // Packets output in the current and in the previous GraphTrace.
+  absl::flat_hash_map<PacketKey, PacketOutput> outputs_;
+  absl::flat_hash_map<PacketKey, PacketOutput> previous_outputs_;
+  // Threads already named in the current file.
+  absl::flat_hash_set<int32> threads_;
+  // The id of the next flow arrow.
+  int64 next_flow_id_ = 1;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
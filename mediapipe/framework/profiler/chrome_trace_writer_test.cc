@@ -0,0 +1,139 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+// A trace in which "source" outputs a packet on thread 1, which is queued for
+// and then processed by "sink" on thread 2.
+GraphTrace SourceSinkTrace() {
+  return ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_time: 1000000
+    base_timestamp: 5000
+    calculator_name: "source"
+    calculator_name: "sink"
+    stream_name: ""
+    stream_name: "numbers"
+    calculator_trace {
+      node_id: 0
+      input_timestamp: 100
+      event_type: PROCESS
+      start_time: 10
+      finish_time: 30
+      output_trace { packet_timestamp: 100 stream_id: 1 }
+      thread_id: 1
+    }
+    calculator_trace {
+      node_id: 1
+      input_timestamp: 100
+      event_type: PACKET_QUEUED
+      input_trace {
+        finish_time: 29
+        packet_timestamp: 100
+        stream_id: 1
+        event_data: 3
+      }
+      thread_id: 1
+    }
+    calculator_trace {
+      node_id: 1
+      input_timestamp: 100
+      event_type: PROCESS
+      start_time: 40
+      finish_time: 45
+      input_trace {
+        start_time: 29
+        finish_time: 40
+        packet_timestamp: 100
+        stream_id: 1
+      }
+      thread_id: 2
+    }
+  )pb");
+}
+
+TEST(ChromeTraceWriterTest, WritesCompleteEvents) {
+  ChromeTraceWriter writer;
+  std::string json = writer.BeginFile();
+  writer.AppendTrace(SourceSinkTrace(), &json);
+  EXPECT_TRUE(absl::StartsWith(json, "[\n"));
+  EXPECT_TRUE(absl::EndsWith(json, "},\n"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"source","cat":"PROCESS","ph":"X",)"
+                              R"("ts":1000010,"dur":20,"pid":1,"tid":1,)"
+                              R"("args":{"input_timestamp":5100}})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"sink","cat":"PROCESS","ph":"X",)"
+                              R"("ts":1000040,"dur":5,"pid":1,"tid":2,)"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"thread_name","ph":"M","pid":1,)"
+                              R"("tid":2,"args":{"name":"Thread 2"}})"));
+}
+
+TEST(ChromeTraceWriterTest, WritesFlowsAndQueueCounters) {
+  ChromeTraceWriter writer;
+  std::string json = writer.BeginFile();
+  writer.AppendTrace(SourceSinkTrace(), &json);
+  EXPECT_THAT(json, HasSubstr(R"({"name":"numbers","cat":"packet","ph":"s",)"
+                              R"("id":1,"ts":1000029,"pid":1,"tid":1})"));
+  EXPECT_THAT(json,
+              HasSubstr(R"({"name":"numbers","cat":"packet","ph":"f",)"
+                        R"("bp":"e","id":1,"ts":1000040,"pid":1,"tid":2})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"sink input queues","ph":"C",)"
+                              R"("ts":1000029,"pid":1,"args":{"numbers":3}})"));
+}
+
+TEST(ChromeTraceWriterTest, ConnectsPacketsAcrossTraces) {
+  GraphTrace producer = SourceSinkTrace();
+  producer.mutable_calculator_trace()->DeleteSubrange(1, 2);
+  GraphTrace consumer = SourceSinkTrace();
+  consumer.mutable_calculator_trace()->DeleteSubrange(0, 2);
+
+  ChromeTraceWriter writer;
+  std::string json = writer.BeginFile();
+  writer.AppendTrace(producer, &json);
+  json.clear();
+  writer.AppendTrace(consumer, &json);
+  EXPECT_THAT(json, HasSubstr(R"("ph":"f")"));
+  // A thread is named only once per file.
+  EXPECT_THAT(json, Not(HasSubstr(R"("tid":1,"args":{"name":"Thread 1"})")));
+
+  // A new file forgets earlier packets.
+  json = writer.BeginFile();
+  writer.AppendTrace(consumer, &json);
+  EXPECT_THAT(json, Not(HasSubstr(R"("ph":"f")")));
+  EXPECT_THAT(json, HasSubstr(R"("tid":2,"args":{"name":"Thread 2"})"));
+}
+
+TEST(ChromeTraceWriterTest, EscapesNames) {
+  GraphTrace trace = SourceSinkTrace();
+  trace.set_calculator_name(0, "say \"hi\"\\");
+  ChromeTraceWriter writer;
+  std::string json;
+  writer.AppendTrace(trace, &json);
+  EXPECT_THAT(json, HasSubstr(R"({"name":"say \"hi\"\\",)"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,187 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/reporter/critical_path.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using mediapipe::reporter::CriticalPathAnalyzer;
+using mediapipe::reporter::CriticalPathNodeData;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// A graph input packet is sent to "A" and "B", which both feed "C".
+// At timestamp 100, "A" finishes last.  At timestamp 101, "B" finishes last,
+// and its start and finish are logged as separate events, both listing its
+// input.
+GraphProfile DiamondProfile() {
+  return ParseTextProtoOrDie<GraphProfile>(R"pb(
+    graph_trace {
+      base_time: 0
+      base_timestamp: 100
+      calculator_name: [ "A", "B", "C" ]
+      stream_name: [ "", "input", "a_c", "b_c" ]
+
+      calculator_trace {
+        node_id: -1
+        input_timestamp: 0
+        event_type: PROCESS
+        finish_time: 1000
+        output_trace { packet_timestamp: 0 stream_id: 1 }
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1100
+        finish_time: 1300
+        input_trace { packet_timestamp: 0 stream_id: 1 }
+        output_trace { packet_timestamp: 0 stream_id: 2 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1050
+        finish_time: 1150
+        input_trace { packet_timestamp: 0 stream_id: 1 }
+        output_trace { packet_timestamp: 0 stream_id: 3 }
+      }
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1400
+        finish_time: 1500
+        input_trace { packet_timestamp: 0 stream_id: 2 }
+        input_trace { packet_timestamp: 0 stream_id: 3 }
+      }
+
+      calculator_trace {
+        node_id: -1
+        input_timestamp: 1
+        event_type: PROCESS
+        finish_time: 2000
+        output_trace { packet_timestamp: 1 stream_id: 1 }
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 2000
+        finish_time: 2100
+        input_trace { packet_timestamp: 1 stream_id: 1 }
+        output_trace { packet_timestamp: 1 stream_id: 2 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 2050
+        input_trace { packet_timestamp: 1 stream_id: 1 }
+        thread_id: 2
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 1
+        event_type: PROCESS
+        finish_time: 2500
+        input_trace { packet_timestamp: 1 stream_id: 1 }
+        output_trace { packet_timestamp: 1 stream_id: 3 }
+        thread_id: 2
+      }
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 2500
+        finish_time: 2600
+        input_trace { packet_timestamp: 1 stream_id: 2 }
+        input_trace { packet_timestamp: 1 stream_id: 3 }
+      }
+    }
+  )pb");
+}
+
+const CriticalPathNodeData& FindNode(
+    const std::vector<CriticalPathNodeData>& nodes, const std::string& name) {
+  for (const auto& node : nodes) {
+    if (node.name == name) {
+      return node;
+    }
+  }
+  static const CriticalPathNodeData* kEmpty = new CriticalPathNodeData();
+  return *kEmpty;
+}
+
+TEST(CriticalPathAnalyzer, FindsCriticalPathPerFrame) {
+  CriticalPathAnalyzer analyzer;
+  analyzer.Accumulate(DiamondProfile());
+
+  ASSERT_EQ(analyzer.frames().size(), 2);
+  EXPECT_EQ(analyzer.frames()[0].timestamp, 100);
+  EXPECT_EQ(analyzer.frames()[0].latency, 500);
+  EXPECT_THAT(analyzer.frames()[0].path, ElementsAre("A", "C"));
+  EXPECT_EQ(analyzer.frames()[1].timestamp, 101);
+  EXPECT_EQ(analyzer.frames()[1].latency, 600);
+  EXPECT_THAT(analyzer.frames()[1].path, ElementsAre("B", "C"));
+  EXPECT_EQ(analyzer.latency_stat().mean(), 550);
+}
+
+TEST(CriticalPathAnalyzer, ComputesWaitAndSlack) {
+  CriticalPathAnalyzer analyzer;
+  analyzer.Accumulate(DiamondProfile());
+  std::vector<CriticalPathNodeData> nodes = analyzer.RankedNodes();
+
+  // "B" spends 450 on the critical path, "C" 200, and "A" 200.
+  ASSERT_EQ(nodes.size(), 3);
+  EXPECT_EQ(nodes[0].name, "B");
+
+  const CriticalPathNodeData& a = FindNode(nodes, "A");
+  EXPECT_EQ(a.frames, 2);
+  EXPECT_EQ(a.critical_frames, 1);
+  EXPECT_EQ(a.critical_wait_stat.mean(), 100);
+  // Slack is 100 at timestamp 100, and 2500 - 2100 = 400 at timestamp 101.
+  EXPECT_EQ(a.slack_stat.mean(), 250);
+
+  const CriticalPathNodeData& c = FindNode(nodes, "C");
+  EXPECT_EQ(c.critical_frames, 2);
+  EXPECT_EQ(c.critical_time_stat.mean(), 100);
+  // "C" waits 100 after "A" at timestamp 100, and 0 after "B" at 101.
+  EXPECT_EQ(c.critical_wait_stat.mean(), 50);
+  EXPECT_EQ(c.slack_stat.mean(), 0);
+}
+
+TEST(CriticalPathAnalyzer, PrintsRankedReport) {
+  CriticalPathAnalyzer analyzer;
+  analyzer.Accumulate(DiamondProfile());
+  std::stringstream output;
+  analyzer.Print(output);
+  EXPECT_THAT(output.str(), HasSubstr("frames 2 latency_mean 550.00"));
+  EXPECT_THAT(output.str(), HasSubstr("1 A -> C"));
+  EXPECT_THAT(output.str(), HasSubstr("1 B -> C"));
+}
+
+}  // namespace
+}  // namespace mediapipe
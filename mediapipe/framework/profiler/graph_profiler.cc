@@ -14,9 +14,15 @@
 
 #include "mediapipe/framework/profiler/graph_profiler.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <limits>
 #include <list>
+#include <thread>  // NOLINT(build/c++11)
 
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
@@ -44,6 +50,12 @@ const char kDefaultLogFilePrefix[] = "mediapipe_trace_";
 // The number of recent timestamps tracked for each input stream.
 const int kPacketInfoRecentCount = 100;
 
+// The number of entries in StreamProfile::queue_depth_count.
+const int kMaxQueueDepthCount = 64;
+
+// The number of Process() runtime shards used while sampling.
+const int kProcessShardCount = 16;
+
 std::string PacketIdToString(const PacketId& packet_id) {
   return absl::Substitute("stream_name: $0, timestamp_usec: $1",
                           packet_id.stream_name, packet_id.timestamp_usec);
@@ -115,6 +127,43 @@ PacketInfo* GetPacketInfo(PacketInfoMap* map, const PacketId& packet_id) {
   return nullptr;
 }
 
+// Returns true if Process() calls are sampled.
+bool IsSamplingEnabled(const ProfilerConfig& profiler_config) {
+  return profiler_config.sample_every_n_timestamps() > 1 ||
+         profiler_config.sample_interval_usec() > 0;
+}
+
+// Scrambles the bits of a timestamp value, so that timestamps at regular
+// intervals are sampled evenly.
+uint64 MixTimestamp(int64 value) {
+  uint64 x = static_cast<uint64>(value);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// Returns the key of a calculator input stream in a QueuedPacketMap.
+std::string QueuedPacketKey(const std::string& node_name,
+                            const std::string& stream_name) {
+  return absl::StrCat(node_name, "/", stream_name);
+}
+
+// Returns the profile of a calculator input stream, or nullptr if it is not
+// profiled.
+StreamProfile* FindInputStreamProfile(const std::string& stream_name,
+                                      CalculatorProfile* calculator_profile) {
+  for (StreamProfile& stream_profile :
+       *calculator_profile->mutable_input_stream_profiles()) {
+    if (stream_profile.name() == stream_name) {
+      return &stream_profile;
+    }
+  }
+  return nullptr;
+}
+
 }  // namespace
 
 void GraphProfiler::Initialize(
@@ -135,6 +184,7 @@ void GraphProfiler::Initialize(
        node_id < validated_graph_config.CalculatorInfos().size(); ++node_id) {
     std::string node_name =
         tool::CanonicalNodeName(validated_graph_config.Config(), node_id);
+    node_names_.push_back(node_name);
     CalculatorProfile profile;
     profile.set_name(node_name);
     InitializeTimeHistogram(interval_size_usec, num_intervals,
@@ -156,6 +206,24 @@ void GraphProfiler::Initialize(
     CHECK(iter.second) << absl::Substitute(
         "Calculator \"$0\" has already been added.", node_name);
   }
+  is_sampling_ = IsSamplingEnabled(profiler_config_);
+  if (is_sampling_) {
+    int num_nodes = node_names_.size();
+    last_sampled_interval_ =
+        absl::make_unique<std::atomic<int64>[]>(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      last_sampled_interval_[i] = std::numeric_limits<int64>::min();
+    }
+    for (int i = 0; i < kProcessShardCount; ++i) {
+      auto shard = absl::make_unique<ProcessShard>();
+      absl::MutexLock shard_lock(&shard->mutex);
+      shard->process_runtime.resize(num_nodes);
+      for (TimeHistogram& histogram : shard->process_runtime) {
+        InitializeTimeHistogram(interval_size_usec, num_intervals, &histogram);
+      }
+      process_shards_.push_back(std::move(shard));
+    }
+  }
   is_initialized_ = true;
 }
 
@@ -194,6 +262,21 @@ void GraphProfiler::Reset() {
     for (auto& input_stream_profile :
          *(calculator_profile->mutable_input_stream_profiles())) {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
+      ResetTimeHistogram(input_stream_profile.mutable_queue_wait());
+      input_stream_profile.clear_queue_depth_count();
+      input_stream_profile.set_max_queue_depth(0);
+      input_stream_profile.set_dropped_packets(0);
+    }
+  }
+  for (auto& shard : process_shards_) {
+    absl::MutexLock shard_lock(&shard->mutex);
+    for (TimeHistogram& histogram : shard->process_runtime) {
+      ResetTimeHistogram(&histogram);
+    }
+  }
+  if (last_sampled_interval_) {
+    for (int i = 0; i < node_names_.size(); ++i) {
+      last_sampled_interval_[i] = std::numeric_limits<int64>::min();
     }
   }
 }
@@ -250,6 +333,13 @@ void GraphProfiler::LogEvent(const TraceEvent& event) {
   // Record event info in the profiling histograms.
   if (event.event_type == GraphTrace::PROCESS && event.node_id == -1) {
     AddPacketInfo(event);
+  } else if (event.event_type == GraphTrace::PACKET_QUEUED &&
+             event.packet_ts == event.input_ts) {
+    // Each arrival is logged once with packet_ts at the queue tail, and once
+    // more with packet_ts at the queue head.
+    AddQueuedPacket(event);
+  } else if (event.event_type == GraphTrace::PACKET_DROPPED) {
+    AddDroppedPackets(event);
   }
 }
 
@@ -281,6 +371,82 @@ void GraphProfiler::AddPacketInfo(const TraceEvent& packet_info) {
                         production_time_usec, production_time_usec);
 }
 
+void GraphProfiler::AddQueuedPacket(const TraceEvent& packet_queued) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_ || !profiler_config_.enable_stream_latency()) {
+    return;
+  }
+  if (packet_queued.node_id < 0 ||
+      packet_queued.node_id >= static_cast<int>(node_names_.size()) ||
+      packet_queued.stream_id == nullptr) {
+    return;
+  }
+
+  const std::string& node_name = node_names_[packet_queued.node_id];
+  const std::string& stream_name = *packet_queued.stream_id;
+  int64 arrival_time_usec = TimeNowUsec();
+  auto profile_iter = calculator_profiles_.find(node_name);
+  if (profile_iter == calculator_profiles_.end()) {
+    return;
+  }
+  StreamProfile* stream_profile =
+      FindInputStreamProfile(stream_name, &profile_iter->second);
+  if (stream_profile == nullptr) {
+    return;
+  }
+
+  // Update the queue depth counts.
+  int64 queue_depth = packet_queued.event_data;
+  stream_profile->set_max_queue_depth(
+      std::max(stream_profile->max_queue_depth(), queue_depth));
+  int depth_index =
+      std::min<int64>(std::max<int64>(queue_depth, 0), kMaxQueueDepthCount - 1);
+  auto* counts = stream_profile->mutable_queue_depth_count();
+  if (counts->size() <= depth_index) {
+    counts->Resize(depth_index + 1, /*value=*/0);
+  }
+  counts->Set(depth_index, counts->Get(depth_index) + 1);
+
+  // Record the arrival time, for the queue wait time.
+  if (!packet_queued.input_ts.IsRangeValue()) {
+    return;
+  }
+  std::string key = QueuedPacketKey(node_name, stream_name);
+  auto entry = queued_packets_.find(key);
+  if (entry == queued_packets_.end()) {
+    entry = queued_packets_.insert({key, {}}).first;
+  }
+  auto& list = entry->second;
+  list.push_back({packet_queued.input_ts.Value(), arrival_time_usec});
+  while (list.size() > kPacketInfoRecentCount) {
+    list.pop_front();
+  }
+}
+
+void GraphProfiler::AddDroppedPackets(const TraceEvent& packets_dropped) {
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_ || !profiler_config_.enable_stream_latency()) {
+    return;
+  }
+  if (packets_dropped.node_id < 0 ||
+      packets_dropped.node_id >= static_cast<int>(node_names_.size()) ||
+      packets_dropped.stream_id == nullptr) {
+    return;
+  }
+
+  auto profile_iter =
+      calculator_profiles_.find(node_names_[packets_dropped.node_id]);
+  if (profile_iter == calculator_profiles_.end()) {
+    return;
+  }
+  StreamProfile* stream_profile =
+      FindInputStreamProfile(*packets_dropped.stream_id, &profile_iter->second);
+  if (stream_profile != nullptr) {
+    stream_profile->set_dropped_packets(stream_profile->dropped_packets() +
+                                        packets_dropped.event_data);
+  }
+}
+
 absl::Status GraphProfiler::GetCalculatorProfiles(
     std::vector<CalculatorProfile>* profiles) const {
   absl::ReaderMutexLock lock(&profiler_mutex_);
@@ -289,9 +455,70 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
   for (auto& entry : calculator_profiles_) {
     profiles->push_back(entry.second);
   }
+  MergeProcessShards(profiles);
   return absl::OkStatus();
 }
 
+bool GraphProfiler::IsSampledTimestamp(int node_id, Timestamp timestamp) {
+  if (!timestamp.IsRangeValue()) {
+    return true;
+  }
+  int64 sample_every_n = profiler_config_.sample_every_n_timestamps();
+  if (sample_every_n > 1 &&
+      MixTimestamp(timestamp.Value()) % sample_every_n != 0) {
+    return false;
+  }
+  int64 interval_usec = profiler_config_.sample_interval_usec();
+  if (interval_usec > 0) {
+    if (node_id < 0 || node_id >= static_cast<int>(node_names_.size())) {
+      return false;
+    }
+    // Sample the first timestamp to reach each new interval.
+    int64 interval = timestamp.Value() / interval_usec;
+    std::atomic<int64>& last_interval = last_sampled_interval_[node_id];
+    int64 previous = last_interval.load(std::memory_order_relaxed);
+    return interval > previous &&
+           last_interval.compare_exchange_strong(previous, interval,
+                                                 std::memory_order_relaxed);
+  }
+  return true;
+}
+
+GraphProfiler::ProcessShard* GraphProfiler::GetProcessShard() {
+  static thread_local const size_t thread_hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return process_shards_[thread_hash % process_shards_.size()].get();
+}
+
+void GraphProfiler::MergeProcessShards(
+    std::vector<CalculatorProfile>* profiles) const {
+  if (process_shards_.empty()) {
+    return;
+  }
+  for (CalculatorProfile& profile : *profiles) {
+    auto node = std::find(node_names_.begin(), node_names_.end(),
+                          profile.name());
+    if (node == node_names_.end()) {
+      continue;
+    }
+    int node_id = node - node_names_.begin();
+    for (const auto& shard : process_shards_) {
+      absl::MutexLock shard_lock(&shard->mutex);
+      MergeTimeHistogram(shard->process_runtime[node_id],
+                         profile.mutable_process_runtime());
+    }
+  }
+}
+
+void GraphProfiler::MergeTimeHistogram(const TimeHistogram& source,
+                                       TimeHistogram* histogram) {
+  histogram->set_total(histogram->total() + source.total());
+  for (int i = 0; i < source.count_size() && i < histogram->count_size();
+       ++i) {
+    histogram->set_count(i, histogram->count(i) + source.count(i));
+  }
+}
+
 void GraphProfiler::InitializeTimeHistogram(int64 interval_size_usec,
                                             int64 num_intervals,
                                             TimeHistogram* histogram) {
@@ -320,6 +547,8 @@ void GraphProfiler::InitializeInputStreams(
                                         back_edge_ids.end());
     InitializeTimeHistogram(interval_size_usec, num_intervals,
                             input_stream_profile->mutable_latency());
+    InitializeTimeHistogram(interval_size_usec, num_intervals,
+                            input_stream_profile->mutable_queue_wait());
   }
 }
 
@@ -448,6 +677,28 @@ void GraphProfiler::AddTimeSample(int64 start_time_usec, int64 end_time_usec,
   histogram->set_count(interval_index, histogram->count(interval_index) + 1);
 }
 
+void GraphProfiler::AddQueueWaitSample(const std::string& node_name,
+                                       const PacketId& packet_id,
+                                       int64 start_time_usec,
+                                       StreamProfile* stream_profile) {
+  auto entry =
+      queued_packets_.find(QueuedPacketKey(node_name, packet_id.stream_name));
+  if (entry == queued_packets_.end()) {
+    return;
+  }
+  // Packets are consumed in timestamp order, so earlier arrivals are
+  // consumed or dropped already.
+  auto& list = entry->second;
+  while (!list.empty() && list.front().first < packet_id.timestamp_usec) {
+    list.pop_front();
+  }
+  if (!list.empty() && list.front().first == packet_id.timestamp_usec) {
+    AddTimeSample(list.front().second, start_time_usec,
+                  stream_profile->mutable_queue_wait());
+    list.pop_front();
+  }
+}
+
 int64 GraphProfiler::AddInputStreamTimeSamples(
     const CalculatorContext& calculator_context, int64 start_time_usec,
     CalculatorProfile* calculator_profile) {
@@ -465,6 +716,10 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
 
     PacketId packet_id = {calculator_context.Inputs().Get(id).Name(),
                           input_timestamp_usec};
+    StreamProfile* stream_profile =
+        calculator_profile->mutable_input_stream_profiles(input_stream_counter);
+    AddQueueWaitSample(calculator_context.NodeName(), packet_id,
+                       start_time_usec, stream_profile);
     PacketInfo* packet_info = GetPacketInfo(&packets_info_, packet_id);
     if (packet_info == nullptr) {
       // This is a condition rather than a failure CHECK because
@@ -474,10 +729,8 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
                                 << PacketIdToString(packet_id);
       continue;
     }
-    AddTimeSample(
-        packet_info->production_time_usec, start_time_usec,
-        calculator_profile->mutable_input_stream_profiles(input_stream_counter)
-            ->mutable_latency());
+    AddTimeSample(packet_info->production_time_usec, start_time_usec,
+                  stream_profile->mutable_latency());
 
     min_source_process_start_usec = std::min(
         min_source_process_start_usec, packet_info->source_process_start_usec);
@@ -489,6 +742,24 @@ int64 GraphProfiler::AddInputStreamTimeSamples(
 void GraphProfiler::AddProcessSample(
     const CalculatorContext& calculator_context, int64 start_time_usec,
     int64 end_time_usec) {
+  if (is_sampling_) {
+    // Update Process() runtime in the shard for this thread.
+    int node_id = calculator_context.NodeId();
+    if (!is_profiling_ || node_id < 0 ||
+        node_id >= static_cast<int>(node_names_.size())) {
+      return;
+    }
+    ProcessShard* shard = GetProcessShard();
+    {
+      absl::MutexLock shard_lock(&shard->mutex);
+      AddTimeSample(start_time_usec, end_time_usec,
+                    &shard->process_runtime[node_id]);
+    }
+    if (!profiler_config_.enable_stream_latency()) {
+      return;
+    }
+  }
+
   absl::ReaderMutexLock lock(&profiler_mutex_);
   if (!is_profiling_) {
     return;
@@ -502,8 +773,10 @@ void GraphProfiler::AddProcessSample(
   CalculatorProfile* calculator_profile = &profile_iter->second;
 
   // Update Process() runtime.
-  AddTimeSample(start_time_usec, end_time_usec,
-                calculator_profile->mutable_process_runtime());
+  if (!is_sampling_) {
+    AddTimeSample(start_time_usec, end_time_usec,
+                  calculator_profile->mutable_process_runtime());
+  }
 
   if (profiler_config_.enable_stream_latency()) {
     int64 min_source_process_start_usec = AddStreamLatencies(
@@ -633,8 +906,13 @@ absl::Status GraphProfiler::WriteProfile() {
     AssignNodeNames(&profile);
   }
 
-  // Write the GraphProfile to the trace_log_path.
   int log_index = previous_log_index_ / log_interval_count % log_file_count;
+  if (profiler_config_.trace_log_format() ==
+      ProfilerConfig::CHROME_TRACE_JSON) {
+    return WriteChromeTrace(trace_log_path, log_index, is_new_file, &profile);
+  }
+
+  // Write the GraphProfile to the trace_log_path.
   std::string log_path = absl::StrCat(trace_log_path, log_index, ".binarypb");
   std::ofstream ofs;
   if (is_new_file) {
@@ -648,4 +926,31 @@ absl::Status GraphProfiler::WriteProfile() {
   return absl::OkStatus();
 }
 
+absl::Status GraphProfiler::WriteChromeTrace(const std::string& trace_log_path,
+                                             int log_index, bool is_new_file,
+                                             GraphProfile* profile) {
+  // Node names are assigned by CaptureProfile only along with the config.
+  GraphTrace* trace = profile->mutable_graph_trace(0);
+  if (trace->calculator_name().empty()) {
+    const CalculatorGraphConfig& config = validated_graph_->Config();
+    for (int i = 0; i < config.node().size(); ++i) {
+      trace->add_calculator_name(CanonicalNodeName(config, i));
+    }
+  }
+  std::string json = is_new_file ? chrome_trace_writer_.BeginFile() : "";
+  chrome_trace_writer_.AppendTrace(*trace, &json);
+
+  std::string log_path = absl::StrCat(trace_log_path, log_index, ".json");
+  std::ofstream ofs;
+  if (is_new_file) {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::trunc);
+  } else {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::app);
+  }
+  ofs << json;
+  ofs.close();
+  RET_CHECK(!ofs.fail()) << "Could not write Chrome trace to: " << log_path;
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -30,6 +31,7 @@
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
@@ -80,6 +82,10 @@ class GraphProfilerTestPeer;
 // the graph (source nodes) to reach the Calculator.
 // - Process input latency: Process input latency + process runtime for a
 // packet.
+// - Input queue wait: Time from when a packet was queued at an input stream to
+// when it was consumed by the calculator.
+// - Input queue depth: The number of packets queued at an input stream when
+// each packet arrives, and the number of packets dropped without processing.
 //
 // The profiler can be configured in the graph definition:
 //   profiler_config {
@@ -93,6 +99,15 @@ class GraphProfilerTestPeer;
 // profiler disables itself and returns an empty stub if Initialize() is called
 // more than once.
 //
+// For production use, the profiler can sample Process() calls, either for
+// one in every N input timestamps or for one input timestamp per interval:
+//   profiler_config {
+//     enable_profiler: true
+//     sample_every_n_timestamps: 100
+//   }
+// While sampling, Process() runtimes are recorded in per-thread shards, which
+// are merged only by GetCalculatorProfiles().
+//
 // The profiler uses the synchronized monotonic clock by default.
 // The client can overwrite this by calling SetClock().
 class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
@@ -102,6 +117,7 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
         is_profiling_(false),
         calculator_profiles_(1000),
         packets_info_(1000),
+        queued_packets_(1000),
         is_running_(false),
         previous_log_end_time_(absl::InfinitePast()),
         previous_log_index_(-1),
@@ -182,7 +198,12 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
         : calculator_method_(event_type),
           calculator_context_(*calculator_context),
           profiler_(profiler) {
-      start_time_usec_ = profiler_->TimeNowUsec();
+      is_sampled_ =
+          profiler_->is_profiling_ &&
+          profiler_->IsSampled(calculator_method_, calculator_context_);
+      if (is_sampled_ || profiler_->is_tracing_) {
+        start_time_usec_ = profiler_->TimeNowUsec();
+      }
       if (profiler_->is_tracing_) {
         absl::Time time_now = absl::FromUnixMicros(start_time_usec_);
         profiler_->packet_tracer_->LogInputEvents(
@@ -192,11 +213,10 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
 
     inline ~Scope() {
       int64 end_time_usec;
-      if (profiler_->is_profiling_ || profiler_->is_tracing_) {
+      if (is_sampled_ || profiler_->is_tracing_) {
         end_time_usec = profiler_->TimeNowUsec();
       }
-      if (profiler_->is_profiling_) {
-        int64 end_time_usec = profiler_->TimeNowUsec();
+      if (is_sampled_) {
         switch (calculator_method_) {
           case GraphTrace::OPEN:
             profiler_->SetOpenRuntime(calculator_context_, start_time_usec_,
@@ -228,6 +248,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
     const CalculatorContext& calculator_context_;
     GraphProfiler* profiler_;
     int64 start_time_usec_;
+    // True if this call is recorded in the calculator profile.
+    bool is_sampled_;
   };
 
  private:
@@ -239,6 +261,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // is valid for profiling.
   void AddPacketInfo(const TraceEvent& packet_info)
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+  // Records the arrival time and the resulting queue size for a packet queued
+  // at an input stream.
+  void AddQueuedPacket(const TraceEvent& packet_queued)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+  // Records the number of packets dropped from an input stream.
+  void AddDroppedPackets(const TraceEvent& packets_dropped)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
   static void InitializeTimeHistogram(int64 interval_size_usec,
                                       int64 num_intervals,
                                       TimeHistogram* histogram);
@@ -282,6 +311,12 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                        int64 start_time_usec, int64 end_time_usec)
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Updates the queue wait time for an input packet consumed at
+  // |start_time_usec|.
+  void AddQueueWaitSample(const std::string& node_name,
+                          const PacketId& packet_id, int64 start_time_usec,
+                          StreamProfile* stream_profile);
+
   // Updates the input streams profiles for the calculator and returns the
   // minimum |source_process_start_usec| of all input packets, excluding empty
   // packets and back-edge packets. Returns -1 if there is no input packets.
@@ -289,6 +324,26 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                                   int64 start_time_usec,
                                   CalculatorProfile* calculator_profile);
 
+  // Returns true if a calculator call should be recorded in the calculator
+  // profile.  Only Process() calls are sampled.
+  inline bool IsSampled(GraphTrace::EventType event_type,
+                        const CalculatorContext& calculator_context) {
+    return !is_sampling_ || event_type != GraphTrace::PROCESS ||
+           IsSampledTimestamp(calculator_context.NodeId(),
+                              calculator_context.InputTimestamp());
+  }
+  // Returns true if Process() calls at |timestamp| are sampled for a node.
+  bool IsSampledTimestamp(int node_id, Timestamp timestamp);
+
+  // Returns the Process() runtime shard for the current thread.
+  struct ProcessShard;
+  ProcessShard* GetProcessShard();
+  // Adds the Process() runtimes from all shards to |profiles|.
+  void MergeProcessShards(std::vector<CalculatorProfile>* profiles) const;
+  // Adds the counts of one TimeHistogram to another.
+  static void MergeTimeHistogram(const TimeHistogram& source,
+                                 TimeHistogram* histogram);
+
   // Updates the Process() data for calculator.
   // Requires ReaderLock for is_profiling_.
   void AddProcessSample(const CalculatorContext& calculator_context,
@@ -300,6 +355,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // trace_log_path.
   absl::StatusOr<std::string> GetTraceLogPath();
 
+  // Writes the trace of |profile| as Chrome trace-event JSON.
+  absl::Status WriteChromeTrace(const std::string& trace_log_path,
+                                int log_index, bool is_new_file,
+                                GraphProfile* profile);
+
   // Helper method to get the clock time in microsecond.
   int64 TimeNowUsec() { return ToUnixMicros(clock_->TimeNow()); }
 
@@ -323,6 +383,25 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   using PacketInfoMap =
       ShardedMap<std::string, std::list<std::pair<int64, PacketInfo>>>;
   PacketInfoMap packets_info_;
+  // Stores the arrival time of recently queued packets, based on profiler's
+  // clock, for each calculator input stream.
+  using QueuedPacketMap =
+      ShardedMap<std::string, std::list<std::pair<int64, int64>>>;
+  QueuedPacketMap queued_packets_;
+  // The canonical name of each calculator, indexed by node id.
+  std::vector<std::string> node_names_;
+
+  // If true, only sampled Process() calls are profiled, and their runtimes
+  // are recorded in process_shards_.  See ProfilerConfig.
+  bool is_sampling_ = false;
+  // The highest sample_interval_usec interval sampled, indexed by node id.
+  std::unique_ptr<std::atomic<int64>[]> last_sampled_interval_;
+  // Process() runtime histograms, indexed by node id, for groups of threads.
+  struct ProcessShard {
+    absl::Mutex mutex;
+    std::vector<TimeHistogram> process_runtime ABSL_GUARDED_BY(mutex);
+  };
+  std::vector<std::unique_ptr<ProcessShard>> process_shards_;
 
   // Global mutex for the profiler.
   mutable absl::Mutex profiler_mutex_;
@@ -342,6 +421,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The index number of the previous output log.
   int previous_log_index_;
 
+  // Converts traces for ProfilerConfig::CHROME_TRACE_JSON.
+  ChromeTraceWriter chrome_trace_writer_;
+
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
@@ -55,6 +55,7 @@ class TraceEvent {
     TPU_TASK,
     GPU_CALIBRATION,
     PACKET_QUEUED,
+    PACKET_DROPPED,
   };
   TraceEvent(const EventType& event_type) {}
   TraceEvent() {}
@@ -286,6 +286,14 @@ TEST_F(GraphProfilerTestPeer, InitializeConfig) {
                     count: 0
                     count: 0
                   }
+                  queue_wait {
+                    total: 0
+                    interval_size_usec: 1000
+                    num_intervals: 3
+                    count: 0
+                    count: 0
+                    count: 0
+                  }
                 }
               )pb"));
 }
@@ -862,6 +870,12 @@ TEST_F(GraphProfilerTestPeer, SetCloseRuntimeWithStreamLatency) {
                     num_intervals: 1
                     count: 0
                   }
+                  queue_wait {
+                    total: 0
+                    interval_size_usec: 1000000
+                    num_intervals: 1
+                    count: 0
+                  }
                 }
               )pb"));
   PacketInfo expected_packet_info = {0,
@@ -1133,6 +1147,118 @@ TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
   ASSERT_NE(GetPacketInfo(GetPacketsInfoMap(), {"stream_1", 100}), nullptr);
 }
 
+// Tests that PACKET_QUEUED and PACKET_DROPPED events update the queue depth,
+// queue wait time, and dropped packets of the input stream profiles.
+TEST_F(GraphProfilerTestPeer, AddQueuedAndDroppedPackets) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+      enable_stream_latency: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      name: "consumer_calc"
+      input_stream: "input_stream"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+
+  // Two packets arrive, and an earlier packet is dropped.
+  const std::string stream_name = "input_stream";
+  simulation_clock->SleepUntil(absl::FromUnixMicros(1000));
+  profiler_.LogEvent(TraceEvent(GraphTrace::PACKET_QUEUED)
+                         .set_node_id(0)
+                         .set_stream_id(&stream_name)
+                         .set_input_ts(Timestamp(100))
+                         .set_packet_ts(Timestamp(100))
+                         .set_event_data(1));
+  simulation_clock->SleepUntil(absl::FromUnixMicros(1100));
+  profiler_.LogEvent(TraceEvent(GraphTrace::PACKET_QUEUED)
+                         .set_node_id(0)
+                         .set_stream_id(&stream_name)
+                         .set_input_ts(Timestamp(200))
+                         .set_packet_ts(Timestamp(200))
+                         .set_event_data(2));
+  // The same arrival logged again for the queue head is not counted.
+  profiler_.LogEvent(TraceEvent(GraphTrace::PACKET_QUEUED)
+                         .set_node_id(0)
+                         .set_stream_id(&stream_name)
+                         .set_input_ts(Timestamp(200))
+                         .set_packet_ts(Timestamp(100))
+                         .set_event_data(2));
+  profiler_.LogEvent(TraceEvent(GraphTrace::PACKET_DROPPED)
+                         .set_node_id(0)
+                         .set_stream_id(&stream_name)
+                         .set_event_data(1));
+
+  // The packet at timestamp 200 is processed.
+  TestContextBuilder consumer_context("consumer_calc", /*node_id=*/0,
+                                      {"input_stream"}, {});
+  consumer_context.AddInputs(
+      {MakePacket<std::string>("15").At(Timestamp(200))});
+  simulation_clock->SleepUntil(absl::FromUnixMicros(1400));
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS,
+                                        consumer_context.get(), &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(50));
+  }
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  simulation_clock->ThreadFinish();
+
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_THAT(profiles[0], Partially(EqualsProto(R"pb(
+                input_stream_profiles {
+                  name: "input_stream"
+                  queue_wait { total: 300 count: 1 }
+                  queue_depth_count: [ 0, 1, 1 ]
+                  max_queue_depth: 2
+                  dropped_packets: 1
+                }
+              )pb")));
+}
+
+// Tests that with sample_interval_usec only the first Process() call in each
+// timestamp interval is recorded, and that Reset() clears the sampled data.
+TEST_F(GraphProfilerTestPeer, SampleProcessByInterval) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+      sample_interval_usec: 1000
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+
+  // Timestamps 0, 1000 and 2500 start new intervals.
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {});
+  for (int64 timestamp : {0, 500, 1000, 1500, 2500}) {
+    context.Clear();
+    context.AddInputs({MakePacket<std::string>("5").At(Timestamp(timestamp))});
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS, context.get(),
+                                        &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(100));
+  }
+
+  EXPECT_THAT(Profiles()[0].process_runtime(),
+              Partially(EqualsProto(CreateTimeHistogram(/*total=*/300, {3}))));
+
+  profiler_.Reset();
+  EXPECT_THAT(Profiles()[0].process_runtime(),
+              Partially(EqualsProto(CreateTimeHistogram(/*total=*/0, {0}))));
+  simulation_clock->ThreadFinish();
+}
+
 // This test shows that CalculatorGraph::GetCalculatorProfiles and
 // GraphProfiler::AddProcessSample() can be called in parallel.
 // Without the GraphProfiler::profiler_mutex_ this test should
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/strings/match.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -1011,6 +1012,26 @@ TEST_F(GraphTracerE2ETest, DemuxGraphLogFile) {
   EXPECT_EQ(113, profile.graph_trace(0).calculator_trace().size());
 }
 
+TEST_F(GraphTracerE2ETest, DemuxGraphChromeTraceFile) {
+  std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_file_");
+  SetUpDemuxInFlightGraph();
+  graph_config_.mutable_profiler_config()->set_trace_log_path(log_path);
+  graph_config_.mutable_profiler_config()->set_trace_log_interval_usec(-1);
+  graph_config_.mutable_profiler_config()->set_trace_log_format(
+      ProfilerConfig::CHROME_TRACE_JSON);
+  RunDemuxInFlightGraph();
+  EXPECT_FALSE(
+      mediapipe::file::Exists(absl::StrCat(log_path, 0, ".binarypb")).ok());
+  std::string json;
+  MP_ASSERT_OK(
+      file::GetContents(absl::StrCat(log_path, 0, ".json"), &json, true));
+  EXPECT_TRUE(absl::StartsWith(json, "[\n"));
+  EXPECT_THAT(json, testing::HasSubstr(R"({"name":"RoundRobinDemuxCalculator",)"
+                                       R"("cat":"PROCESS","ph":"X")"));
+  EXPECT_THAT(json, testing::HasSubstr(R"("cat":"packet","ph":"s")"));
+  EXPECT_THAT(json, testing::HasSubstr(R"("cat":"packet","ph":"f")"));
+}
+
 TEST_F(GraphTracerE2ETest, DemuxGraphLogFiles) {
   std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/log_files_");
   SetUpDemuxInFlightGraph();
@@ -0,0 +1,305 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/reporter/critical_path.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "mediapipe/framework/port/proto_ns.h"
+
+namespace mediapipe {
+namespace reporter {
+
+namespace {
+
+// The number of distinct critical paths printed.
+constexpr int kPrintedPathCount = 5;
+
+// Identifies a packet by stream name and packet timestamp.
+using PacketKey = std::pair<std::string, int64_t>;
+
+// One Process() call, with times and timestamps relative to the epoch.
+struct Call {
+  int32_t node_id = 0;
+  int64_t timestamp = 0;
+  int64_t start_time = 0;
+  int64_t finish_time = 0;
+  std::vector<PacketKey> inputs;
+  std::vector<PacketKey> outputs;
+};
+
+// Identifies a Process() call split into start and finish events.
+using CallKey = std::tuple<int32_t, int64_t, int32_t>;
+
+std::string StreamName(const GraphTrace& graph_trace, int32_t stream_id) {
+  return (stream_id >= 0 && stream_id < graph_trace.stream_name_size())
+             ? graph_trace.stream_name(stream_id)
+             : absl::StrFormat("stream_%d", stream_id);
+}
+
+void AddStreams(
+    const GraphTrace& graph_trace,
+    const proto_ns::RepeatedPtrField<GraphTrace::StreamTrace>& stream_traces,
+    std::vector<PacketKey>* result) {
+  for (const auto& stream_trace : stream_traces) {
+    result->emplace_back(
+        StreamName(graph_trace, stream_trace.stream_id()),
+        graph_trace.base_timestamp() + stream_trace.packet_timestamp());
+  }
+}
+
+// Collects the Process() calls in a profile, joining start and finish events.
+// Calls that started or finished outside of the traces are omitted.
+std::vector<Call> CollectCalls(const mediapipe::GraphProfile& profile) {
+  std::vector<Call> result;
+  std::map<CallKey, Call> started_calls;
+  for (const auto& graph_trace : profile.graph_trace()) {
+    for (const auto& calc_trace : graph_trace.calculator_trace()) {
+      if (calc_trace.event_type() != mediapipe::GraphTrace_EventType_PROCESS ||
+          !calc_trace.has_input_timestamp()) {
+        continue;
+      }
+      const int64_t timestamp =
+          graph_trace.base_timestamp() + calc_trace.input_timestamp();
+      const CallKey key{calc_trace.node_id(), timestamp,
+                        calc_trace.thread_id()};
+      if (!calc_trace.has_finish_time()) {
+        if (calc_trace.has_start_time()) {
+          Call& call = started_calls[key];
+          call.node_id = calc_trace.node_id();
+          call.timestamp = timestamp;
+          call.start_time = graph_trace.base_time() + calc_trace.start_time();
+          AddStreams(graph_trace, calc_trace.input_trace(), &call.inputs);
+        }
+        continue;
+      }
+
+      Call call;
+      if (calc_trace.has_start_time()) {
+        call.start_time = graph_trace.base_time() + calc_trace.start_time();
+        AddStreams(graph_trace, calc_trace.input_trace(), &call.inputs);
+      } else if (started_calls.count(key)) {
+        call = std::move(started_calls[key]);
+        started_calls.erase(key);
+      } else if (calc_trace.node_id() < 0) {
+        // Packets added to graph input streams have only a finish time.
+        call.start_time = graph_trace.base_time() + calc_trace.finish_time();
+      } else {
+        continue;
+      }
+      call.node_id = calc_trace.node_id();
+      call.timestamp = timestamp;
+      call.finish_time = graph_trace.base_time() + calc_trace.finish_time();
+      // The inputs of a split call are taken from its start event only, since
+      // its finish event lists them again.
+      AddStreams(graph_trace, calc_trace.output_trace(), &call.outputs);
+      result.push_back(std::move(call));
+    }
+  }
+  return result;
+}
+
+// Returns the total of a statistic, or 0 if it holds no data.
+double Total(const Statistic& stat) {
+  return stat.data_count() > 0 ? stat.total() : 0.0;
+}
+
+std::string ToStringF(double d) { return absl::StrFormat("%1.2f", d); }
+
+}  // namespace
+
+void CriticalPathAnalyzer::Accumulate(const mediapipe::GraphProfile& profile) {
+  // Maps node IDs to names.
+  std::map<int32_t, std::string> name_lookup;
+  for (const auto& graph_trace : profile.graph_trace()) {
+    for (int i = 0; i < graph_trace.calculator_name_size(); ++i) {
+      name_lookup[i] = graph_trace.calculator_name(i);
+    }
+  }
+
+  const std::vector<Call> calls = CollectCalls(profile);
+  std::map<PacketKey, int> producers;
+  std::map<int64_t, std::vector<int>> frame_calls;
+  for (int i = 0; i < calls.size(); ++i) {
+    for (const PacketKey& output : calls[i].outputs) {
+      producers[output] = i;
+    }
+    frame_calls[calls[i].timestamp].push_back(i);
+  }
+
+  for (const auto& frame_entry : frame_calls) {
+    const std::vector<int>& frame = frame_entry.second;
+    if (std::none_of(frame.begin(), frame.end(),
+                     [&](int i) { return calls[i].node_id >= 0; })) {
+      continue;
+    }
+
+    // Link each call to the producers of its inputs within the frame.
+    std::map<int, std::vector<int>> inputs_from;
+    std::map<int, std::vector<int>> outputs_to;
+    int64_t frame_start = std::numeric_limits<int64_t>::max();
+    int last_call = frame.front();
+    for (int i : frame) {
+      frame_start = std::min(frame_start, calls[i].start_time);
+      if (calls[i].finish_time > calls[last_call].finish_time) {
+        last_call = i;
+      }
+      for (const PacketKey& input : calls[i].inputs) {
+        auto it = producers.find(input);
+        if (it != producers.end() && it->second != i &&
+            calls[it->second].timestamp == frame_entry.first) {
+          inputs_from[i].push_back(it->second);
+          outputs_to[it->second].push_back(i);
+        }
+      }
+    }
+    const int64_t frame_finish = calls[last_call].finish_time;
+
+    // The latest finish time of each call that does not delay the frame.
+    // Consumers start after their producers, so latest start first.
+    std::vector<int> order = frame;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return std::tie(calls[a].start_time, calls[a].finish_time) >
+             std::tie(calls[b].start_time, calls[b].finish_time);
+    });
+    std::map<int, int64_t> latest_finish;
+    for (int i : order) {
+      int64_t latest = frame_finish;
+      for (int consumer : outputs_to[i]) {
+        auto it = latest_finish.find(consumer);
+        if (it != latest_finish.end()) {
+          const Call& c = calls[consumer];
+          latest =
+              std::min(latest, it->second - (c.finish_time - c.start_time));
+        }
+      }
+      latest_finish[i] = latest;
+      if (calls[i].node_id >= 0) {
+        CriticalPathNodeData& data = node_data_[name_lookup[calls[i].node_id]];
+        ++data.frames;
+        data.slack_stat.Push(
+            std::max<int64_t>(0, latest - calls[i].finish_time));
+      }
+    }
+
+    // Walk back from the last call through the last input to arrive.
+    FrameCriticalPath frame_path;
+    frame_path.timestamp = frame_entry.first;
+    frame_path.latency = frame_finish - frame_start;
+    std::set<int> visited;
+    for (int i = last_call; i >= 0 && visited.insert(i).second;) {
+      int last_input = -1;
+      for (int producer : inputs_from[i]) {
+        if (last_input < 0 ||
+            calls[producer].finish_time > calls[last_input].finish_time) {
+          last_input = producer;
+        }
+      }
+      const Call& call = calls[i];
+      if (call.node_id >= 0) {
+        const std::string& name = name_lookup[call.node_id];
+        CriticalPathNodeData& data = node_data_[name];
+        ++data.critical_frames;
+        data.critical_time_stat.Push(call.finish_time - call.start_time);
+        const int64_t arrival =
+            last_input >= 0 ? calls[last_input].finish_time : call.start_time;
+        data.critical_wait_stat.Push(
+            std::max<int64_t>(0, call.start_time - arrival));
+        frame_path.path.push_back(name);
+      }
+      i = last_input;
+    }
+    std::reverse(frame_path.path.begin(), frame_path.path.end());
+    latency_stat_.Push(frame_path.latency);
+    frames_.push_back(std::move(frame_path));
+  }
+  for (auto& entry : node_data_) {
+    entry.second.name = entry.first;
+  }
+}
+
+std::vector<CriticalPathNodeData> CriticalPathAnalyzer::RankedNodes() const {
+  std::vector<CriticalPathNodeData> result;
+  for (const auto& entry : node_data_) {
+    result.push_back(entry.second);
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const CriticalPathNodeData& a,
+                      const CriticalPathNodeData& b) {
+                     return std::make_pair(Total(a.critical_time_stat),
+                                           a.critical_frames) >
+                            std::make_pair(Total(b.critical_time_stat),
+                                           b.critical_frames);
+                   });
+  return result;
+}
+
+void CriticalPathAnalyzer::Print(std::ostream& output) const {
+  output << "frames " << frames_.size() << " latency_mean "
+         << ToStringF(latency_stat_.mean()) << " latency_stddev "
+         << ToStringF(latency_stat_.stddev()) << std::endl
+         << std::endl;
+
+  const std::vector<std::string> headers = {
+      "calculator",         "critical_percent",    "critical_time_mean",
+      "critical_time_total", "critical_wait_mean", "slack_mean"};
+  std::vector<std::vector<std::string>> lines = {headers};
+  for (const CriticalPathNodeData& data : RankedNodes()) {
+    const double percent =
+        data.frames == 0 ? 0 : 100.0 * data.critical_frames / data.frames;
+    lines.push_back({data.name, ToStringF(percent),
+                     ToStringF(data.critical_time_stat.mean()),
+                     absl::StrFormat("%1.0f", Total(data.critical_time_stat)),
+                     ToStringF(data.critical_wait_stat.mean()),
+                     ToStringF(data.slack_stat.mean())});
+  }
+  std::vector<size_t> widths(headers.size());
+  for (const auto& line : lines) {
+    for (int i = 0; i < line.size(); ++i) {
+      widths[i] = std::max(widths[i], line[i].size());
+    }
+  }
+  for (const auto& line : lines) {
+    for (int i = 0; i < line.size(); ++i) {
+      output << line[i] << std::string(widths[i] + 1 - line[i].size(), ' ');
+    }
+    output << std::endl;
+  }
+
+  std::map<std::vector<std::string>, int> path_counts;
+  for (const FrameCriticalPath& frame : frames_) {
+    ++path_counts[frame.path];
+  }
+  std::vector<std::pair<int, std::vector<std::string>>> ranked_paths;
+  for (const auto& entry : path_counts) {
+    ranked_paths.emplace_back(entry.second, entry.first);
+  }
+  std::stable_sort(
+      ranked_paths.begin(), ranked_paths.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+  output << std::endl << "critical paths" << std::endl;
+  for (int i = 0; i < ranked_paths.size() && i < kPrintedPathCount; ++i) {
+    output << ranked_paths[i].first << " "
+           << absl::StrJoin(ranked_paths[i].second, " -> ") << std::endl;
+  }
+}
+
+}  // namespace reporter
+}  // namespace mediapipe
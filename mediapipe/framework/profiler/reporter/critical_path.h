@@ -0,0 +1,106 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_CRITICAL_PATH_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_CRITICAL_PATH_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/profiler/reporter/statistic.h"
+
+namespace mediapipe {
+namespace reporter {
+
+// The critical path of a single frame, i.e. one input timestamp.
+struct FrameCriticalPath {
+  // The input timestamp of the frame.
+  int64_t timestamp = 0;
+
+  // The time from the first packet arrival to the last Process() finish
+  // for the frame (microseconds).
+  int64_t latency = 0;
+
+  // The names of the calculators on the critical path, in execution order.
+  std::vector<std::string> path;
+};
+
+// The critical path measurements for a calculator, across all frames.
+struct CriticalPathNodeData {
+  // Name of the calculator.
+  std::string name;
+
+  // The number of frames processed by the calculator.
+  int frames = 0;
+
+  // The number of frames for which the calculator was on the critical path.
+  int critical_frames = 0;
+
+  // Records the Process() time spent on the critical path (microseconds).
+  Statistic critical_time_stat;
+
+  // Records the time on the critical path between the arrival of the last
+  // input packet and the start of Process(), such as queueing and scheduling
+  // delay (microseconds).
+  Statistic critical_wait_stat;
+
+  // Records how much later each Process() call could have finished without
+  // delaying the end of its frame (microseconds).
+  Statistic slack_stat;
+};
+
+// Determines which chain of calculators sets the end-to-end latency of each
+// frame in GraphProfile traces.
+//
+// For each input timestamp, the Process() calls at that timestamp form a DAG
+// linked by the packets in their output_trace and input_trace.  The critical
+// path is found by walking back from the last call to finish, through the
+// input packet that arrived last for each call.  The slack of each call is
+// the latest finish time allowed by its consumers, minus its actual finish.
+// Packets crossing input timestamps, such as back edges, are not followed.
+//
+// The traces can be recorded with or without trace_log_instant_events.
+class CriticalPathAnalyzer {
+ public:
+  // Adds the frames traced in a given profile.
+  void Accumulate(const mediapipe::GraphProfile& profile);
+
+  // Returns the critical path of each frame, in the order accumulated.
+  const std::vector<FrameCriticalPath>& frames() const { return frames_; }
+
+  // Returns the end-to-end latency of the frames (microseconds).
+  const Statistic& latency_stat() const { return latency_stat_; }
+
+  // Returns the calculators ranked by total time on the critical path.
+  std::vector<CriticalPathNodeData> RankedNodes() const;
+
+  // Prints the latency summary, the ranked calculators, and the most frequent
+  // critical paths to a given stream (e.g., std::cout).
+  void Print(std::ostream& output) const;
+
+ private:
+  std::vector<FrameCriticalPath> frames_;
+  Statistic latency_stat_;
+
+  // Maps calculator.name -> critical path information for that calculator.
+  std::map<std::string, CriticalPathNodeData> node_data_;
+};
+
+}  // namespace reporter
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_CRITICAL_PATH_H_
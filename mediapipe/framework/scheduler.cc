@@ -102,6 +102,36 @@ absl::Status Scheduler::SetNonDefaultExecutor(const std::string& name,
   return absl::OkStatus();
 }
 
+absl::Status Scheduler::EnableWorkStealing(const std::string& name,
+                                           int num_workers) {
+  RET_CHECK_EQ(state_, STATE_NOT_STARTED) << "EnableWorkStealing must not be "
+                                             "called after the scheduler has "
+                                             "started";
+  RET_CHECK_GT(num_workers, 0);
+  ASSIGN_OR_RETURN(SchedulerQueue * queue, GetQueue(name));
+  queue->EnableWorkStealing(num_workers);
+  return absl::OkStatus();
+}
+
+absl::Status Scheduler::EnableDeadlineScheduling(const std::string& name) {
+  RET_CHECK_EQ(state_, STATE_NOT_STARTED) << "EnableDeadlineScheduling must "
+                                             "not be called after the "
+                                             "scheduler has started";
+  ASSIGN_OR_RETURN(SchedulerQueue * queue, GetQueue(name));
+  queue->EnableDeadlineScheduling();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<SchedulerQueue*> Scheduler::GetQueue(const std::string& name) {
+  if (name.empty()) {
+    return &default_queue_;
+  }
+  auto iter = non_default_queues_.find(name);
+  RET_CHECK(iter != non_default_queues_.end())
+      << "No scheduler queue for the executor \"" << name << "\"";
+  return iter->second.get();
+}
+
 void Scheduler::SetQueuesRunning(bool running) {
   for (auto queue : scheduler_queues_) {
     queue->SetRunning(running);
@@ -517,6 +547,11 @@ bool Scheduler::IsTerminated() {
   return state_ == STATE_TERMINATED;
 }
 
+bool Scheduler::IsRunning() {
+  absl::MutexLock lock(&state_mutex_);
+  return state_ != STATE_NOT_STARTED && state_ != STATE_TERMINATED;
+}
+
 void Scheduler::CleanupAfterRun() {
   {
     absl::MutexLock lock(&state_mutex_);
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/framework/scheduler_queue.h"
 #include "mediapipe/framework/scheduler_shared.h"
 
@@ -59,6 +60,17 @@ class Scheduler {
   absl::Status SetNonDefaultExecutor(const std::string& name,
                                      Executor* executor);
 
+  // Switches the scheduler queue of the executor named |name| to work stealing
+  // with |num_workers| per-worker queues. The name "" refers to the default
+  // executor. Must be called after the executor is set and before the
+  // scheduler is started.
+  absl::Status EnableWorkStealing(const std::string& name, int num_workers);
+
+  // Switches the scheduler queue of the executor named |name| to earliest
+  // deadline first ordering. The name "" refers to the default executor. Must
+  // be called after the executor is set and before the scheduler is started.
+  absl::Status EnableDeadlineScheduling(const std::string& name);
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
@@ -142,6 +154,9 @@ class Scheduler {
   // Returns true if scheduler is terminated.
   bool IsTerminated() ABSL_LOCKS_EXCLUDED(state_mutex_);
 
+  // Returns true if scheduler is started and not terminated.
+  bool IsRunning() ABSL_LOCKS_EXCLUDED(state_mutex_);
+
   // Cleanup any remaining state after the run.
   void CleanupAfterRun();
 
@@ -206,6 +221,9 @@ class Scheduler {
     }
   };
 
+  // Returns the scheduler queue of the executor named |name|.
+  absl::StatusOr<SchedulerQueue*> GetQueue(const std::string& name);
+
   // Start (or resume) or stop all queues.
   void SetQueuesRunning(bool running);
 
@@ -14,11 +14,17 @@
 
 #include "mediapipe/framework/scheduler_queue.h"
 
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <queue>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -67,6 +73,19 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
     // If both are OpenNode(), higher ids run after lower ids.
     return id_ > that.id_;
   }
+  if (has_deadline_ || that.has_deadline_) {
+    // Items without a deadline run after items with a deadline.
+    if (!that.has_deadline_) return false;
+    if (!has_deadline_) return true;
+    // Late items run after items that are on time.
+    if (is_late_ != that.is_late_) return is_late_;
+    if (deadline_ != that.deadline_) {
+      // On time items run earliest deadline first, and late items run latest
+      // deadline first, so that fresh frames are not stuck behind stale ones.
+      return is_late_ ? deadline_ < that.deadline_ : deadline_ > that.deadline_;
+    }
+    return id_ < that.id_;
+  }
   if (is_source_) {
     // Sources run after non-sources.
     if (!that.is_source_) return true;
@@ -86,15 +105,70 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   }
 }
 
+namespace {
+
+// Returns a new identifier for a SchedulerQueue.
+int64 NextQueueId() {
+  static std::atomic<int64> next_queue_id(0);
+  return next_queue_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The maximum number of nodes run inline by one task. Once it is reached,
+// inline nodes are queued as usual, so that a long chain of inline nodes
+// cannot hold a thread indefinitely.
+constexpr int kMaxInlineRunsPerTask = 64;
+
+// The inline nodes to be run by the task on the calling thread.
+struct InlineRunState {
+  SchedulerQueue* queue = nullptr;
+  std::deque<SchedulerQueue::Item> items;
+  int num_items = 0;
+};
+
+thread_local InlineRunState* inline_run_state = nullptr;
+
+}  // namespace
+
+SchedulerQueue::SchedulerQueue(SchedulerShared* shared)
+    : id_(NextQueueId()), shared_(shared) {}
+
 void SchedulerQueue::Reset() {
   absl::MutexLock lock(&mutex_);
   num_pending_tasks_ = 0;
   num_tasks_to_add_ = 0;
   running_count_ = 0;
+  is_running_ = false;
+  num_unfinished_items_ = 0;
+  num_waiting_tasks_ = 0;
+  newest_timestamp_ = std::numeric_limits<int64>::min();
 }
 
 void SchedulerQueue::SetExecutor(Executor* executor) { executor_ = executor; }
 
+void SchedulerQueue::EnableWorkStealing(int num_workers) {
+  CHECK_GT(num_workers, 0);
+  worker_queues_.clear();
+  for (int i = 0; i < num_workers; ++i) {
+    worker_queues_.push_back(absl::make_unique<WorkerQueue>());
+  }
+}
+
+int SchedulerQueue::CurrentWorkerIndex() {
+  // A thread usually keeps working on the same queue, so its index is cached
+  // to avoid locking worker_index_mutex_ on every item.
+  thread_local int64 cached_queue_id = -1;
+  thread_local int cached_index = 0;
+  if (cached_queue_id != id_) {
+    absl::MutexLock lock(&worker_index_mutex_);
+    const int next_index = worker_indices_.size();
+    cached_index =
+        worker_indices_.emplace(std::this_thread::get_id(), next_index)
+            .first->second;
+    cached_queue_id = id_;
+  }
+  return cached_index % worker_queues_.size();
+}
+
 bool SchedulerQueue::IsIdle() {
   VLOG(3) << "Scheduler queue empty: " << queue_.empty()
           << ", # of pending tasks: " << num_pending_tasks_;
@@ -105,6 +179,7 @@ void SchedulerQueue::SetRunning(bool running) {
   absl::MutexLock lock(&mutex_);
   running_count_ += running ? 1 : -1;
   DCHECK_LE(running_count_, 1);
+  is_running_ = running_count_ > 0;
 }
 
 void SchedulerQueue::AddNode(CalculatorNode* node, CalculatorContext* cc) {
@@ -120,7 +195,45 @@ void SchedulerQueue::AddNode(CalculatorNode* node, CalculatorContext* cc) {
     CHECK(node->IsSource()) << node->DebugName();
     return;
   }
-  AddItemToQueue(Item(node, cc));
+  Item item(node, cc);
+  if (uses_deadlines_) {
+    AssignDeadline(&item);
+  }
+  // An inline node is run by the task of this queue on the calling thread.
+  // That task is still pending, so the queue cannot become idle before the
+  // inline node runs.
+  InlineRunState* state = inline_run_state;
+  if (node->RunsInline() && !node->IsSource() && state != nullptr &&
+      state->queue == this && is_running_ &&
+      state->num_items < kMaxInlineRunsPerTask) {
+    VLOG(4) << node->DebugName() << " will run inline.";
+    ++state->num_items;
+    state->items.push_back(std::move(item));
+    return;
+  }
+  AddItemToQueue(std::move(item));
+}
+
+void SchedulerQueue::AssignDeadline(Item* item) {
+  const CalculatorNode* node = item->Node();
+  const Timestamp input_timestamp = item->Context()->InputTimestamp();
+  if (node->IsSource() || !input_timestamp.IsRangeValue()) {
+    return;
+  }
+  const int64 timestamp = input_timestamp.Value();
+  int64 newest = newest_timestamp_.load(std::memory_order_relaxed);
+  while (timestamp > newest &&
+         !newest_timestamp_.compare_exchange_weak(newest, timestamp,
+                                                  std::memory_order_relaxed)) {
+  }
+  newest = std::max(newest, timestamp);
+  const int64 budget = node->latency_budget_usec();
+  if (budget <= 0) {
+    return;
+  }
+  const int64 deadline =
+      timestamp + std::min(budget, Timestamp::Max().Value() - timestamp);
+  item->SetDeadline(deadline, /*is_late=*/deadline < newest);
 }
 
 void SchedulerQueue::AddNodeForOpen(CalculatorNode* node) {
@@ -131,6 +244,10 @@ void SchedulerQueue::AddNodeForOpen(CalculatorNode* node) {
 }
 
 void SchedulerQueue::AddItemToQueue(Item&& item) {
+  if (UsesWorkStealing()) {
+    AddItemToWorkerQueue(std::move(item));
+    return;
+  }
   const CalculatorNode* node = item.Node();
   bool was_idle;
   int tasks_to_add = 0;
@@ -161,6 +278,50 @@ void SchedulerQueue::AddItemToQueue(Item&& item) {
   }
 }
 
+void SchedulerQueue::AddItemToWorkerQueue(Item&& item) {
+  const CalculatorNode* node = item.Node();
+  // The item is counted before it becomes visible to other threads, so that
+  // no thread can finish running it and report the queue idle before the
+  // queue has been reported active.
+  bool was_idle = num_unfinished_items_.fetch_add(1) == 0;
+  WorkerQueue& worker_queue = *worker_queues_[CurrentWorkerIndex()];
+  {
+    absl::MutexLock lock(&worker_queue.mutex);
+    worker_queue.queue.push(std::move(item));
+  }
+  VLOG(4) << node->DebugName() << " was added to the scheduler queue.";
+  // Pairs with the increment of num_waiting_workers_ in
+  // TakeItemFromWorkerQueues: either the waiting thread finds the item, or
+  // it is woken up here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_waiting_workers_.load() > 0) {
+    absl::MutexLock lock(&wait_mutex_);
+    item_pushed_.SignalAll();
+  }
+
+  int tasks_to_add = 0;
+  if (is_running_) {
+    tasks_to_add = 1;
+  } else {
+    ++num_waiting_tasks_;
+    // SetRunning(true) may have happened after the check above, and
+    // SubmitWaitingTasksToExecutor may have missed our task.
+    if (is_running_) {
+      tasks_to_add = num_waiting_tasks_.exchange(0);
+    }
+  }
+  if (was_idle && idle_callback_) {
+    // Became not idle.
+    idle_callback_(false);
+  }
+  // Note: this should be done after calling idle_callback_(false) above.
+  // See the comments on SetIdleCallback for details.
+  while (tasks_to_add > 0) {
+    executor_->AddTask(this);
+    --tasks_to_add;
+  }
+}
+
 int SchedulerQueue::GetTasksToSubmitToExecutor() {
   int tasks_to_add = num_tasks_to_add_;
   num_tasks_to_add_ = 0;
@@ -176,7 +337,8 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
   {
     absl::MutexLock lock(&mutex_);
     if (running_count_ > 0) {
-      tasks_to_add = GetTasksToSubmitToExecutor();
+      tasks_to_add = UsesWorkStealing() ? num_waiting_tasks_.exchange(0)
+                                        : GetTasksToSubmitToExecutor();
     }
   }
   while (tasks_to_add > 0) {
@@ -186,23 +348,88 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
 }
 
 void SchedulerQueue::RunNextTask() {
-  CalculatorNode* node;
-  CalculatorContext* calculator_context;
-  bool is_open_node;
+  if (UsesWorkStealing()) {
+    RunNextWorkerTask();
+    return;
+  }
+  RunItem(TakeItemFromQueue());
+
+  bool is_idle;
   {
     absl::MutexLock lock(&mutex_);
+    DCHECK_GT(num_pending_tasks_, 0);
+    --num_pending_tasks_;
+    is_idle = IsIdle();
+  }
+  if (is_idle && idle_callback_) {
+    // Became idle.
+    idle_callback_(true);
+  }
+}
 
-    CHECK(!queue_.empty()) << "Called RunNextTask when the queue is empty. "
-                              "This should not happen.";
+SchedulerQueue::Item SchedulerQueue::TakeItemFromQueue() {
+  absl::MutexLock lock(&mutex_);
+  CHECK(!queue_.empty()) << "Called RunNextTask when the queue is empty. "
+                            "This should not happen.";
+  Item item = queue_.top();
+  queue_.pop();
+  return item;
+}
 
-    node = queue_.top().Node();
-    calculator_context = queue_.top().Context();
-    is_open_node = queue_.top().IsOpenNode();
-    queue_.pop();
+SchedulerQueue::Item SchedulerQueue::TakeItemFromWorkerQueues() {
+  const int own_index = CurrentWorkerIndex();
+  absl::optional<Item> item = TryTakeItemFromWorkerQueues(own_index);
+  if (item) {
+    return *std::move(item);
+  }
+  // Each task is submitted after its item has been pushed, so an item is
+  // available for every task. A single pass can still miss it if the item is
+  // pushed to a queue that was already visited while another task takes an
+  // item from a queue that was not visited yet. Such a push happens after
+  // the pass, so the thread waits for it instead of spinning.
+  absl::MutexLock lock(&wait_mutex_);
+  num_waiting_workers_.fetch_add(1);
+  while (!(item = TryTakeItemFromWorkerQueues(own_index))) {
+    item_pushed_.Wait(&wait_mutex_);
+  }
+  num_waiting_workers_.fetch_sub(1);
+  return *std::move(item);
+}
 
-    CHECK(!node->Closed())
-        << "Scheduled a node that was closed. This should not happen.";
+absl::optional<SchedulerQueue::Item>
+SchedulerQueue::TryTakeItemFromWorkerQueues(int own_index) {
+  const int num_workers = worker_queues_.size();
+  for (int i = 0; i < num_workers; ++i) {
+    WorkerQueue& worker_queue = *worker_queues_[(own_index + i) % num_workers];
+    absl::MutexLock lock(&worker_queue.mutex);
+    if (!worker_queue.queue.empty()) {
+      Item item = worker_queue.queue.top();
+      worker_queue.queue.pop();
+      return item;
+    }
   }
+  return absl::nullopt;
+}
+
+void SchedulerQueue::RunNextWorkerTask() {
+  RunItem(TakeItemFromWorkerQueues());
+
+  if (num_unfinished_items_.fetch_sub(1) == 1 && idle_callback_) {
+    // Became idle.
+    idle_callback_(true);
+  }
+}
+
+void SchedulerQueue::RunItem(const Item& item) {
+  CHECK(!item.Node()->Closed())
+      << "Scheduled a node that was closed. This should not happen.";
+
+  // Executors may run tasks from another queue on this thread while a node
+  // runs, so the enclosing task's inline state is restored afterwards.
+  InlineRunState state;
+  state.queue = this;
+  InlineRunState* const enclosing_state = inline_run_state;
+  inline_run_state = &state;
 
   // On iOS, calculators may rely on the existence of an autorelease pool
   // (either directly, or because system code they call does). We do not
@@ -210,25 +437,24 @@ void SchedulerQueue::RunNextTask() {
   // an executor creating standard pthread will not, by default), so we
   // do it here to ensure all executors are covered.
   AUTORELEASEPOOL {
-    if (is_open_node) {
-      DCHECK(!calculator_context);
-      OpenCalculatorNode(node);
+    if (item.IsOpenNode()) {
+      DCHECK(!item.Context());
+      OpenCalculatorNode(item.Node());
     } else {
-      RunCalculatorNode(node, calculator_context);
+      RunCalculatorNode(item.Node(), item.Context());
+    }
+    // Each inline node runs after the node that made it ready has finished,
+    // and may make further inline nodes ready.
+    while (!state.items.empty()) {
+      Item inline_item = std::move(state.items.front());
+      state.items.pop_front();
+      CHECK(!inline_item.Node()->Closed())
+          << "Scheduled a node that was closed. This should not happen.";
+      RunCalculatorNode(inline_item.Node(), inline_item.Context());
     }
   }
 
-  bool is_idle;
-  {
-    absl::MutexLock lock(&mutex_);
-    DCHECK_GT(num_pending_tasks_, 0);
-    --num_pending_tasks_;
-    is_idle = IsIdle();
-  }
-  if (is_idle && idle_callback_) {
-    // Became idle.
-    idle_callback_(true);
-  }
+  inline_run_state = enclosing_state;
 }
 
 void SchedulerQueue::RunCalculatorNode(CalculatorNode* node,
@@ -296,7 +522,20 @@ void SchedulerQueue::OpenCalculatorNode(CalculatorNode* node) {
 
 void SchedulerQueue::CleanupAfterRun() {
   bool was_idle;
-  {
+  if (UsesWorkStealing()) {
+    const int num_unfinished_items = num_unfinished_items_.load();
+    was_idle = num_unfinished_items == 0;
+    // Only items that were never submitted to the executor can remain.
+    CHECK_EQ(num_waiting_tasks_.load(), num_unfinished_items);
+    num_waiting_tasks_ = 0;
+    num_unfinished_items_ = 0;
+    for (auto& worker_queue : worker_queues_) {
+      absl::MutexLock lock(&worker_queue->mutex);
+      while (!worker_queue->queue.empty()) {
+        worker_queue->queue.pop();
+      }
+    }
+  } else {
     absl::MutexLock lock(&mutex_);
     was_idle = IsIdle();
     CHECK_EQ(num_pending_tasks_, 0);
@@ -17,12 +17,17 @@
 
 #include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <queue>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -55,6 +60,15 @@ class SchedulerQueue : public TaskQueue {
 
     bool IsOpenNode() const { return is_open_node_; }
 
+    // Gives the item a deadline for EARLIEST_DEADLINE_FIRST scheduling.
+    // |is_late| indicates that the deadline had already passed by the graph
+    // clock when the item was scheduled.
+    void SetDeadline(int64 deadline, bool is_late) {
+      deadline_ = deadline;
+      has_deadline_ = true;
+      is_late_ = is_late;
+    }
+
     // This comparison is meant to be used with a std::priority_queue. Since
     // the priority queue returns higher priority items first, this function
     // means "this is lower priority than that", i.e. "this runs after that".
@@ -64,19 +78,25 @@ class SchedulerQueue : public TaskQueue {
     //   node id: smaller ids run first, since they come earlier in the config.
     // - Non-sources are sorted by node id: larger ids run first, because they
     //   are closer to the leaves.
+    // Items with deadlines run before all other items except OpenNode():
+    // - Items that are on time run first, earliest deadline first.
+    // - Late items run next, latest deadline first.
     bool operator<(const Item& that) const;
 
    private:
     int64 source_process_order_ = 0;
+    int64 deadline_ = 0;
     CalculatorNode* node_;
     CalculatorContext* cc_;
     int id_ = 0;
     int layer_ = 0;
     bool is_source_ = false;
     bool is_open_node_ = false;  // True if the task should run OpenNode().
+    bool has_deadline_ = false;
+    bool is_late_ = false;
   };
 
-  explicit SchedulerQueue(SchedulerShared* shared) : shared_(shared) {}
+  explicit SchedulerQueue(SchedulerShared* shared);
 
   // Sets the executor that will run the nodes. Must be called before the
   // scheduler is started.
@@ -96,6 +116,20 @@ class SchedulerQueue : public TaskQueue {
     idle_callback_ = std::move(callback);
   }
 
+  // Replaces the shared priority queue with |num_workers| per-worker priority
+  // queues. A task runs the highest priority item from the queue owned by its
+  // thread, and steals from the other queues when that one is empty. Must be
+  // called before the scheduler is started.
+  void EnableWorkStealing(int num_workers);
+
+  // Returns true if EnableWorkStealing has been called.
+  bool UsesWorkStealing() const { return !worker_queues_.empty(); }
+
+  // Orders nodes with a latency budget earliest deadline first. See
+  // ExecutorConfig::EARLIEST_DEADLINE_FIRST. Must be called before the
+  // scheduler is started.
+  void EnableDeadlineScheduling() { uses_deadlines_ = true; }
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
@@ -121,6 +155,9 @@ class SchedulerQueue : public TaskQueue {
   // not already running. Note that if the node was running, then it will be
   // rescheduled upon completion (after checking dependencies), so this call is
   // not lost.
+  // If the node runs inline (see CalculatorContract::SetRunInline) and the
+  // calling thread is running a task of this queue, the node is not queued.
+  // Instead, it runs on the calling thread once the current node finishes.
   void AddNode(CalculatorNode* node, CalculatorContext* cc)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
@@ -133,6 +170,10 @@ class SchedulerQueue : public TaskQueue {
   void CleanupAfterRun() ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
+  // Used internally by RunNextTask and RunNextWorkerTask. Runs the item's node,
+  // then the inline nodes it made ready.
+  void RunItem(const Item& item) ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Used internally by RunNextTask. Invokes ProcessNode or CloseNode, followed
   // by EndScheduling.
   void RunCalculatorNode(CalculatorNode* node, CalculatorContext* cc)
@@ -142,9 +183,33 @@ class SchedulerQueue : public TaskQueue {
   // CheckIfBecameReady.
   void OpenCalculatorNode(CalculatorNode* node) ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Sets the deadline of an item whose node has a latency budget, and
+  // advances the graph clock to the item's input timestamp.
+  void AssignDeadline(Item* item);
+
   // Checks whether the queue has no queued nodes or pending tasks.
   bool IsIdle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Removes and returns the highest priority item from queue_.
+  Item TakeItemFromQueue() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Work stealing counterparts of AddItemToQueue and RunNextTask. They do not
+  // acquire mutex_.
+  void AddItemToWorkerQueue(Item&& item);
+  void RunNextWorkerTask();
+
+  // Removes and returns the next item for the calling thread, stealing from
+  // other worker queues if the thread's own queue is empty. Blocks until an
+  // item is pushed if all worker queues are empty.
+  Item TakeItemFromWorkerQueues();
+
+  // Makes one pass over the worker queues, starting with the queue at
+  // |own_index|, and removes the first item found.
+  absl::optional<Item> TryTakeItemFromWorkerQueues(int own_index);
+
+  // Returns the index of the worker queue owned by the calling thread.
+  int CurrentWorkerIndex();
+
   Executor* executor_ = nullptr;
 
   IdleCallback idle_callback_;
@@ -165,6 +230,50 @@ class SchedulerQueue : public TaskQueue {
   // Queue of nodes that need to be run.
   std::priority_queue<Item> queue_ ABSL_GUARDED_BY(mutex_);
 
+  // A per-worker queue used in work stealing mode.
+  struct WorkerQueue {
+    absl::Mutex mutex;
+    std::priority_queue<Item> queue ABSL_GUARDED_BY(mutex);
+  };
+
+  // Per-worker queues. Empty unless work stealing is enabled.
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+
+  // Identifies this queue in the per-thread cache of CurrentWorkerIndex.
+  const int64 id_;
+
+  // Work stealing mode only. The index of each thread that has used this
+  // queue, in the order of first use. A thread owns the worker queue at its
+  // index modulo the number of worker queues.
+  absl::Mutex worker_index_mutex_;
+  absl::flat_hash_map<std::thread::id, int> worker_indices_
+      ABSL_GUARDED_BY(worker_index_mutex_);
+
+  // Work stealing mode only. Threads that found all worker queues empty wait
+  // on item_pushed_ until another item is pushed.
+  absl::Mutex wait_mutex_;
+  absl::CondVar item_pushed_;
+  std::atomic<int> num_waiting_workers_{0};
+
+  // Mirrors running_count_ > 0 so that the work stealing path can check it
+  // without acquiring mutex_.
+  std::atomic<bool> is_running_{false};
+
+  // Work stealing mode only. Number of items added and not yet finished
+  // running. The queue is idle when this reaches 0.
+  std::atomic<int> num_unfinished_items_{0};
+
+  // Work stealing mode only. Number of tasks that were added while the queue
+  // was not running and still need to be submitted to the executor.
+  std::atomic<int> num_waiting_tasks_{0};
+
+  // True if nodes are ordered by deadline.
+  bool uses_deadlines_ = false;
+
+  // The graph clock for deadline scheduling: the newest input timestamp
+  // scheduled on this queue.
+  std::atomic<int64> newest_timestamp_{std::numeric_limits<int64>::min()};
+
   SchedulerShared* const shared_;
 
   absl::Mutex mutex_;
@@ -0,0 +1,336 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Tests and benchmarks for the scheduler queue types.
+// $ bazel run -c opt mediapipe/framework:scheduler_queue_test -- \
+//   --benchmark_filter=all
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Passes its input packets through like PassThroughCalculator, but is not
+// run inline, so that every node goes through the scheduler queue.
+class QueuedPassThroughCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->SetTimestampOffset(0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(QueuedPassThroughCalculator);
+
+// Returns a graph with |num_chains| independent chains of |chain_length|
+// pass through calculators, all fed from the graph input stream "input". The
+// output of chain i is "out_i". The calculators run inline if |run_inline| is
+// true, and are queued otherwise.
+CalculatorGraphConfig MakeChainsConfig(int num_chains, int chain_length,
+                                       int num_threads,
+                                       ExecutorConfig::QueueType queue_type,
+                                       bool run_inline = false) {
+  CalculatorGraphConfig config;
+  config.add_input_stream("input");
+  for (int c = 0; c < num_chains; ++c) {
+    std::string previous = "input";
+    for (int n = 0; n < chain_length; ++n) {
+      std::string output = n + 1 == chain_length
+                               ? absl::StrCat("out_", c)
+                               : absl::StrCat("chain_", c, "_", n);
+      auto* node = config.add_node();
+      node->set_calculator(run_inline ? "PassThroughCalculator"
+                                      : "QueuedPassThroughCalculator");
+      node->add_input_stream(previous);
+      node->add_output_stream(output);
+      previous = output;
+    }
+  }
+  ExecutorConfig* executor = config.add_executor();
+  executor->set_queue_type(queue_type);
+  executor->mutable_options()
+      ->MutableExtension(ThreadPoolExecutorOptions::ext)
+      ->set_num_threads(num_threads);
+  return config;
+}
+
+TEST(SchedulerQueueTest, WorkStealingDeliversAllPacketsInOrder) {
+  constexpr int kNumChains = 8;
+  constexpr int kChainLength = 5;
+  constexpr int kNumPackets = 100;
+  CalculatorGraphConfig config = MakeChainsConfig(
+      kNumChains, kChainLength, /*num_threads=*/4, ExecutorConfig::WORK_STEALING);
+  std::vector<std::vector<Packet>> outputs(kNumChains);
+  for (int c = 0; c < kNumChains; ++c) {
+    tool::AddVectorSink(absl::StrCat("out_", c), &config, &outputs[c]);
+  }
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  // Runs the graph twice to exercise Reset and CleanupAfterRun.
+  for (int run = 0; run < 2; ++run) {
+    MP_ASSERT_OK(graph.StartRun({}));
+    for (int i = 0; i < kNumPackets; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "input", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    MP_ASSERT_OK(graph.WaitUntilDone());
+
+    for (int c = 0; c < kNumChains; ++c) {
+      ASSERT_EQ(kNumPackets, outputs[c].size());
+      for (int i = 0; i < kNumPackets; ++i) {
+        EXPECT_EQ(i, outputs[c][i].Get<int>());
+        EXPECT_EQ(Timestamp(i), outputs[c][i].Timestamp());
+      }
+      outputs[c].clear();
+    }
+  }
+}
+
+TEST(SchedulerQueueTest, WorkStealingWaitUntilIdle) {
+  CalculatorGraphConfig config = MakeChainsConfig(
+      /*num_chains=*/4, /*chain_length=*/3, /*num_threads=*/2,
+      ExecutorConfig::WORK_STEALING);
+  std::vector<Packet> output;
+  tool::AddVectorSink("out_0", &config, &output);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    EXPECT_EQ(i + 1, output.size());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// An executor that runs tasks only when RunPendingTasks() is called, so that
+// the tasks queued up to that point run in scheduler priority order.
+class ManualExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  void RunPendingTasks() {
+    while (!tasks_.empty()) {
+      std::function<void()> task = std::move(tasks_.front());
+      tasks_.pop_front();
+      task();
+      ++num_tasks_run_;
+    }
+  }
+
+  int num_tasks_run() const { return num_tasks_run_; }
+
+ private:
+  std::deque<std::function<void()>> tasks_;
+  int num_tasks_run_ = 0;
+};
+
+// Appends its node name to the std::vector<std::string>* input side packet
+// for each Process() call.
+class RecordOrderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->InputSidePackets().Index(0).Set<std::vector<std::string>*>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    cc->InputSidePackets().Index(0).Get<std::vector<std::string>*>()->push_back(
+        cc->NodeName());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(RecordOrderCalculator);
+
+// Runs "a" on input timestamp |a_timestamp| and "b" on |b_timestamp|, with
+// packets added to "b" first, and returns the order in which they ran.
+std::vector<std::string> RunNodesInOrder(
+    ExecutorConfig::SchedulingPolicy policy, int64 a_budget, int64 b_budget,
+    int64 a_timestamp, int64 b_timestamp) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in_a"
+        input_stream: "in_b"
+        input_side_packet: "order"
+        node {
+          name: "b"
+          calculator: "RecordOrderCalculator"
+          input_stream: "in_b"
+          input_side_packet: "order"
+        }
+        node {
+          name: "a"
+          calculator: "RecordOrderCalculator"
+          input_stream: "in_a"
+          input_side_packet: "order"
+        }
+      )pb");
+  config.mutable_node(0)->set_latency_budget_usec(b_budget);
+  config.mutable_node(1)->set_latency_budget_usec(a_budget);
+  config.add_executor()->set_scheduling_policy(policy);
+
+  auto executor = std::make_shared<ManualExecutor>();
+  std::vector<std::string> order;
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.SetExecutor("", executor));
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.StartRun(
+      {{"order", MakePacket<std::vector<std::string>*>(&order)}}));
+  executor->RunPendingTasks();
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "in_b", MakePacket<int>(0).At(Timestamp(b_timestamp))));
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "in_a", MakePacket<int>(0).At(Timestamp(a_timestamp))));
+  executor->RunPendingTasks();
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  executor->RunPendingTasks();
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return order;
+}
+
+TEST(SchedulerQueueTest, EarliestDeadlineFirst) {
+  // By node order, "a" runs first because it is closer to the leaves.
+  EXPECT_THAT(RunNodesInOrder(ExecutorConfig::NODE_ORDER, /*a_budget=*/1000,
+                              /*b_budget=*/10, /*a_timestamp=*/0,
+                              /*b_timestamp=*/0),
+              ElementsAre("a", "b"));
+  // By deadline, "b" runs first because its latency budget is smaller.
+  EXPECT_THAT(RunNodesInOrder(ExecutorConfig::EARLIEST_DEADLINE_FIRST,
+                              /*a_budget=*/1000, /*b_budget=*/10,
+                              /*a_timestamp=*/0, /*b_timestamp=*/0),
+              ElementsAre("b", "a"));
+  // Nodes without a latency budget run after nodes with one.
+  EXPECT_THAT(RunNodesInOrder(ExecutorConfig::EARLIEST_DEADLINE_FIRST,
+                              /*a_budget=*/0, /*b_budget=*/10,
+                              /*a_timestamp=*/0, /*b_timestamp=*/0),
+              ElementsAre("b", "a"));
+}
+
+TEST(SchedulerQueueTest, LateNodesRunAfterFreshNodes) {
+  // "a" at timestamp 0 is scheduled after the graph has reached timestamp
+  // 5000, past its deadline, so the fresher "b" runs first.
+  EXPECT_THAT(RunNodesInOrder(ExecutorConfig::EARLIEST_DEADLINE_FIRST,
+                              /*a_budget=*/100, /*b_budget=*/100,
+                              /*a_timestamp=*/0, /*b_timestamp=*/5000),
+              ElementsAre("b", "a"));
+  // Without the later frame, "a" is on time and runs first.
+  EXPECT_THAT(RunNodesInOrder(ExecutorConfig::EARLIEST_DEADLINE_FIRST,
+                              /*a_budget=*/100, /*b_budget=*/100,
+                              /*a_timestamp=*/0, /*b_timestamp=*/50),
+              ElementsAre("a", "b"));
+}
+
+TEST(SchedulerQueueTest, InlineNodesRunOnProducerTask) {
+  constexpr int kNumPackets = 10;
+  CalculatorGraphConfig config =
+      MakeChainsConfig(/*num_chains=*/1, /*chain_length=*/3,
+                       /*num_threads=*/1, ExecutorConfig::PRIORITY_QUEUE,
+                       /*run_inline=*/true);
+  config.clear_executor();
+  std::vector<Packet> output;
+  tool::AddVectorSink("out_0", &config, &output);
+
+  auto executor = std::make_shared<ManualExecutor>();
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.SetExecutor("", executor));
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  executor->RunPendingTasks();
+  const int num_open_tasks = executor->num_tasks_run();
+  for (int i = 0; i < kNumPackets; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+    executor->RunPendingTasks();
+  }
+  // The first PassThroughCalculator is scheduled from the application thread,
+  // and the other two run inline on its task. The sink runs on a second task.
+  EXPECT_EQ(2 * kNumPackets, executor->num_tasks_run() - num_open_tasks);
+  ASSERT_EQ(kNumPackets, output.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(i, output[i].Get<int>());
+    EXPECT_EQ(Timestamp(i), output[i].Timestamp());
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  executor->RunPendingTasks();
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Runs 40 lightweight calculators (8 chains of 5) per input packet. Compare
+// throughput across thread counts for both queue types, e.g.
+//   BM_SchedulerQueue/0/32/0 vs. BM_SchedulerQueue/1/32/0.
+// With inline:1, all but the first node of each chain run inline and bypass
+// the queue being compared.
+void BM_SchedulerQueue(benchmark::State& state) {
+  constexpr int kNumPackets = 1000;
+  const auto queue_type = static_cast<ExecutorConfig::QueueType>(state.range(0));
+  const int num_threads = state.range(1);
+  const bool run_inline = state.range(2);
+  CalculatorGraphConfig config =
+      MakeChainsConfig(/*num_chains=*/8, /*chain_length=*/5, num_threads,
+                       queue_type, run_inline);
+  CalculatorGraph graph;
+  CHECK_OK(graph.Initialize(config));
+  for (auto _ : state) {
+    CHECK_OK(graph.StartRun({}));
+    for (int i = 0; i < kNumPackets; ++i) {
+      CHECK_OK(graph.AddPacketToInputStream(
+          "input", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    CHECK_OK(graph.CloseAllInputStreams());
+    CHECK_OK(graph.WaitUntilDone());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPackets);
+}
+BENCHMARK(BM_SchedulerQueue)
+    ->ArgNames({"work_stealing", "threads", "inline"})
+    ->ArgsProduct({{ExecutorConfig::PRIORITY_QUEUE,
+                    ExecutorConfig::WORK_STEALING},
+                   {1, 2, 4, 8, 16, 32},
+                   {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
@@ -65,6 +65,9 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     // implementation of SetLatePreparation.
   }
 
+  // Packets are erased from the input streams outside of PopPacketAtTimestamp.
+  bool SupportsLockFreeInputStreams() const override { return false; }
+
  private:
   // Drops packets if all input streams exceed trigger_queue_size.
   void EraseAllSurplus() ABSL_EXCLUSIVE_LOCKS_REQUIRED(erase_mutex_) {
@@ -83,7 +86,8 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
           std::min(min_timestamp_all_streams, min_timestamp);
     }
     for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(min_timestamp_all_streams);
+      LogDroppedPackets(
+          stream, stream->ErasePacketsEarlierThan(min_timestamp_all_streams));
     }
   }
 
@@ -147,7 +151,8 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
           std::min(kept_timestamp_, PreviousAllowedInStream(MinStreamBound()));
     }
     for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(kept_timestamp_);
+      LogDroppedPackets(stream,
+                        stream->ErasePacketsEarlierThan(kept_timestamp_));
     }
   }
 
@@ -14,10 +14,13 @@
 
 #include "mediapipe/framework/thread_pool_executor.h"
 
+#include <set>
 #include <utility>
 
+#include "absl/strings/str_join.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status_builder.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/util/cpu_util.h"
@@ -59,7 +62,62 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
   if (options.has_thread_name_prefix()) {
     thread_options.set_name_prefix(options.thread_name_prefix());
   }
+  if (options.cpu_id_size() > 0 && options.numa_node_size() > 0) {
+    return absl::InvalidArgumentError(
+        "The cpu_id and numa_node fields in ThreadPoolExecutorOptions cannot "
+        "both be specified.");
+  }
+  if (options.bind_memory_to_numa_node() && options.numa_node_size() == 0) {
+    return absl::InvalidArgumentError(
+        "The bind_memory_to_numa_node field in ThreadPoolExecutorOptions "
+        "requires the numa_node field.");
+  }
+  for (const int cpu_id : options.cpu_id()) {
+    if (cpu_id < 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "The cpu_id field in ThreadPoolExecutorOptions should be "
+                "non-negative but is "
+             << cpu_id;
+    }
+  }
+  for (const int numa_node : options.numa_node()) {
+    if (numa_node < 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "The numa_node field in ThreadPoolExecutorOptions should be "
+                "non-negative but is "
+             << numa_node;
+    }
+  }
 #if defined(__linux__)
+  if (options.cpu_id_size() > 0) {
+    thread_options.set_cpu_set(
+        std::set<int>(options.cpu_id().begin(), options.cpu_id().end()));
+    return new ThreadPoolExecutor(thread_options, options.num_threads());
+  }
+  if (options.numa_node_size() > 0) {
+    const std::set<int> numa_nodes(options.numa_node().begin(),
+                                   options.numa_node().end());
+    ASSIGN_OR_RETURN(std::set<int> cpu_set, NumaNodeCoreIds(numa_nodes));
+    // Memory-only NUMA nodes, such as high bandwidth memory or CXL memory
+    // expanders, have an empty CPU list. An empty cpu_set leaves the threads
+    // unpinned, which is only useful when the memory is bound to the nodes.
+    if (cpu_set.empty()) {
+      if (!options.bind_memory_to_numa_node()) {
+        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+               << "The NUMA nodes " << absl::StrJoin(numa_nodes, ", ")
+               << " in ThreadPoolExecutorOptions have no CPUs to pin the "
+                  "threads to.";
+      }
+      LOG(WARNING) << "The NUMA nodes " << absl::StrJoin(numa_nodes, ", ")
+                   << " have no CPUs. The thread pool executor binds its "
+                      "memory to them but does not pin its threads.";
+    }
+    thread_options.set_cpu_set(cpu_set);
+    if (options.bind_memory_to_numa_node()) {
+      thread_options.set_numa_node_set(numa_nodes);
+    }
+    return new ThreadPoolExecutor(thread_options, options.num_threads());
+  }
   switch (options.require_processor_performance()) {
     case ThreadPoolExecutorOptions::LOW:
       thread_options.set_cpu_set(InferLowerCoreIds());
@@ -70,6 +128,12 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
     default:
       break;
   }
+#else
+  if (options.cpu_id_size() > 0 || options.numa_node_size() > 0) {
+    LOG(WARNING) << "The cpu_id and numa_node fields in "
+                    "ThreadPoolExecutorOptions are only supported on Linux "
+                    "and are ignored.";
+  }
 #endif
   return new ThreadPoolExecutor(thread_options, options.num_threads());
 }
@@ -0,0 +1,103 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/timestamp_arena.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The number of unused blocks kept for reuse. Roughly the number of
+// timestamps expected to be in flight at once.
+constexpr int kMaxFreeBlocks = 16;
+
+}  // namespace
+
+const GraphService<TimestampArenaPool> kTimestampArenaService(
+    "timestamp_arena_service");
+
+TimestampArenaPool::TimestampArenaPool(size_t block_size)
+    : block_size_(block_size) {}
+
+TimestampArenaPool::~TimestampArenaPool() = default;
+
+std::shared_ptr<proto_ns::Arena> TimestampArenaPool::GetArena(
+    Timestamp timestamp) {
+  absl::MutexLock lock(&mutex_);
+  auto it = arenas_.find(timestamp);
+  if (it != arenas_.end()) {
+    if (auto arena = it->second.lock()) {
+      return arena;
+    }
+  }
+  // Drops the entries of arenas that have been freed.
+  for (auto entry = arenas_.begin(); entry != arenas_.end();) {
+    if (entry->second.expired()) {
+      entry = arenas_.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+
+  char* block = AcquireBlock();
+  proto_ns::ArenaOptions options;
+  options.initial_block = block;
+  options.initial_block_size = block_size_;
+  options.start_block_size = block_size_;
+  // The arena does not own its initial block, so the deleter hands it back
+  // to the pool once the arena is destroyed.
+  std::shared_ptr<proto_ns::Arena> arena(
+      new proto_ns::Arena(options),
+      [pool = weak_from_this(), block](proto_ns::Arena* arena) {
+        delete arena;
+        if (auto locked_pool = pool.lock()) {
+          locked_pool->ReleaseBlock(block);
+        } else {
+          delete[] block;
+        }
+      });
+  arenas_[timestamp] = arena;
+  return arena;
+}
+
+int TimestampArenaPool::NumLiveArenas() {
+  absl::MutexLock lock(&mutex_);
+  int count = 0;
+  for (const auto& entry : arenas_) {
+    if (!entry.second.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+char* TimestampArenaPool::AcquireBlock() {
+  if (free_blocks_.empty()) {
+    return new char[block_size_];
+  }
+  char* block = free_blocks_.back().release();
+  free_blocks_.pop_back();
+  return block;
+}
+
+void TimestampArenaPool::ReleaseBlock(char* block) {
+  absl::MutexLock lock(&mutex_);
+  if (free_blocks_.size() >= kMaxFreeBlocks) {
+    delete[] block;
+    return;
+  }
+  free_blocks_.emplace_back(block);
+}
+
+}  // namespace mediapipe
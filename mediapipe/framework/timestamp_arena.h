@@ -0,0 +1,138 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TIMESTAMP_ARENA_H_
+#define MEDIAPIPE_FRAMEWORK_TIMESTAMP_ARENA_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/arena.h"
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/calculator_contract.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/proto_ns.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Hands out protobuf Arenas scoped to a timestamp. All callers asking for
+// the same timestamp share one arena while any reference to it is alive.
+// Messages created through NewMessage() keep their arena alive, so the arena
+// and everything on it is freed in bulk once the last packet at that
+// timestamp is released. The first block of each arena is recycled, so
+// per-frame protos that fit in it need no heap allocation in steady state.
+//
+// To enable it, set a pool on the graph before starting it:
+//   graph.SetServiceObject(kTimestampArenaService,
+//                          std::make_shared<TimestampArenaPool>());
+// The pool must be owned by a std::shared_ptr for blocks to be recycled.
+//
+// This class is thread-safe.
+class TimestampArenaPool
+    : public std::enable_shared_from_this<TimestampArenaPool> {
+ public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024;
+
+  explicit TimestampArenaPool(size_t block_size = kDefaultBlockSize);
+  ~TimestampArenaPool();
+
+  TimestampArenaPool(const TimestampArenaPool&) = delete;
+  TimestampArenaPool& operator=(const TimestampArenaPool&) = delete;
+
+  // Returns the arena for |timestamp|, creating it if no reference to it is
+  // alive.
+  std::shared_ptr<proto_ns::Arena> GetArena(Timestamp timestamp);
+
+  // Creates a message of type T on the arena for |timestamp| and returns a
+  // Packet at |timestamp| that owns it. The message is returned in
+  // |message| so that the caller can fill it in before sending the packet.
+  template <typename T>
+  Packet NewMessage(Timestamp timestamp, T** message);
+
+  // Returns the number of arenas that are still referenced.
+  int NumLiveArenas();
+
+ private:
+  char* AcquireBlock() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ReleaseBlock(char* block);
+
+  const size_t block_size_;
+  absl::Mutex mutex_;
+  std::map<Timestamp, std::weak_ptr<proto_ns::Arena>> arenas_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<char[]>> free_blocks_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Graph service providing a TimestampArenaPool.
+extern const GraphService<TimestampArenaPool> kTimestampArenaService;
+
+// Requests the optional kTimestampArenaService. Call from GetContract (or
+// UpdateContract) of calculators that use NewOutputMessage.
+inline void UseTimestampArena(CalculatorContract* cc) {
+  cc->UseService(kTimestampArenaService).Optional();
+}
+
+// Returns a new message of type T for an output packet at the input
+// timestamp of |cc|, and stores the owning packet in |packet|. The message
+// is placed on the timestamp arena if the graph provides
+// kTimestampArenaService, and on the heap otherwise.
+template <typename T>
+T* NewOutputMessage(CalculatorContext* cc, Packet* packet);
+
+//// Implementation details.
+namespace packet_internal {
+
+// Holds a message that lives on an arena, and keeps the arena alive.
+template <typename T>
+class ArenaHolder : public ForeignHolder<T> {
+ public:
+  ArenaHolder(const T* ptr, std::shared_ptr<proto_ns::Arena> arena)
+      : ForeignHolder<T>(ptr), arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<proto_ns::Arena> arena_;
+};
+
+}  // namespace packet_internal
+
+template <typename T>
+Packet TimestampArenaPool::NewMessage(Timestamp timestamp, T** message) {
+  std::shared_ptr<proto_ns::Arena> arena = GetArena(timestamp);
+  *message = proto_ns::Arena::CreateMessage<T>(arena.get());
+  return packet_internal::Create(
+      new packet_internal::ArenaHolder<T>(*message, std::move(arena)),
+      timestamp);
+}
+
+template <typename T>
+T* NewOutputMessage(CalculatorContext* cc, Packet* packet) {
+  T* message;
+  auto pool = cc->Service(kTimestampArenaService);
+  if (pool.IsAvailable()) {
+    *packet = pool.GetObject().NewMessage(cc->InputTimestamp(), &message);
+  } else {
+    message = new T;
+    *packet = Adopt(message).At(cc->InputTimestamp());
+  }
+  return message;
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TIMESTAMP_ARENA_H_
@@ -0,0 +1,169 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/timestamp_arena.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Outputs a PacketTestProto holding the input int, using NewOutputMessage.
+class IntToProtoCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<PacketTestProto>();
+    UseTimestampArena(cc);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    Packet packet;
+    PacketTestProto* proto = NewOutputMessage<PacketTestProto>(cc, &packet);
+    proto->add_x(cc->Inputs().Index(0).Get<int>());
+    cc->Outputs().Index(0).AddPacket(std::move(packet));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(IntToProtoCalculator);
+
+TEST(TimestampArenaTest, SharesArenaPerTimestamp) {
+  auto pool = std::make_shared<TimestampArenaPool>();
+  std::shared_ptr<proto_ns::Arena> arena1 = pool->GetArena(Timestamp(1));
+  EXPECT_EQ(arena1, pool->GetArena(Timestamp(1)));
+  std::shared_ptr<proto_ns::Arena> arena2 = pool->GetArena(Timestamp(2));
+  EXPECT_NE(arena1, arena2);
+  EXPECT_EQ(2, pool->NumLiveArenas());
+
+  arena1.reset();
+  EXPECT_EQ(1, pool->NumLiveArenas());
+  arena2.reset();
+  EXPECT_EQ(0, pool->NumLiveArenas());
+}
+
+TEST(TimestampArenaTest, PacketsKeepArenaAlive) {
+  auto pool = std::make_shared<TimestampArenaPool>();
+  PacketTestProto* proto;
+  Packet packet = pool->NewMessage(Timestamp(5), &proto);
+  proto->add_x(42);
+  EXPECT_EQ(pool->GetArena(Timestamp(5)).get(), proto->GetArena());
+  EXPECT_EQ(Timestamp(5), packet.Timestamp());
+  EXPECT_EQ(42, packet.Get<PacketTestProto>().x(0));
+
+  PacketTestProto* other;
+  Packet other_packet = pool->NewMessage(Timestamp(5), &other);
+  EXPECT_EQ(1, pool->NumLiveArenas());
+
+  Packet copy = packet;
+  packet = Packet();
+  other_packet = Packet();
+  EXPECT_EQ(1, pool->NumLiveArenas());
+  EXPECT_EQ(42, copy.Get<PacketTestProto>().x(0));
+  copy = Packet();
+  EXPECT_EQ(0, pool->NumLiveArenas());
+}
+
+TEST(TimestampArenaTest, ArenaMessagesAreCopiedOnConsume) {
+  auto pool = std::make_shared<TimestampArenaPool>();
+  PacketTestProto* proto;
+  Packet packet = pool->NewMessage(Timestamp(5), &proto);
+  proto->add_x(7);
+  EXPECT_FALSE(packet.Consume<PacketTestProto>().ok());
+
+  bool was_copied = false;
+  auto result = packet.ConsumeOrCopy<PacketTestProto>(&was_copied);
+  MP_ASSERT_OK(result);
+  EXPECT_TRUE(was_copied);
+  EXPECT_EQ(7, result.value()->x(0));
+  EXPECT_EQ(0, pool->NumLiveArenas());
+}
+
+TEST(TimestampArenaTest, OutlivesPool) {
+  auto pool = std::make_shared<TimestampArenaPool>();
+  PacketTestProto* proto;
+  Packet packet = pool->NewMessage(Timestamp(5), &proto);
+  proto->add_x(3);
+  pool.reset();
+  EXPECT_EQ(3, packet.Get<PacketTestProto>().x(0));
+}
+
+CalculatorGraphConfig IntToProtoConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      calculator: "IntToProtoCalculator"
+      input_stream: "in"
+      output_stream: "out"
+    }
+  )pb");
+}
+
+TEST(TimestampArenaTest, CalculatorUsesService) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(IntToProtoConfig()));
+  auto pool = std::make_shared<TimestampArenaPool>();
+  MP_ASSERT_OK(graph.SetServiceObject(kTimestampArenaService, pool));
+  std::vector<Packet> output;
+  MP_ASSERT_OK(graph.ObserveOutputStream("out", [&output](const Packet& p) {
+    output.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(
+        graph.AddPacketToInputStream("in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(3, output.size());
+  EXPECT_EQ(3, pool->NumLiveArenas());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(Timestamp(i), output[i].Timestamp());
+    EXPECT_EQ(i, output[i].Get<PacketTestProto>().x(0));
+  }
+  output.clear();
+  EXPECT_EQ(0, pool->NumLiveArenas());
+}
+
+TEST(TimestampArenaTest, CalculatorFallsBackToHeap) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(IntToProtoConfig()));
+  std::vector<Packet> output;
+  MP_ASSERT_OK(graph.ObserveOutputStream("out", [&output](const Packet& p) {
+    output.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(9).At(Timestamp(1))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(1, output.size());
+  EXPECT_EQ(9, output[0].Get<PacketTestProto>().x(0));
+  // Heap-allocated messages can be consumed without a copy.
+  MP_EXPECT_OK(output[0].Consume<PacketTestProto>());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -13,6 +13,20 @@ Example:
     ]
   )
 
+mediapipe_precompiled_graph() additionally expands subgraphs, sorts nodes and
+validates the graph at build time, so that it initializes faster at runtime.
+Its deps are the calculator and subgraph libraries used by the graph.
+
+Example:
+  mediapipe_precompiled_graph(
+    name = "make_graph_precompiled_binarypb",
+    graph = "//mediapipe/framework/tool/testdata:test_graph",
+    output_name = "test.binarypb",
+    deps = [
+        "//video/annotation:graph_calculators_lib",
+    ]
+  )
+
 """
 
 load("//mediapipe/framework:encode_binary_proto.bzl", "encode_binary_proto", "generate_proto_descriptor_set")
@@ -61,6 +75,55 @@ def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], te
         testonly = testonly,
     )
 
+def mediapipe_precompiled_graph(name, graph = None, output_name = None, deps = [], testonly = False, **kwargs):
+    """Converts a graph from text format to precompiled binary format.
+
+    The output is the canonical CalculatorGraphConfig produced by
+    ValidatedGraphConfig, with CalculatorGraphConfig.precompiled set. Subgraphs
+    are expanded with the build host registrations, so graphs containing
+    subgraphs that depend on graph services or on the target platform must use
+    mediapipe_binary_graph instead.
+
+    Args:
+      name: The name of the rule.
+      graph: The text format CalculatorGraphConfig file.
+      output_name: The name of the output binary graph file.
+      deps: The calculator and subgraph libraries used by the graph.
+      testonly: pass 1 if the graph is to be used only for tests.
+      **kwargs: Remaining keyword args, unused.
+    """
+
+    if not graph:
+        fail("No input graph file specified.")
+
+    if not output_name:
+        fail("Must specify the output_name.")
+
+    # Compile a graph validator binary linking in the graph's calculators.
+    native.cc_binary(
+        name = name + "_precompile_graph",
+        visibility = ["//visibility:private"],
+        deps = [
+            clean_dep("//mediapipe/framework/tool:precompile_graph"),
+        ] + deps,
+        tags = ["manual"],
+        testonly = testonly,
+    )
+
+    # Invoke the graph validator binary.
+    native.genrule(
+        name = name,
+        srcs = [graph],
+        outs = [output_name],
+        cmd = (
+            "$(location " + name + "_precompile_graph" + ") " +
+            ("--proto_source=$(location %s) " % graph) +
+            ("--proto_output=\"$@\" ")
+        ),
+        tools = [name + "_precompile_graph"],
+        testonly = testonly,
+    )
+
 def data_as_c_string(
         name,
         srcs,
@@ -0,0 +1,115 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/node_chain_fusion.h"
+
+#include <string>
+
+#include "mediapipe/framework/calculator.pb.h"
+
+namespace mediapipe {
+namespace tool {
+
+namespace {
+
+constexpr char kDefaultInputStreamHandler[] = "DefaultInputStreamHandler";
+
+// Returns the name of the input stream handler used by a calculator node,
+// following the precedence in CalculatorNode::Initialize.
+std::string InputStreamHandlerName(const NodeTypeInfo& node_info,
+                                   const CalculatorGraphConfig::Node& node) {
+  if (node.input_stream_handler().has_input_stream_handler() ||
+      node_info.GetInputStreamHandler().empty()) {
+    return node.input_stream_handler().input_stream_handler();
+  }
+  return node_info.GetInputStreamHandler();
+}
+
+bool RunsInParallel(const CalculatorGraphConfig::Node& node) {
+  return node.max_in_flight() > 1;
+}
+
+// Returns the index of the node that feeds |node_index| as part of a fusable
+// chain, or -1 if there is none.
+int FusableProducer(const ValidatedGraphConfig& validated_graph,
+                    const std::vector<int>& num_consumers, int node_index) {
+  const NodeTypeInfo& node_info = validated_graph.CalculatorInfos()[node_index];
+  const CalculatorGraphConfig::Node& node =
+      validated_graph.Config().node(node_index);
+  if (node_info.InputStreamTypes().NumEntries() != 1 || RunsInParallel(node) ||
+      InputStreamHandlerName(node_info, node) != kDefaultInputStreamHandler) {
+    return -1;
+  }
+  const EdgeInfo& input =
+      validated_graph.InputStreamInfos()[node_info.InputStreamBaseIndex()];
+  if (input.back_edge || input.upstream < 0 ||
+      num_consumers[input.upstream] != 1) {
+    return -1;
+  }
+  const NodeTypeInfo::NodeRef& producer_ref =
+      validated_graph.OutputStreamInfos()[input.upstream].parent_node;
+  // Graph input streams belong to a virtual node, which is not a calculator.
+  if (producer_ref.type != NodeTypeInfo::NodeType::CALCULATOR) {
+    return -1;
+  }
+  const NodeTypeInfo& producer_info =
+      validated_graph.CalculatorInfos()[producer_ref.index];
+  const CalculatorGraphConfig::Node& producer =
+      validated_graph.Config().node(producer_ref.index);
+  if (producer_info.OutputStreamTypes().NumEntries() != 1 ||
+      RunsInParallel(producer) || producer.executor() != node.executor()) {
+    return -1;
+  }
+  return producer_ref.index;
+}
+
+}  // namespace
+
+std::vector<std::vector<int>> FindFusableNodeChains(
+    const ValidatedGraphConfig& validated_graph) {
+  std::vector<int> num_consumers(validated_graph.OutputStreamInfos().size());
+  for (const EdgeInfo& input : validated_graph.InputStreamInfos()) {
+    if (input.upstream >= 0) {
+      ++num_consumers[input.upstream];
+    }
+  }
+
+  // Each producer has a single output stream with a single consumer, so each
+  // node has at most one fused consumer and the links form linear chains.
+  const int num_nodes = validated_graph.CalculatorInfos().size();
+  std::vector<int> producer(num_nodes, -1);
+  std::vector<int> consumer(num_nodes, -1);
+  for (int i = 0; i < num_nodes; ++i) {
+    producer[i] = FusableProducer(validated_graph, num_consumers, i);
+    if (producer[i] >= 0) {
+      consumer[producer[i]] = i;
+    }
+  }
+
+  std::vector<std::vector<int>> chains;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (producer[i] >= 0 || consumer[i] < 0) {
+      continue;
+    }
+    std::vector<int> chain;
+    for (int n = i; n >= 0; n = consumer[n]) {
+      chain.push_back(n);
+    }
+    chains.push_back(std::move(chain));
+  }
+  return chains;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
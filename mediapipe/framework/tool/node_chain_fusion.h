@@ -0,0 +1,41 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_NODE_CHAIN_FUSION_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_NODE_CHAIN_FUSION_H_
+
+#include <vector>
+
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+namespace tool {
+
+// Returns the linear chains of calculator nodes that can be scheduled as a
+// single unit, as lists of node indexes in data flow order.  Every chain has
+// at least two nodes.  Each node after the first:
+// - has a single input stream, which is not a back edge, and uses the
+//   DefaultInputStreamHandler;
+// - is fed by the previous node, whose only output stream has no other
+//   consumers;
+// - runs on the same executor as the previous node, and neither of them runs
+//   in parallel (max_in_flight > 1).
+// See CalculatorGraphConfig::fuse_node_chains.
+std::vector<std::vector<int>> FindFusableNodeChains(
+    const ValidatedGraphConfig& validated_graph);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_NODE_CHAIN_FUSION_H_
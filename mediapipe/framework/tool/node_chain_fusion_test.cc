@@ -0,0 +1,201 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/node_chain_fusion.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Returns the fusable chains of a graph, as lists of node names.
+std::vector<std::vector<std::string>> FusableChainNames(
+    const CalculatorGraphConfig& config) {
+  ValidatedGraphConfig validated_graph;
+  MP_EXPECT_OK(validated_graph.Initialize(config));
+  std::vector<std::vector<std::string>> result;
+  for (const std::vector<int>& chain :
+       tool::FindFusableNodeChains(validated_graph)) {
+    std::vector<std::string> names;
+    for (int node_index : chain) {
+      names.push_back(validated_graph.Config().node(node_index).name());
+    }
+    result.push_back(names);
+  }
+  return result;
+}
+
+TEST(NodeChainFusionTest, FusesLinearChain) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        node {
+          name: "a"
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "a_out"
+        }
+        node {
+          name: "b"
+          calculator: "PassThroughCalculator"
+          input_stream: "a_out"
+          output_stream: "b_out"
+        }
+        node {
+          name: "c"
+          calculator: "PassThroughCalculator"
+          input_stream: "b_out"
+          output_stream: "c_out"
+        }
+      )pb");
+  EXPECT_THAT(FusableChainNames(config),
+              ElementsAre(ElementsAre("a", "b", "c")));
+}
+
+TEST(NodeChainFusionTest, FanOutEndsChain) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        node {
+          name: "a"
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "a_out"
+        }
+        node {
+          name: "b"
+          calculator: "PassThroughCalculator"
+          input_stream: "a_out"
+          output_stream: "b_out"
+        }
+        node {
+          name: "c"
+          calculator: "PassThroughCalculator"
+          input_stream: "a_out"
+          output_stream: "c_out"
+        }
+        node {
+          name: "d"
+          calculator: "PassThroughCalculator"
+          input_stream: "c_out"
+          output_stream: "d_out"
+        }
+      )pb");
+  EXPECT_THAT(FusableChainNames(config), ElementsAre(ElementsAre("c", "d")));
+}
+
+TEST(NodeChainFusionTest, DoesNotFuseIncompatibleNodes) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        input_stream: "in2"
+        executor { name: "other" }
+        node {
+          name: "a"
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "a_out"
+        }
+        node {
+          name: "other_executor"
+          calculator: "PassThroughCalculator"
+          input_stream: "a_out"
+          output_stream: "b_out"
+          executor: "other"
+        }
+        node {
+          name: "immediate"
+          calculator: "PassThroughCalculator"
+          input_stream: "b_out"
+          output_stream: "c_out"
+          input_stream_handler {
+            input_stream_handler: "ImmediateInputStreamHandler"
+          }
+        }
+        node {
+          name: "two_inputs"
+          calculator: "PassThroughCalculator"
+          input_stream: "c_out"
+          input_stream: "in2"
+          output_stream: "d_out"
+          output_stream: "d_out2"
+        }
+        node {
+          name: "parallel"
+          calculator: "PassThroughCalculator"
+          input_stream: "d_out"
+          output_stream: "e_out"
+          max_in_flight: 2
+        }
+      )pb");
+  EXPECT_THAT(FusableChainNames(config), IsEmpty());
+}
+
+TEST(NodeChainFusionTest, FusedChainDeliversAllPackets) {
+  constexpr int kNumPackets = 100;
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "in"
+        fuse_node_chains: true
+        num_threads: 4
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "a_out"
+        }
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "a_out"
+          output_stream: "b_out"
+        }
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "b_out"
+          output_stream: "c_out"
+        }
+      )pb");
+  std::vector<Packet> output;
+  tool::AddVectorSink("c_out", &config, &output);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < kNumPackets; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(kNumPackets, output.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(i, output[i].Get<int>());
+    EXPECT_EQ(Timestamp(i), output[i].Timestamp());
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,106 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A command line utility to validate a text graph config and output its
+// canonical form as a precompiled binary graph.  Calculators and subgraphs
+// used by the graph must be linked into the binary, see
+// mediapipe_precompiled_graph in mediapipe_graph.bzl.
+
+#include <stdlib.h>
+
+#include <fstream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/advanced_proto_inc.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+ABSL_FLAG(std::string, proto_source, "",
+          "The source file containing CalculatorGraphConfig protobuf text.");
+ABSL_FLAG(std::string, proto_output, "",
+          "An output file in binary CalculatorGraphConfig form, with "
+          "subgraphs expanded and nodes sorted.");
+
+#define EXIT_IF_ERROR(status) \
+  if (!status.ok()) {         \
+    LOG(ERROR) << status;     \
+    return EXIT_FAILURE;      \
+  }
+
+namespace mediapipe {
+
+// Reads a CalculatorGraphConfig from a text file.
+absl::Status ReadGraph(const std::string& proto_source,
+                       CalculatorGraphConfig* result) {
+  std::ifstream ifs(proto_source);
+  proto_ns::io::IstreamInputStream in(&ifs);
+  RET_CHECK(proto_ns::TextFormat::Parse(&in, result))
+      << "could not parse text proto: " << proto_source;
+  return absl::OkStatus();
+}
+
+// Writes a CalculatorGraphConfig to a binary file.
+absl::Status WriteGraph(const std::string& proto_output,
+                        const CalculatorGraphConfig& config) {
+  std::ofstream ofs(proto_output, std::ios_base::out | std::ios_base::trunc |
+                                      std::ios_base::binary);
+  proto_ns::io::OstreamOutputStream out(&ofs);
+  RET_CHECK(config.SerializeToZeroCopyStream(&out))
+      << "could not write binary proto to: " << proto_output;
+  return absl::OkStatus();
+}
+
+// Expands, sorts and validates |config| using the linked registrations.
+absl::Status PrecompileGraph(const CalculatorGraphConfig& config,
+                             CalculatorGraphConfig* result) {
+  RET_CHECK(!config.precompiled()) << "Graph config is already precompiled.";
+  ValidatedGraphConfig validated_graph;
+  MP_RETURN_IF_ERROR(validated_graph.Initialize(config));
+  *result = validated_graph.PrecompiledConfig();
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+
+  // Validate command line options.
+  absl::Status status;
+  if (absl::GetFlag(FLAGS_proto_source).empty()) {
+    status.Update(
+        absl::InvalidArgumentError("--proto_source must be specified"));
+  }
+  if (absl::GetFlag(FLAGS_proto_output).empty()) {
+    status.Update(
+        absl::InvalidArgumentError("--proto_output must be specified"));
+  }
+  if (!status.ok()) {
+    return EXIT_FAILURE;
+  }
+  mediapipe::CalculatorGraphConfig config;
+  EXIT_IF_ERROR(
+      mediapipe::ReadGraph(absl::GetFlag(FLAGS_proto_source), &config));
+  mediapipe::CalculatorGraphConfig precompiled;
+  EXIT_IF_ERROR(mediapipe::PrecompileGraph(config, &precompiled));
+  EXIT_IF_ERROR(
+      mediapipe::WriteGraph(absl::GetFlag(FLAGS_proto_output), precompiled));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+namespace {
+
+// The text graph config passed to mediapipe_precompiled_graph.
+static const char kSourceGraph[] =
+#include "mediapipe/framework/tool/nested_test_subgraph_pbtxt.inc"
+    ;  // NOLINT(whitespace/semicolon)
+
+// The output of mediapipe_precompiled_graph for kSourceGraph.
+static const char kPrecompiledGraph[] =
+#include "mediapipe/framework/tool/nested_test_precompiled_binarypb.inc"
+    ;  // NOLINT(whitespace/semicolon)
+
+CalculatorGraphConfig SourceConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(kSourceGraph);
+}
+
+CalculatorGraphConfig PrecompiledConfig() {
+  CalculatorGraphConfig config;
+  CHECK(config.ParseFromArray(kPrecompiledGraph,
+                              sizeof(kPrecompiledGraph) - 1));
+  return config;
+}
+
+// Runs |config| on a few ints and returns the values of every graph output.
+std::vector<std::vector<int>> RunGraph(const CalculatorGraphConfig& config) {
+  const std::vector<std::string> output_names = {"doubled", "quadrupled",
+                                                 "octupled"};
+  std::vector<std::vector<int>> outputs(output_names.size());
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  for (int i = 0; i < output_names.size(); ++i) {
+    std::vector<int>* output = &outputs[i];
+    MP_EXPECT_OK(graph.ObserveOutputStream(
+        output_names[i], [output](const Packet& p) {
+          output->push_back(p.Get<int>());
+          return absl::OkStatus();
+        }));
+  }
+  MP_EXPECT_OK(graph.StartRun({}));
+  for (int i = 1; i <= 3; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "ints", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return outputs;
+}
+
+TEST(PrecompileGraphTest, OutputIsCanonicalConfig) {
+  CalculatorGraphConfig precompiled = PrecompiledConfig();
+  EXPECT_TRUE(precompiled.precompiled());
+  for (const auto& node : precompiled.node()) {
+    EXPECT_EQ(node.calculator(), "DoubleIntCalculator");
+  }
+
+  ValidatedGraphConfig validated_graph;
+  MP_ASSERT_OK(validated_graph.Initialize(SourceConfig()));
+  EXPECT_THAT(precompiled, EqualsProto(validated_graph.PrecompiledConfig()));
+}
+
+TEST(PrecompileGraphTest, OutputRunsLikeSourceConfig) {
+  std::vector<std::vector<int>> source_outputs = RunGraph(SourceConfig());
+  std::vector<std::vector<int>> precompiled_outputs =
+      RunGraph(PrecompiledConfig());
+  EXPECT_EQ(source_outputs, (std::vector<std::vector<int>>{
+                                {2, 4, 6}, {4, 8, 12}, {8, 16, 24}}));
+  EXPECT_EQ(precompiled_outputs, source_outputs);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -356,8 +356,13 @@ absl::Status ValidatedGraphConfig::Initialize(
           << input_config.DebugString();
 #endif
 
-  MP_RETURN_IF_ERROR(PerformBasicTransforms(input_config, graph_registry,
-                                            service_manager, &config_));
+  if (input_config.precompiled()) {
+    // Subgraphs were expanded when the config was precompiled.
+    config_ = input_config;
+  } else {
+    MP_RETURN_IF_ERROR(PerformBasicTransforms(input_config, graph_registry,
+                                              service_manager, &config_));
+  }
 
   // Initialize the basic node information.
   MP_RETURN_IF_ERROR(InitializeGeneratorInfo());
@@ -387,6 +392,8 @@ absl::Status ValidatedGraphConfig::Initialize(
   // Initialize the stream information.
   MP_RETURN_IF_ERROR(InitializeStreamInfo(&need_sorting));
   if (need_sorting) {
+    RET_CHECK(!config_.precompiled())
+        << "Precompiled graph config is not topologically sorted.";
     MP_RETURN_IF_ERROR(TopologicalSortNodes());
 
     // Clear the information from the unsorted analysis.
@@ -414,9 +421,12 @@ absl::Status ValidatedGraphConfig::Initialize(
   MP_RETURN_IF_ERROR(
       ResolveAnyTypes(&input_side_packets_, &output_side_packets_));
 
-  // Validate consistency of side packets and streams.
-  MP_RETURN_IF_ERROR(ValidateSidePacketTypes());
-  MP_RETURN_IF_ERROR(ValidateStreamTypes());
+  // Validate consistency of side packets and streams.  A precompiled config
+  // was validated when it was produced.
+  if (!config_.precompiled()) {
+    MP_RETURN_IF_ERROR(ValidateSidePacketTypes());
+    MP_RETURN_IF_ERROR(ValidateStreamTypes());
+  }
 
   MP_RETURN_IF_ERROR(ComputeSourceDependence());
 
@@ -430,6 +440,12 @@ absl::Status ValidatedGraphConfig::Initialize(
   return absl::OkStatus();
 }
 
+CalculatorGraphConfig ValidatedGraphConfig::PrecompiledConfig() const {
+  CalculatorGraphConfig config = config_;
+  config.set_precompiled(true);
+  return config;
+}
+
 absl::Status ValidatedGraphConfig::Initialize(
     const std::string& graph_type, const Subgraph::SubgraphOptions* options,
     const GraphRegistry* graph_registry,
@@ -241,6 +241,11 @@ class ValidatedGraphConfig {
   // The proto configuration (canonicalized).
   const CalculatorGraphConfig& Config() const { return config_; }
 
+  // Returns the canonical config marked as precompiled.  It can be stored and
+  // later used to initialize a graph without subgraph expansion, sorting and
+  // type validation.  See CalculatorGraphConfig::precompiled.
+  CalculatorGraphConfig PrecompiledConfig() const;
+
   // Accessors for the info objects.
   const std::vector<NodeTypeInfo>& CalculatorInfos() const {
     return calculators_;
@@ -1,5 +1,6 @@
 #include "mediapipe/framework/validated_graph_config.h"
 
+#include <string>
 #include <string_view>
 
 #include "absl/status/status.h"
@@ -11,7 +12,9 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/deps/message_matchers.h"
 #include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
@@ -162,4 +165,129 @@ TEST(ValidatedGraphConfigTest, InitializeSubgraphWithServiceCalculatorB) {
   }
 }
 
+class IntPassThrough : public mediapipe::api2::Node {
+ public:
+  static constexpr mediapipe::api2::Input<int> kIn{"IN"};
+  static constexpr mediapipe::api2::Output<int> kOut{"OUT"};
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOut);
+  absl::Status Process(CalculatorContext* cc) override {
+    kOut(cc).Send(kIn(cc));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(IntPassThrough);
+
+class PassThroughChainSubgraph : public Subgraph {
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      SubgraphContext* sc) override {
+    return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "IN:in"
+      output_stream: "OUT:out"
+      node {
+        calculator: "IntPassThrough"
+        input_stream: "IN:mid"
+        output_stream: "OUT:out"
+      }
+      node {
+        calculator: "IntPassThrough"
+        input_stream: "IN:in"
+        output_stream: "OUT:mid"
+      }
+    )pb");
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(PassThroughChainSubgraph);
+
+// Returns a graph of |num_subgraphs| chained PassThroughChainSubgraphs, listed
+// in reverse order so that the expanded nodes must be sorted.
+CalculatorGraphConfig ChainGraphConfig(int num_subgraphs) {
+  CalculatorGraphConfig graph;
+  graph.add_input_stream("s0");
+  graph.add_output_stream(absl::StrCat("s", num_subgraphs));
+  for (int i = num_subgraphs; i > 0; --i) {
+    CalculatorGraphConfig::Node* node = graph.add_node();
+    node->set_calculator("PassThroughChainSubgraph");
+    node->add_input_stream(absl::StrCat("IN:s", i - 1));
+    node->add_output_stream(absl::StrCat("OUT:s", i));
+  }
+  return graph;
+}
+
+TEST(ValidatedGraphConfigTest, InitializePrecompiled) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(ChainGraphConfig(3)));
+  CalculatorGraphConfig precompiled = config.PrecompiledConfig();
+  EXPECT_TRUE(precompiled.precompiled());
+  EXPECT_EQ(precompiled.node_size(), 6);
+
+  ValidatedGraphConfig precompiled_config;
+  MP_ASSERT_OK(precompiled_config.Initialize(precompiled));
+  EXPECT_THAT(precompiled_config.Config(), EqualsProto(precompiled));
+  EXPECT_EQ(precompiled_config.InputStreamInfos().size(),
+            config.InputStreamInfos().size());
+  EXPECT_EQ(precompiled_config.OutputStreamInfos().size(),
+            config.OutputStreamInfos().size());
+  for (int i = 0; i < config.OutputStreamInfos().size(); ++i) {
+    EXPECT_EQ(precompiled_config.OutputStreamInfos()[i].name,
+              config.OutputStreamInfos()[i].name);
+  }
+}
+
+TEST(ValidatedGraphConfigTest, InitializePrecompiledRunsGraph) {
+  ValidatedGraphConfig config;
+  MP_ASSERT_OK(config.Initialize(ChainGraphConfig(2)));
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config.PrecompiledConfig()));
+  std::vector<Packet> output;
+  MP_ASSERT_OK(graph.ObserveOutputStream("s2", [&output](const Packet& p) {
+    output.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("s0", MakePacket<int>(7).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(output.size(), 1);
+  EXPECT_EQ(output[0].Get<int>(), 7);
+}
+
+TEST(ValidatedGraphConfigTest, InitializePrecompiledRejectsUnsortedConfig) {
+  ValidatedGraphConfig sorted_config;
+  MP_ASSERT_OK(sorted_config.Initialize(ChainGraphConfig(2)));
+  // Expanded nodes of registered calculators, consumers before producers.
+  CalculatorGraphConfig graph = sorted_config.PrecompiledConfig();
+  ASSERT_EQ(graph.node_size(), 4);
+  graph.mutable_node()->SwapElements(0, 3);
+  graph.mutable_node()->SwapElements(1, 2);
+
+  ValidatedGraphConfig config;
+  absl::Status status = config.Initialize(graph);
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(), testing::HasSubstr("not topologically sorted"));
+}
+
+// Initializes a graph of chained subgraphs from its text-derived config.
+// Compare with BM_InitializePrecompiledGraph.
+void BM_InitializeGraph(benchmark::State& state) {
+  const CalculatorGraphConfig graph = ChainGraphConfig(state.range(0));
+  for (auto _ : state) {
+    ValidatedGraphConfig config;
+    CHECK(config.Initialize(graph).ok());
+  }
+}
+BENCHMARK(BM_InitializeGraph)->Arg(10)->Arg(100);
+
+void BM_InitializePrecompiledGraph(benchmark::State& state) {
+  ValidatedGraphConfig cold_config;
+  CHECK(cold_config.Initialize(ChainGraphConfig(state.range(0))).ok());
+  const CalculatorGraphConfig graph = cold_config.PrecompiledConfig();
+  for (auto _ : state) {
+    ValidatedGraphConfig config;
+    CHECK(config.Initialize(graph).ok());
+  }
+}
+BENCHMARK(BM_InitializePrecompiledGraph)->Arg(10)->Arg(100);
+
 }  // namespace mediapipe
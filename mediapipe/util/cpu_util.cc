@@ -24,11 +24,15 @@
 #include <unistd.h>
 #endif
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -38,6 +42,10 @@ ABSL_FLAG(std::string, system_cpu_max_freq_file,
           "/sys/devices/system/cpu/cpu$0/cpufreq/cpuinfo_max_freq",
           "The file pattern for CPU max frequencies, where $0 will be replaced "
           "with the CPU id.");
+ABSL_FLAG(std::string, system_numa_node_cpu_list_file,
+          "/sys/devices/system/node/node$0/cpulist",
+          "The file pattern for NUMA node CPU lists, where $0 will be replaced "
+          "with the NUMA node id.");
 
 namespace mediapipe {
 namespace {
@@ -136,4 +144,49 @@ std::set<int> InferHigherCoreIds() {
   return InferLowerOrHigherCoreIds(/* lower= */ false);
 }
 
+absl::StatusOr<std::set<int>> NumaNodeCoreIds(
+    const std::set<int>& numa_nodes) {
+  const std::string pattern =
+      absl::GetFlag(FLAGS_system_numa_node_cpu_list_file);
+  if (pattern.find("$0") == std::string::npos) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid NUMA node CPU list file: ", pattern));
+  }
+  std::set<int> core_ids;
+  for (const int numa_node : numa_nodes) {
+    const std::string path = absl::Substitute(pattern, numa_node);
+    std::ifstream file(path);
+    std::string cpu_list;
+    if (!file.is_open() || !std::getline(file, cpu_list)) {
+      return absl::NotFoundError(absl::StrCat("Couldn't read ", path));
+    }
+    auto cpus_or_status = ParseCpuList(cpu_list);
+    if (!cpus_or_status.ok()) {
+      return cpus_or_status.status();
+    }
+    core_ids.insert(cpus_or_status.value().begin(),
+                    cpus_or_status.value().end());
+  }
+  return core_ids;
+}
+
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list) {
+  std::set<int> core_ids;
+  for (absl::string_view range :
+       absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                      absl::SkipEmpty())) {
+    std::vector<absl::string_view> bounds = absl::StrSplit(range, '-');
+    int first, last;
+    if (bounds.size() > 2 || !absl::SimpleAtoi(bounds.front(), &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 || last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU list: ", cpu_list));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      core_ids.insert(cpu);
+    }
+  }
+  return core_ids;
+}
+
 }  // namespace mediapipe.
@@ -17,6 +17,9 @@
 
 #include <set>
 
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/statusor.h"
+
 namespace mediapipe {
 // Returns the number of CPU cores. Compatible with Android.
 int NumCPUCores();
@@ -24,6 +27,11 @@ int NumCPUCores();
 std::set<int> InferLowerCoreIds();
 // Returns a set of inferred CPU ids of higher cores.
 std::set<int> InferHigherCoreIds();
+// Returns the CPU ids of the given NUMA nodes, or an error if the CPU list of
+// a NUMA node can't be read.
+absl::StatusOr<std::set<int>> NumaNodeCoreIds(const std::set<int>& numa_nodes);
+// Parses a CPU list in the Linux sysfs format, such as "0-3,8,10-11".
+absl::StatusOr<std::set<int>> ParseCpuList(absl::string_view cpu_list);
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_UTIL_CPU_UTIL_H_
@@ -16,7 +16,13 @@
 
 #include <sys/stat.h>
 
+#ifdef _WIN32
 #include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include <limits>
 
 #include "absl/strings/str_cat.h"
@@ -119,6 +125,39 @@ TimedBox BlendTimedBoxes(const TimedBox& lhs, const TimedBox& rhs,
   return TimedBox::Blend(lhs, rhs, alpha);
 }
 
+// Parses chunk from chunk_file. The file is memory-mapped where supported, so
+// it is decoded without being copied to an intermediate buffer first.
+// Returns false if the file could not be read or parsed.
+bool ParseChunkFile(const std::string& chunk_file, TrackingDataChunk* chunk) {
+#ifdef _WIN32
+  std::ifstream in(chunk_file, std::ios::in | std::ios::binary);
+  return in && chunk->ParseFromIstream(&in);
+#else
+  const int fd = open(chunk_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return false;
+  }
+  const size_t size = file_stat.st_size;
+  if (size == 0) {
+    close(fd);
+    return chunk->ParseFromArray(nullptr, 0);
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  const bool success = chunk->ParseFromArray(data, size);
+  munmap(data, size);
+  return success;
+#endif
+}
+
 }  // namespace.
 
 TimedBox TimedBox::Blend(const TimedBox& lhs, const TimedBox& rhs, double alpha,
@@ -314,9 +353,9 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting at chunk " << chunk_idx;
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
+  SharedChunkPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
 
-  if (!tracking_chunk.first) {
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file: " << chunk_idx
@@ -324,21 +363,15 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
     return;
   }
 
-  // Grab ownership here, to avoid any memory leaks due to early return.
-  std::unique_ptr<const TrackingDataChunk> chunk_owned;
-  if (tracking_chunk.second) {
-    chunk_owned.reset(tracking_chunk.first);
-  }
-
   const int start_frame =
-      ClosestFrameIndex(initial_pos.time_msec, *tracking_chunk.first);
+      ClosestFrameIndex(initial_pos.time_msec, *tracking_chunk);
 
   VLOG(1) << "Local start frame: " << start_frame;
 
   // Update starting position to coincide with a frame.
   TimedBox start_pos = initial_pos;
   start_pos.time_msec =
-      tracking_chunk.first->item(start_frame).timestamp_usec() / 1000;
+      tracking_chunk->item(start_frame).timestamp_usec() / 1000;
 
   VLOG(1) << "Request at " << initial_pos.time_msec << " revised to "
           << start_pos.time_msec;
@@ -375,27 +408,20 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting tracking workers ... ";
 
-  AugmentedChunkPtr forward_chunk = tracking_chunk;
-  AugmentedChunkPtr backward_chunk = tracking_chunk;
-
-  if (tracking_chunk.second) {  // We have ownership, need a copy here.
-    forward_chunk = std::make_pair(new TrackingDataChunk(*chunk_owned), true);
-    backward_chunk = std::make_pair(chunk_owned.release(), true);
-  }
-
-  auto forward_operation = [this, forward_chunk, start_state, start_frame,
+  // Forward and backward tracking share the (read-only) chunk.
+  auto forward_operation = [this, tracking_chunk, start_state, start_frame,
                             chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(forward_chunk, start_state, start_frame,
-                                        chunk_idx, id, checkpoint, true, true,
-                                        min_msec, max_msec));
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
+                                        start_frame, chunk_idx, id, checkpoint,
+                                        true, true, min_msec, max_msec));
   };
 
   tracking_workers_->Schedule(forward_operation);
 
   // Track backward.
-  auto backward_operation = [this, backward_chunk, start_state, start_frame,
+  auto backward_operation = [this, tracking_chunk, start_state, start_frame,
                              chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(backward_chunk, start_state,
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
                                         start_frame, chunk_idx, id, checkpoint,
                                         false, true, min_msec, max_msec));
   };
@@ -579,23 +605,64 @@ bool BoxTracker::IsTrackingOngoingMutexHeld() {
   return false;
 }
 
-BoxTracker::AugmentedChunkPtr BoxTracker::ReadChunk(int id, int checkpoint,
-                                                    int chunk_idx) {
+BoxTracker::SharedChunkPtr BoxTracker::ReadChunk(int id, int checkpoint,
+                                                 int chunk_idx) {
   VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
   if (cache_dir_.empty() && !tracking_data_.empty()) {
     if (chunk_idx < tracking_data_.size()) {
-      return std::make_pair(tracking_data_[chunk_idx], false);
+      // Chunks in memory are owned by tracking_data_buffer_ or the caller.
+      return SharedChunkPtr(tracking_data_[chunk_idx],
+                            [](const TrackingDataChunk*) {});
     } else {
       LOG(ERROR) << "chunk_idx >= tracking_data_.size()";
-      return std::make_pair(nullptr, false);
+      return nullptr;
     }
+  } else if (options_.max_cached_chunks() > 0) {
+    return ReadCachedChunk(id, checkpoint, chunk_idx);
   } else {
-    std::unique_ptr<TrackingDataChunk> chunk_data(
-        ReadChunkFromCache(id, checkpoint, chunk_idx));
-    return std::make_pair(chunk_data.release(), true);
+    return ReadChunkFromCache(id, checkpoint, chunk_idx);
   }
 }
 
+BoxTracker::SharedChunkPtr BoxTracker::ReadCachedChunk(int id, int checkpoint,
+                                                       int chunk_idx) {
+  {
+    absl::MutexLock lock(&chunk_cache_mutex_);
+    // Wait for a concurrent read of the same chunk, e.g. by the tracks
+    // continuing into it or by another box starting in it.
+    while (chunks_reading_.count(chunk_idx) > 0) {
+      chunk_cache_condvar_.WaitWithTimeout(&chunk_cache_mutex_,
+                                           absl::Milliseconds(100));
+      if (IsCanceled(id, checkpoint)) {
+        return nullptr;
+      }
+    }
+
+    for (auto entry = chunk_cache_.begin(); entry != chunk_cache_.end();
+         ++entry) {
+      if (entry->first == chunk_idx) {
+        chunk_cache_.splice(chunk_cache_.begin(), chunk_cache_, entry);
+        return chunk_cache_.front().second;
+      }
+    }
+    chunks_reading_.insert(chunk_idx);
+  }
+
+  SharedChunkPtr chunk_data = ReadChunkFromCache(id, checkpoint, chunk_idx);
+
+  absl::MutexLock lock(&chunk_cache_mutex_);
+  chunks_reading_.erase(chunk_idx);
+  // Failed reads are not cached, so that waiting requests retry on their own.
+  if (chunk_data) {
+    chunk_cache_.emplace_front(chunk_idx, chunk_data);
+    while (chunk_cache_.size() > options_.max_cached_chunks()) {
+      chunk_cache_.pop_back();
+    }
+  }
+  chunk_cache_condvar_.SignalAll();
+  return chunk_data;
+}
+
 std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
     int id, int checkpoint, int chunk_idx) {
   VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
@@ -623,25 +690,20 @@ std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
 
   VLOG(1) << "File exists, reading ...";
 
-  std::ifstream in(chunk_file, std::ios::in | std::ios::binary);
-  if (!in) {
+  if (!ParseChunkFile(chunk_file, chunk_data.get())) {
     LOG(ERROR) << "Could not read chunk file: " << chunk_file;
     return nullptr;
   }
 
-  std::string data;
-  in.seekg(0, std::ios::end);
-  data.resize(in.tellg());
-  in.seekg(0, std::ios::beg);
-  in.read(&data[0], data.size());
-  in.close();
-
-  chunk_data->ParseFromString(data);
-
   VLOG(1) << "Read success";
   return chunk_data;
 }
 
+bool BoxTracker::IsCanceled(int id, int checkpoint) {
+  absl::MutexLock lock(&status_mutex_);
+  return track_status_[id][checkpoint].canceled;
+}
+
 bool BoxTracker::WaitForChunkFile(int id, int checkpoint,
                                   const std::string& chunk_file) {
   VLOG(1) << "Chunk no exists, waiting for file: " << chunk_file;
@@ -660,11 +722,8 @@ bool BoxTracker::WaitForChunkFile(int id, int checkpoint,
 
   while (!file_exists && total_wait_msec < timeout_msec) {
     // Check if we got canceled.
-    {
-      absl::MutexLock lock(&status_mutex_);
-      if (track_status_[id][checkpoint].canceled) {
-        return false;
-      }
+    if (IsCanceled(id, checkpoint)) {
+      return false;
     }
 
     absl::SleepFor(absl::Milliseconds(wait_time_msec));
@@ -820,10 +879,10 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
 
       if (f + 2 == chunk_data_size && !a.chunk_data->last_chunk()) {
         // Last frame, successful track, continue;
-        AugmentedChunkPtr next_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1));
+        SharedChunkPtr next_chunk =
+            ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1);
 
-        if (next_chunk.first != nullptr) {
+        if (next_chunk != nullptr) {
           TrackingImplArgs next_args(next_chunk, motion_box.StateAtFrame(f + 1),
                                      0, a.chunk_idx + 1, a.id, a.checkpoint,
                                      a.forward, false, a.min_msec, a.max_msec);
@@ -880,10 +939,10 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
         VLOG(1) << "Read next chunk: " << f << "==" << first_frame << " in "
                 << a.chunk_idx;
         // First frame, successful track, continue.
-        AugmentedChunkPtr prev_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1));
-        if (prev_chunk.first != nullptr) {
-          const int last_frame = prev_chunk.first->item_size() - 1;
+        SharedChunkPtr prev_chunk =
+            ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1);
+        if (prev_chunk != nullptr) {
+          const int last_frame = prev_chunk->item_size() - 1;
           TrackingImplArgs prev_args(prev_chunk, motion_box.StateAtFrame(f - 1),
                                      last_frame, a.chunk_idx - 1, a.id,
                                      a.checkpoint, a.forward, false, a.min_msec,
@@ -1035,26 +1094,21 @@ bool BoxTracker::GetTrackingData(int id, int64 request_time_msec,
 
   int chunk_idx = ChunkIdxFromTime(request_time_msec);
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
-  if (!tracking_chunk.first) {
+  SharedChunkPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file.";
     return false;
   }
 
-  std::unique_ptr<const TrackingDataChunk> owned_chunk;
-  if (tracking_chunk.second) {
-    owned_chunk.reset(tracking_chunk.first);
-  }
-
   const int closest_frame =
-      ClosestFrameIndex(request_time_msec, *tracking_chunk.first);
+      ClosestFrameIndex(request_time_msec, *tracking_chunk);
 
-  *tracking_data = tracking_chunk.first->item(closest_frame).tracking_data();
+  *tracking_data = tracking_chunk->item(closest_frame).tracking_data();
   if (tracking_data_msec) {
     *tracking_data_msec =
-        tracking_chunk.first->item(closest_frame).timestamp_usec() / 1000;
+        tracking_chunk->item(closest_frame).timestamp_usec() / 1000;
   }
   return true;
 }
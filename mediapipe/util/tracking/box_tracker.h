@@ -17,8 +17,11 @@
 
 #include <inttypes.h>
 
+#include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -130,7 +133,8 @@ bool TimedBoxAtTime(const PathSegment& segment, int64 time_msec, TimedBox* box,
 class BoxTracker {
  public:
   // Initializes a new BoxTracker to work on cached TrackingData from a chunk
-  // directory.
+  // directory. Chunks read from the directory are decoded once and shared by
+  // all tracking requests, up to options.max_cached_chunks() at a time.
   BoxTracker(const std::string& cache_dir, const BoxTrackerOptions& options);
 
   // Initializes a new BoxTracker to work on the passed TrackingDataChunks.
@@ -215,8 +219,8 @@ class BoxTracker {
       ABSL_LOCKS_EXCLUDED(status_mutex_);
 
   // Debug function to obtain raw TrackingData closest to the specified
-  // timestamp. This call will read from disk on every invocation so it is
-  // expensive.
+  // timestamp. This call reads from disk unless the chunk is already cached,
+  // so it can be expensive.
   // To not interfere with other tracking requests it is recommended that you
   // use a unique id here.
   // Returns true on success.
@@ -230,13 +234,19 @@ class BoxTracker {
   void NewBoxTrackAsync(const TimedBox& initial_pos, int id, int64 min_msec,
                         int64 max_msec);
 
-  typedef std::pair<const TrackingDataChunk*, bool> AugmentedChunkPtr;
+  // Chunk shared between tracking requests. Chunks passed in memory without
+  // copy_data are not owned by the pointer.
+  typedef std::shared_ptr<const TrackingDataChunk> SharedChunkPtr;
   // Attempts to read chunk at chunk_idx if it exists. Reads from cache
-  // directory or from in memory cache.
-  // Important: 2nd part of return value indicates if returned tracking data
-  // will be owned by the caller (if true). In that case caller is responsible
-  // for releasing the returned chunk.
-  AugmentedChunkPtr ReadChunk(int id, int checkpoint, int chunk_idx);
+  // directory or from in memory cache. Returns nullptr if data could not be
+  // read.
+  SharedChunkPtr ReadChunk(int id, int checkpoint, int chunk_idx);
+
+  // Returns the chunk at chunk_idx from chunk_cache_, reading it from the
+  // caching directory if it is not cached yet. Requests for a chunk that is
+  // being read wait for and share its result instead of reading it again.
+  SharedChunkPtr ReadCachedChunk(int id, int checkpoint, int chunk_idx)
+      ABSL_LOCKS_EXCLUDED(chunk_cache_mutex_, status_mutex_);
 
   // Attempts to read specified chunk from caching directory. Blocks and waits
   // until chunk is available or internal time out is reached.
@@ -244,6 +254,9 @@ class BoxTracker {
   std::unique_ptr<TrackingDataChunk> ReadChunkFromCache(int id, int checkpoint,
                                                         int chunk_idx);
 
+  // Returns true if tracking for the specified checkpoint was canceled.
+  bool IsCanceled(int id, int checkpoint) ABSL_LOCKS_EXCLUDED(status_mutex_);
+
   // Waits with timeout for chunkfile to become available. Returns true on
   // success, false if waited till timeout or when canceled.
   bool WaitForChunkFile(int id, int checkpoint, const std::string& chunk_file)
@@ -257,13 +270,13 @@ class BoxTracker {
                     const MotionBoxState& state);
 
   // Callback can only handle 5 args max.
-  // Set own_data to true for args to assume ownership.
   struct TrackingImplArgs {
-    TrackingImplArgs(AugmentedChunkPtr chunk_ptr,
+    TrackingImplArgs(SharedChunkPtr chunk_ptr,
                      const MotionBoxState& start_state_, int start_frame_,
                      int chunk_idx_, int id_, int checkpoint_, bool forward_,
                      bool first_call_, int64 min_msec_, int64 max_msec_)
-        : start_state(start_state_),
+        : chunk_data(std::move(chunk_ptr)),
+          start_state(start_state_),
           start_frame(start_frame_),
           chunk_idx(chunk_idx_),
           id(id_),
@@ -271,22 +284,12 @@ class BoxTracker {
           forward(forward_),
           first_call(first_call_),
           min_msec(min_msec_),
-          max_msec(max_msec_) {
-      if (chunk_ptr.second) {
-        chunk_data_buffer.reset(chunk_ptr.first);
-      }
-
-      chunk_data = chunk_ptr.first;
-    }
+          max_msec(max_msec_) {}
 
     TrackingImplArgs(const TrackingImplArgs&) = default;
 
-    // Storage for tracking data.
-    std::shared_ptr<const TrackingDataChunk> chunk_data_buffer;
-
-    // Pointer to the actual tracking data. Usually points to the buffer
-    // but can also point to external data for performance reasons.
-    const TrackingDataChunk* chunk_data;
+    // The tracking data, shared with other tracking requests.
+    SharedChunkPtr chunk_data;
 
     MotionBoxState start_state;
     int start_frame;
@@ -364,6 +367,16 @@ class BoxTracker {
   // Buffer for tracking data in case we retain a deep copy.
   std::vector<std::unique_ptr<TrackingDataChunk>> tracking_data_buffer_;
 
+  // Chunks decoded from cache_dir_ as (chunk_idx, chunk), most recently used
+  // first. Holds at most options_.max_cached_chunks() chunks.
+  std::list<std::pair<int, SharedChunkPtr>> chunk_cache_
+      ABSL_GUARDED_BY(chunk_cache_mutex_);
+  // Indices of the chunks currently read from cache_dir_.
+  std::unordered_set<int> chunks_reading_ ABSL_GUARDED_BY(chunk_cache_mutex_);
+  absl::Mutex chunk_cache_mutex_;
+  // Signaled when a chunk read from cache_dir_ completes.
+  absl::CondVar chunk_cache_condvar_;
+
   // Workers that run the tracking algorithm.
   std::unique_ptr<ThreadPool> tracking_workers_;
 };
@@ -112,6 +112,50 @@ TEST(BoxTrackerTest, MovingBoxTest) {
   }
 }
 
+// Concurrent tracks sharing cached chunks yield the same results as tracks
+// that each read their own chunks.
+TEST(BoxTrackerTest, SharedChunkCacheTest) {
+  const std::string cache_dir =
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/box_tracker");
+  BoxTrackerOptions uncached_options;
+  uncached_options.set_max_cached_chunks(0);
+  BoxTracker uncached_tracker(cache_dir, uncached_options);
+  // Smaller than the number of chunks, to evict chunks while tracking.
+  BoxTrackerOptions cached_options;
+  cached_options.set_max_cached_chunks(2);
+  BoxTracker cached_tracker(cache_dir, cached_options);
+
+  constexpr int kNumBoxes = 4;
+  for (int id = 0; id < kNumBoxes; ++id) {
+    TimedBox initial_pos;
+    initial_pos.left = 0.1f * id;
+    initial_pos.top = 0.5f;
+    initial_pos.right = initial_pos.left + 0.2f;
+    initial_pos.bottom = initial_pos.top + 0.3f;
+    initial_pos.time_msec = 3000 + 1000 * id;
+    uncached_tracker.NewBoxTrack(initial_pos, id);
+    cached_tracker.NewBoxTrack(initial_pos, id);
+  }
+  uncached_tracker.WaitForAllOngoingTracks();
+  cached_tracker.WaitForAllOngoingTracks();
+
+  for (int id = 0; id < kNumBoxes; ++id) {
+    EXPECT_EQ(uncached_tracker.TrackInterval(id),
+              cached_tracker.TrackInterval(id));
+    for (int k = 0; k < 15000; k += 100) {
+      TimedBox uncached_box;
+      TimedBox cached_box;
+      ASSERT_EQ(uncached_tracker.GetTimedPosition(id, k, &uncached_box),
+                cached_tracker.GetTimedPosition(id, k, &cached_box));
+      EXPECT_EQ(uncached_box.time_msec, cached_box.time_msec);
+      EXPECT_FLOAT_EQ(uncached_box.top, cached_box.top);
+      EXPECT_FLOAT_EQ(uncached_box.left, cached_box.left);
+      EXPECT_FLOAT_EQ(uncached_box.bottom, cached_box.bottom);
+      EXPECT_FLOAT_EQ(uncached_box.right, cached_box.right);
+    }
+  }
+}
+
 }  // namespace
 
 }  // namespace mediapipe
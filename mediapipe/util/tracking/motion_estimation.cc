@@ -3639,6 +3639,100 @@ bool MotionEstimation::EstimateLinearSimilarityModelIRLS(
   return true;
 }
 
+namespace {
+
+// Eigen views of the locations and irls weights in RegionFlowFeatureArrays,
+// along with the match locations. The IRLS solvers below build their systems
+// with Eigen's coefficient-wise and matrix products (which Eigen vectorizes)
+// instead of per feature scalar updates. The weights are viewed in place, so
+// updates to RegionFlowFeatureArrays::irls_weight between rounds are seen by
+// the next solve.
+struct IrlsFeatureView {
+  explicit IrlsFeatureView(const RegionFlowFeatureArrays& features)
+      : x(features.x.data(), features.size()),
+        y(features.y.data(), features.size()),
+        w(features.irls_weight.data(), features.size()),
+        mx(x + Eigen::Map<const Eigen::ArrayXf>(features.dx.data(),
+                                                features.size())),
+        my(y + Eigen::Map<const Eigen::ArrayXf>(features.dy.data(),
+                                                features.size())) {}
+
+  int size() const { return x.size(); }
+
+  // FeatureLocation.
+  Eigen::Map<const Eigen::ArrayXf> x;
+  Eigen::Map<const Eigen::ArrayXf> y;
+  // IRLS weight.
+  Eigen::Map<const Eigen::ArrayXf> w;
+  // FeatureMatchLocation.
+  Eigen::ArrayXf mx;
+  Eigen::ArrayXf my;
+
+  // Only set for mixture estimation: the row weight of each feature (one
+  // column per mixture model) and the scale applied to its irls weight by its
+  // patch descriptor (see GatherMixtureWeights).
+  Eigen::MatrixXf mix_weights;
+  Eigen::ArrayXf patch_scale;
+};
+
+// Indices of the monomials (x*x, x*y, y*y, x, y, 1) in WeightedMoments.
+enum Monomial { kXX = 0, kXY, kYY, kX, kY, kOne };
+
+// Returns the moments sum_i w_i * m_k(x_i, y_i) * f_ij for the monomials m_k
+// listed above and per feature factors f (one column per factor). These are
+// the entries of the normal equations of the linear models below, computed
+// as one matrix product over all features.
+template <class T, int NumFactors>
+Eigen::Matrix<T, 6, NumFactors> WeightedMoments(
+    const IrlsFeatureView& features,
+    const Eigen::Array<T, Eigen::Dynamic, 1>& w,
+    const Eigen::Matrix<T, Eigen::Dynamic, NumFactors>& factors) {
+  const Eigen::Array<T, Eigen::Dynamic, 1> x = features.x.cast<T>();
+  const Eigen::Array<T, Eigen::Dynamic, 1> y = features.y.cast<T>();
+  const Eigen::Array<T, Eigen::Dynamic, 1> xw = x * w;
+  const Eigen::Array<T, Eigen::Dynamic, 1> yw = y * w;
+
+  Eigen::Matrix<T, Eigen::Dynamic, 6> monomials(features.size(), 6);
+  monomials.col(kXX) = (x * xw).matrix();
+  monomials.col(kXY) = (x * yw).matrix();
+  monomials.col(kYY) = (y * yw).matrix();
+  monomials.col(kX) = xw.matrix();
+  monomials.col(kY) = yw.matrix();
+  monomials.col(kOne) = w.matrix();
+  return monomials.transpose() * factors;
+}
+
+// Returns the weights of all features, each scaled by the inverse of the
+// denominator of prev_solution at the feature's location, if specified (see
+// HomographyL2QRSolve).
+template <class T>
+Eigen::Array<T, Eigen::Dynamic, 1> HomographyFeatureWeights(
+    const IrlsFeatureView& features,
+    const Homography* prev_solution) {  // optional.
+  Eigen::Array<T, Eigen::Dynamic, 1> w = features.w.cast<T>();
+  if (prev_solution) {
+    const Eigen::Array<T, Eigen::Dynamic, 1> denom =
+        features.x.cast<T>() * static_cast<T>(prev_solution->h_20()) +
+        features.y.cast<T>() * static_cast<T>(prev_solution->h_21()) +
+        static_cast<T>(1);
+    w *= (denom.abs() > static_cast<T>(1e-5))
+             .select(denom.inverse(), static_cast<T>(0));
+  }
+  return w;
+}
+
+// Maps the entries of a column of a least squares system in the x (offset 0)
+// or y (offset 1) row of each feature, where feature i owns the rows 2 * i
+// and 2 * i + 1.
+template <class T>
+Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>, 0, Eigen::InnerStride<2>>
+FeatureRows(T* column, int offset, int num_features) {
+  return Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>, 0,
+                    Eigen::InnerStride<2>>(column + offset, num_features);
+}
+
+}  // namespace.
+
 bool MotionEstimation::EstimateAffineModelIRLS(
     int irls_rounds, RegionFlowFeatureList* feature_list,
     CameraMotion* camera_motion) const {
@@ -3648,40 +3742,44 @@ bool MotionEstimation::EstimateAffineModelIRLS(
 
   AffineModel* solved_model = camera_motion->mutable_affine();
 
-  // Multiple rounds of weighting based L2 optimization.
-  for (int i = 0; i < irls_rounds; ++i) {
-    // Build Jacobians.
-    for (const auto& feature : feature_list->feature()) {
-      const double w = feature.irls_weight();
-      const Vector2_f& pt_1 = FeatureLocation(feature);
-      const double x = pt_1.x() * w;
-      const double y = pt_1.y() * w;
-
-      Eigen::Matrix<double, 2, 6> jacobian =
-          Eigen::Matrix<double, 2, 6>::Zero();
-      jacobian(0, 0) = w;
-      jacobian(0, 2) = x;
-      jacobian(0, 3) = y;
-      jacobian(1, 1) = w;
-      jacobian(1, 4) = x;
-      jacobian(1, 5) = y;
+  RegionFlowFeatureArrays feature_arrays;
+  GetRegionFlowFeatureArrays(*feature_list, &feature_arrays);
+  const IrlsFeatureView features(feature_arrays);
+  Eigen::Matrix<double, Eigen::Dynamic, 3> factors(features.size(), 3);
+  factors.col(0).setOnes();
+  factors.col(1) = features.mx.cast<double>().matrix();
+  factors.col(2) = features.my.cast<double>().matrix();
 
-      // Update A.
-      // Compute J^t * J, where J = jacobian.
-      matrix = jacobian.transpose() * jacobian + matrix;
+  // Parameters (dx, a, b) and (dy, c, d) act on the x and y coordinate
+  // respectively, and share the same block of moments.
+  const int x_params[3] = {0, 2, 3};
+  const int y_params[3] = {1, 4, 5};
+  const Monomial block[3][3] = {{kOne, kX, kY}, {kX, kXX, kXY}, {kY, kXY, kYY}};
 
-      // Transform matched point.
-      const Vector2_f& pt_2 = FeatureMatchLocation(feature);
-      Eigen::Matrix<double, 2, 1> pt_2_mat(pt_2.x() * w, pt_2.y() * w);
-
-      // Compute J^t * y_i;
-      rhs = jacobian.transpose() * pt_2_mat + rhs;
+  // Multiple rounds of weighting based L2 optimization.
+  for (int i = 0; i < irls_rounds; ++i) {
+    // Each feature adds J^t * J and J^t * y, for its Jacobian
+    //   J = ( 1  0  x  y  0  0
+    //         0  1  0  0  x  y ) * w
+    // and y = (mx, my) * w, i.e. moments weighted by w^2.
+    const Eigen::ArrayXd w_sq = features.w.cast<double>().square();
+    const Eigen::Matrix<double, 6, 3> moments =
+        WeightedMoments<double, 3>(features, w_sq, factors);
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        matrix(x_params[r], x_params[c]) += moments(block[r][c], 0);
+        matrix(y_params[r], y_params[c]) += moments(block[r][c], 0);
+      }
+      rhs(x_params[r]) += moments(block[0][r], 1);
+      rhs(y_params[r]) += moments(block[0][r], 2);
     }
 
     // Solve A * p = b;
     Eigen::Matrix<double, 6, 1> p = Eigen::Matrix<double, 6, 1>::Zero();
     p = matrix.colPivHouseholderQr().solve(rhs);
     if (!(matrix * p).isApprox(rhs, kPrecision)) {
+      // Keep the weights of the previous rounds.
+      SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight, feature_list);
       camera_motion->set_flags(camera_motion->flags() |
                                CameraMotion::FLAG_SINGULAR_ESTIMATION);
       return false;
@@ -3696,22 +3794,28 @@ bool MotionEstimation::EstimateAffineModelIRLS(
     solved_model->set_d(p(5, 0));
 
     // Re-compute weights from errors.
-    for (auto& feature : *feature_list->mutable_feature()) {
-      if (feature.irls_weight() == 0.0f) {
+    for (int k = 0; k < feature_arrays.size(); ++k) {
+      float& irls_weight = feature_arrays.irls_weight[k];
+      if (irls_weight == 0.0f) {
         continue;
       }
 
-      const Vector2_f trans_location = AffineAdapter::TransformPoint(
-          *solved_model, FeatureLocation(feature));
-      const Vector2_f& matched_location = FeatureMatchLocation(feature);
+      const Vector2_f location(feature_arrays.x[k], feature_arrays.y[k]);
+      const Vector2_f trans_location =
+          AffineAdapter::TransformPoint(*solved_model, location);
+      const Vector2_f matched_location(
+          location.x() + feature_arrays.dx[k],
+          location.y() + feature_arrays.dy[k]);
 
       // Express residual in frame coordinates.
       const Vector2_f residual = LinearSimilarityAdapter::TransformPoint(
           irls_transform_, trans_location - matched_location);
 
-      feature.set_irls_weight(sqrt(1.0 / (residual.Norm() + kIrlsEps)));
+      irls_weight = sqrt(1.0 / (residual.Norm() + kIrlsEps));
     }
   }
+  // Write the weights of the last round back to the features.
+  SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight, feature_list);
 
   // Express in original frame coordinate system.
   *solved_model = ModelCompose3(
@@ -3754,7 +3858,7 @@ bool MotionEstimation::EstimateAffineModelIRLS(
 // Returns false if system could not be solved for.
 template <class T>
 bool HomographyL2QRSolve(
-    const RegionFlowFeatureList& feature_list,
+    const IrlsFeatureView& features,
     const Homography* prev_solution,  // optional.
     float perspective_regularizer,
     Eigen::Matrix<T, Eigen::Dynamic, 8>* matrix,  // tmp matrix
@@ -3762,8 +3866,9 @@ bool HomographyL2QRSolve(
   CHECK(matrix);
   CHECK(solution);
   CHECK_EQ(8, matrix->cols());
+  const int num_features = features.size();
   const int num_rows =
-      2 * feature_list.feature_size() + (perspective_regularizer == 0 ? 0 : 1);
+      2 * num_features + (perspective_regularizer == 0 ? 0 : 1);
   CHECK_EQ(num_rows, matrix->rows());
   CHECK_EQ(1, solution->cols());
   CHECK_EQ(8, solution->rows());
@@ -3773,58 +3878,48 @@ bool HomographyL2QRSolve(
   Eigen::Matrix<T, Eigen::Dynamic, 1> rhs =
       Eigen::Matrix<T, Eigen::Dynamic, 1>::Zero(matrix->rows(), 1);
 
-  if (RegionFlowFeatureIRLSSum(feature_list) > kMaxCondition) {
+  if (features.w.cast<double>().sum() > kMaxCondition) {
     return false;
   }
 
-  // Create matrix and rhs (using h_33 = 1 constraint).
-  int feature_idx = 0;
-  for (auto feature = feature_list.feature().begin();
-       feature != feature_list.feature().end(); ++feature, ++feature_idx) {
-    int feature_row = 2 * feature_idx;
-
-    Vector2_f pt = FeatureLocation(*feature);
-    Vector2_f prev_pt = FeatureMatchLocation(*feature);
-    // Weight per feature.
-    double scale = 1.0;
-    if (prev_solution) {
-      const double denom =
-          prev_solution->h_20() * pt.x() + prev_solution->h_21() * pt.y() + 1.0;
-      if (fabs(denom) > 1e-5) {
-        scale /= denom;
-      } else {
-        scale = 0;
-      }
-    }
-
-    const float w = feature->irls_weight() * scale;
+  // Weight per feature.
+  const Eigen::Array<T, Eigen::Dynamic, 1> w =
+      HomographyFeatureWeights<T>(features, prev_solution);
 
-    // Scale feature with weight;
-    Vector2_f pt_w = pt * w;
+  // Scale features with weight.
+  const Eigen::Array<T, Eigen::Dynamic, 1> x_w = features.x.cast<T>() * w;
+  const Eigen::Array<T, Eigen::Dynamic, 1> y_w = features.y.cast<T>() * w;
+  const Eigen::Array<T, Eigen::Dynamic, 1> mx = features.mx.cast<T>();
+  const Eigen::Array<T, Eigen::Dynamic, 1> my = features.my.cast<T>();
 
-    // Row 1 of above J:
-    (*matrix)(feature_row, 0) = pt_w.x();
-    (*matrix)(feature_row, 1) = pt_w.y();
-    (*matrix)(feature_row, 2) = w;
-
-    // Entry 3 .. 5 equal zero.
-    (*matrix)(feature_row, 6) = -pt_w.x() * prev_pt.x();
-    (*matrix)(feature_row, 7) = -pt_w.y() * prev_pt.x();
-    rhs(feature_row, 0) = prev_pt.x() * w;
-
-    // Row 2 of above J:
-    // Entry 0 .. 2 equal zero.
-    (*matrix)(feature_row + 1, 3) = pt_w.x();
-    (*matrix)(feature_row + 1, 4) = pt_w.y();
-    (*matrix)(feature_row + 1, 5) = w;
+  // Create matrix and rhs (using h_33 = 1 constraint), column by column.
+  const auto x_row = [matrix, num_features](int col) {
+    return FeatureRows(matrix->col(col).data(), 0, num_features);
+  };
+  const auto y_row = [matrix, num_features](int col) {
+    return FeatureRows(matrix->col(col).data(), 1, num_features);
+  };
 
-    (*matrix)(feature_row + 1, 6) = -pt_w.x() * prev_pt.y();
-    (*matrix)(feature_row + 1, 7) = -pt_w.y() * prev_pt.y();
-    rhs(feature_row + 1, 0) = prev_pt.y() * w;
-  }
+  // Row 1 of above J:
+  x_row(0) = x_w;
+  x_row(1) = y_w;
+  x_row(2) = w;
+  // Entry 3 .. 5 equal zero.
+  x_row(6) = -x_w * mx;
+  x_row(7) = -y_w * mx;
+  FeatureRows(rhs.data(), 0, num_features) = mx * w;
+
+  // Row 2 of above J:
+  // Entry 0 .. 2 equal zero.
+  y_row(3) = x_w;
+  y_row(4) = y_w;
+  y_row(5) = w;
+  y_row(6) = -x_w * my;
+  y_row(7) = -y_w * my;
+  FeatureRows(rhs.data(), 1, num_features) = my * w;
 
   if (perspective_regularizer > 0) {
-    int last_row_idx = 2 * feature_list.feature_size();
+    int last_row_idx = 2 * num_features;
     (*matrix)(last_row_idx, 6) = (*matrix)(last_row_idx, 7) =
         perspective_regularizer;
   }
@@ -3843,7 +3938,7 @@ bool HomographyL2QRSolve(
 // Template class T specifies the desired accuracy, use float or double.
 template <class T>
 Homography HomographyL2NormalEquationSolve(
-    const RegionFlowFeatureList& feature_list,
+    const IrlsFeatureView& features,
     const Homography* prev_solution,  // optional.
     float perspective_regularizer, Eigen::Matrix<T, 8, 8>* matrix,
     Eigen::Matrix<T, 8, 1>* rhs, Eigen::Matrix<T, 8, 1>* solution,
@@ -3852,133 +3947,63 @@ Homography HomographyL2NormalEquationSolve(
   CHECK(rhs != nullptr);
   CHECK(solution != nullptr);
 
-  *matrix = Eigen::Matrix<T, 8, 8>::Zero();
-  *rhs = Eigen::Matrix<T, 8, 1>::Zero();
-
-  // Matrix multiplications are hand-coded for speed improvements vs.
-  // opencv's cvGEMM calls.
-  for (const auto& feature : feature_list.feature()) {
-    T scale = 1.0;
-    if (prev_solution) {
-      const T denom = prev_solution->h_20() * feature.x() +
-                      prev_solution->h_21() * feature.y() + 1.0;
-      if (fabs(denom) > 1e-5) {
-        scale /= denom;
-      } else {
-        scale = 0;
-      }
-    }
-    const T w = feature.irls_weight() * scale;
-    const T x = feature.x();
-    const T y = feature.y();
-    const T xw = x * w;
-    const T yw = y * w;
-    const T xxw = x * x * w;
-    const T yyw = y * y * w;
-    const T xyw = x * y * w;
-    const T mx = feature.x() + feature.dx();
-    const T my = feature.y() + feature.dy();
-
-    const T mxxyy = mx * mx + my * my;
-    // Jacobian
-    // double J[2 * 8] = {x, y, 1,  0,  0,   0, -x * m_x, -y * m_x,
-    //                   {0, 0, 0,  x,  y,   1, -x * m_y, -y * m_y}
-    //
-    // // Compute J^t * J * w =
-    // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
-    // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
-    // ( x         y     1      0       0    0     -x*mx   -y*mx    )
-    // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
-    // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
-    // ( 0         0     0      x      y     1     -x*my   -y*my    )
-    // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
-    // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
-
-    // 1st row:  xx        xy    x      0       0    0    -xx*mx  -xy*mx
-    T* matrix_ptr = matrix->data();
-    matrix_ptr[0] += xxw;
-    matrix_ptr[1] += xyw;
-    matrix_ptr[2] += xw;
-    matrix_ptr[6] += -xxw * mx;
-    matrix_ptr[7] += -xyw * mx;
-
-    // 2nd row:  xy       yy   y      0       0    0    -xy*mx  -yy*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xyw;
-    matrix_ptr[1] += yyw;
-    matrix_ptr[2] += yw;
-    matrix_ptr[6] += -xyw * mx;
-    matrix_ptr[7] += -yyw * mx;
-
-    // 3rd row: x         y     1      0       0    0     -x*mx   -y*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xw;
-    matrix_ptr[1] += yw;
-    matrix_ptr[2] += w;
-    matrix_ptr[6] += -xw * mx;
-    matrix_ptr[7] += -yw * mx;
-
-    // 4th row: 0         0     0     xx      xy    x    -xx*my  -xy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xxw;
-    matrix_ptr[4] += xyw;
-    matrix_ptr[5] += xw;
-    matrix_ptr[6] += -xxw * my;
-    matrix_ptr[7] += -xyw * my;
-
-    // 5th row: 0         0     0     xy      yy    y    -xy*my  -yy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xyw;
-    matrix_ptr[4] += yyw;
-    matrix_ptr[5] += yw;
-    matrix_ptr[6] += -xyw * my;
-    matrix_ptr[7] += -yyw * my;
-
-    // 6th row:  0         0     0     x     y     1      -x*my    -y*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xw;
-    matrix_ptr[4] += yw;
-    matrix_ptr[5] += w;
-    matrix_ptr[6] += -xw * my;
-    matrix_ptr[7] += -yw * my;
+  // Jacobian per feature
+  // J = (x, y, 1,  0,  0,   0, -x * mx, -y * mx,
+  //      0, 0, 0,  x,  y,   1, -x * my, -y * my)
+  //
+  // Compute J^t * J * w =
+  // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
+  // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
+  // ( x         y     1      0       0    0     -x*mx   -y*mx    )
+  // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
+  // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
+  // ( 0         0     0      x      y     1     -x*my   -y*my    )
+  // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
+  // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
+  //
+  // with mxxyy = mx * mx + my * my, summed over all features. It is composed
+  // of the 3x3 block
+  // B(f) = ( xx  xy  x
+  //          xy  yy  y
+  //          x   y   1 ) * w * f
+  // for the factors f = 1, mx, my and mxxyy.
+  const Eigen::Array<T, Eigen::Dynamic, 1> w =
+      HomographyFeatureWeights<T>(features, prev_solution);
+  const Eigen::Array<T, Eigen::Dynamic, 1> mx = features.mx.cast<T>();
+  const Eigen::Array<T, Eigen::Dynamic, 1> my = features.my.cast<T>();
+  Eigen::Matrix<T, Eigen::Dynamic, 4> factors(features.size(), 4);
+  factors.col(0).setOnes();
+  factors.col(1) = mx.matrix();
+  factors.col(2) = my.matrix();
+  factors.col(3) = (mx * mx + my * my).matrix();
+  const Eigen::Matrix<T, 6, 4> moments =
+      WeightedMoments<T, 4>(features, w, factors);
+
+  const auto block = [&moments](int f) {
+    Eigen::Matrix<T, 3, 3> result;
+    result << moments(kXX, f), moments(kXY, f), moments(kX, f),
+        moments(kXY, f), moments(kYY, f), moments(kY, f), moments(kX, f),
+        moments(kY, f), moments(kOne, f);
+    return result;
+  };
 
-    // 7th row:  -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xxw * mx;
-    matrix_ptr[1] += -xyw * mx;
-    matrix_ptr[2] += -xw * mx;
-    matrix_ptr[3] += -xxw * my;
-    matrix_ptr[4] += -xyw * my;
-    matrix_ptr[5] += -xw * my;
-    matrix_ptr[6] += xxw * mxxyy;
-    matrix_ptr[7] += xyw * mxxyy;
-
-    // 8th row: -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xyw * mx;
-    matrix_ptr[1] += -yyw * mx;
-    matrix_ptr[2] += -yw * mx;
-    matrix_ptr[3] += -xyw * my;
-    matrix_ptr[4] += -yyw * my;
-    matrix_ptr[5] += -yw * my;
-    matrix_ptr[6] += xyw * mxxyy;
-    matrix_ptr[7] += yyw * mxxyy;
-
-    // Right hand side:
-    // b = ( x
-    //       y )
-    // Compute J^t * b  * w =
-    // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
-    T* rhs_ptr = rhs->data();
-    rhs_ptr[0] += xw * mx;
-    rhs_ptr[1] += yw * mx;
-    rhs_ptr[2] += mx * w;
-    rhs_ptr[3] += xw * my;
-    rhs_ptr[4] += yw * my;
-    rhs_ptr[5] += my * w;
-    rhs_ptr[6] += -xw * mxxyy;
-    rhs_ptr[7] += -yw * mxxyy;
-  }
+  matrix->setZero();
+  matrix->template block<3, 3>(0, 0) = block(0);
+  matrix->template block<3, 3>(3, 3) = block(0);
+  matrix->template block<3, 2>(0, 6) = -block(1).template leftCols<2>();
+  matrix->template block<3, 2>(3, 6) = -block(2).template leftCols<2>();
+  matrix->template block<2, 6>(6, 0) =
+      matrix->template block<6, 2>(0, 6).transpose();
+  matrix->template block<2, 2>(6, 6) =
+      block(3).template topLeftCorner<2, 2>();
+
+  // Right hand side:
+  // b = ( mx
+  //       my )
+  // Compute J^t * b  * w =
+  // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
+  *rhs << moments(kX, 1), moments(kY, 1), moments(kOne, 1), moments(kX, 2),
+      moments(kY, 2), moments(kOne, 2), -moments(kX, 3), -moments(kY, 3);
 
   if (perspective_regularizer > 0) {
     // Additional constraint:
@@ -4028,9 +4053,9 @@ Homography HomographyL2NormalEquationSolve(
 
 namespace {
 
-float PatchDescriptorIRLSWeight(const RegionFlowFeature& feature) {
-  float weight = feature.irls_weight();
-
+// Returns the scale applied to a feature's irls weight by its patch
+// descriptor.
+float PatchDescriptorWeightScale(const RegionFlowFeature& feature) {
   // Blend weight to combine irls weight with a feature's path standard
   // deviation.
   const float alpha = 0.7f;
@@ -4042,33 +4067,54 @@ float PatchDescriptorIRLSWeight(const RegionFlowFeature& feature) {
       PatchDescriptorColorStdevL1(feature.feature_descriptor());
 
   if (feature_stdev_l1 >= 0.0f) {
-    weight *= alpha + (1.f - alpha) * std::min(1.f, feature_stdev_l1 * denom);
+    return alpha + (1.f - alpha) * std::min(1.f, feature_stdev_l1 * denom);
   }
 
-  return weight;
+  return 1.0f;
+}
+
+// Sets the row weights and patch descriptor scales of all features in
+// feature_list, used by the mixture solvers below.
+void GatherMixtureWeights(const RegionFlowFeatureList& feature_list,
+                          const MixtureRowWeights& row_weights,
+                          IrlsFeatureView* features) {
+  const int num_features = feature_list.feature_size();
+  const int num_models = row_weights.NumModels();
+  features->mix_weights.resize(num_features, num_models);
+  features->patch_scale.resize(num_features);
+  int feature_idx = 0;
+  for (const auto& feature : feature_list.feature()) {
+    features->mix_weights.row(feature_idx) =
+        Eigen::Map<const Eigen::RowVectorXf>(
+            row_weights.RowWeightsClamped(feature.y()), num_models);
+    features->patch_scale[feature_idx] = PatchDescriptorWeightScale(feature);
+    ++feature_idx;
+  }
 }
 
 // Extension of above function to evenly spaced row-mixture models.
 bool MixtureHomographyL2DLTSolve(
-    const RegionFlowFeatureList& feature_list, int num_models,
-    const MixtureRowWeights& row_weights, float regularizer_lambda,
+    const IrlsFeatureView& features, int num_models,
+    float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
   CHECK(solution);
+  CHECK_EQ(features.mix_weights.cols(), num_models);
 
   // cv::solve can hang for really bad conditioned systems.
-  const double feature_irls_sum = RegionFlowFeatureIRLSSum(feature_list);
+  const double feature_irls_sum = features.w.cast<double>().sum();
   if (feature_irls_sum > kMaxCondition) {
     return false;
   }
 
+  const int num_features = features.size();
   const int num_dof = 8 * num_models;
   const int num_constraints = num_dof - 8;
 
   CHECK_EQ(matrix->cols(), num_dof);
   // 2 Rows (x,y) per feature.
-  CHECK_EQ(matrix->rows(), 2 * feature_list.feature_size() + num_constraints);
+  CHECK_EQ(matrix->rows(), 2 * num_features + num_constraints);
   CHECK_EQ(solution->cols(), 1);
   CHECK_EQ(solution->rows(), num_dof);
 
@@ -4081,25 +4127,28 @@ bool MixtureHomographyL2DLTSolve(
   float irls_denom = 1.0 / (feature_irls_sum + 1e-6);
 
   // Create matrix for DLT.
-  int feature_idx = 0;
-  for (auto feature = feature_list.feature().begin();
-       feature != feature_list.feature().end(); ++feature, ++feature_idx) {
+  // NOTE: The entries of each feature are addressed through the data pointer
+  // of its row. For the column major matrix that pointer steps down column 0
+  // instead of along the row, so this is not the system written out in the
+  // comments. The layout is kept as is (and not vectorized like the solvers
+  // above), since the estimated mixtures and their stability depend on it.
+  for (int feature_idx = 0; feature_idx < num_features; ++feature_idx) {
     float* mat_row_1 = matrix->row(2 * feature_idx).data();
     float* mat_row_2 = matrix->row(2 * feature_idx + 1).data();
     float* rhs_row_1 = rhs.row(2 * feature_idx).data();
     float* rhs_row_2 = rhs.row(2 * feature_idx + 1).data();
 
-    Vector2_f pt = FeatureLocation(*feature);
-    Vector2_f prev_pt = FeatureMatchLocation(*feature);
+    const Vector2_f pt(features.x[feature_idx], features.y[feature_idx]);
+    const Vector2_f prev_pt(features.mx[feature_idx], features.my[feature_idx]);
     // Weight per feature.
-    const float f_w = PatchDescriptorIRLSWeight(*feature) * irls_denom;
+    const float f_w = features.w[feature_idx] *
+                      features.patch_scale[feature_idx] * irls_denom;
 
-    // Scale feature point by weight;
+    // Scale feature point by weight.
     Vector2_f pt_w = pt * f_w;
-    const float* mix_weights = row_weights.RowWeightsClamped(feature->y());
 
     for (int m = 0; m < num_models; ++m, mat_row_1 += 8, mat_row_2 += 8) {
-      const float w = mix_weights[m];
+      const float w = features.mix_weights(feature_idx, m);
       // Entries 0 .. 2 are zero.
       mat_row_1[3] = -pt_w.x() * w;
       mat_row_1[4] = -pt_w.y() * w;
@@ -4126,7 +4175,7 @@ bool MixtureHomographyL2DLTSolve(
   // to roughly obtain similar magnitudes across parameters.
   const float param_weights[8] = {1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 100.f, 100.f};
 
-  const int reg_row_start = 2 * feature_list.feature_size();
+  const int reg_row_start = 2 * num_features;
   for (int m = 0; m < num_models - 1; ++m) {
     for (int p = 0; p < 8; ++p) {
       const int curr_idx = m * 8 + p;
@@ -4146,25 +4195,27 @@ bool MixtureHomographyL2DLTSolve(
 // strictly affine and perspective part (4 + 2 = 6 DOF) being constant across
 // the mixtures.
 bool TransMixtureHomographyL2DLTSolve(
-    const RegionFlowFeatureList& feature_list, int num_models,
-    const MixtureRowWeights& row_weights, float regularizer_lambda,
+    const IrlsFeatureView& features, int num_models,
+    float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
   CHECK(solution);
+  CHECK_EQ(features.mix_weights.cols(), num_models);
 
   // cv::solve can hang for really bad conditioned systems.
-  const double feature_irls_sum = RegionFlowFeatureIRLSSum(feature_list);
+  const double feature_irls_sum = features.w.cast<double>().sum();
   if (feature_irls_sum > kMaxCondition) {
     return false;
   }
 
+  const int num_features = features.size();
   const int num_dof = 6 + 2 * num_models;
   const int num_constraints = 2 * (num_models - 1);
 
   CHECK_EQ(matrix->cols(), num_dof);
   // 2 Rows (x,y) per feature.
-  CHECK_EQ(matrix->rows(), 2 * feature_list.feature_size() + num_constraints);
+  CHECK_EQ(matrix->rows(), 2 * num_features + num_constraints);
   CHECK_EQ(solution->cols(), 1);
   CHECK_EQ(solution->rows(), num_dof);
 
@@ -4173,28 +4224,26 @@ bool TransMixtureHomographyL2DLTSolve(
   Eigen::Matrix<float, Eigen::Dynamic, 1> rhs =
       Eigen::MatrixXf::Zero(matrix->rows(), 1);
 
-  // Create matrix for DLT.
-  int feature_idx = 0;
-
   // Normalize feature sum to 1.
   float irls_denom = 1.0 / (feature_irls_sum + 1e-6);
 
-  for (auto feature = feature_list.feature().begin();
-       feature != feature_list.feature().end(); ++feature, ++feature_idx) {
+  // Create matrix for DLT. Same row pointer layout as in
+  // MixtureHomographyL2DLTSolve.
+  for (int feature_idx = 0; feature_idx < num_features; ++feature_idx) {
     float* mat_row_1 = matrix->row(2 * feature_idx).data();
     float* mat_row_2 = matrix->row(2 * feature_idx + 1).data();
     float* rhs_row_1 = rhs.row(2 * feature_idx).data();
     float* rhs_row_2 = rhs.row(2 * feature_idx + 1).data();
 
-    Vector2_f pt = FeatureLocation(*feature);
-    Vector2_f prev_pt = FeatureMatchLocation(*feature);
+    const Vector2_f pt(features.x[feature_idx], features.y[feature_idx]);
+    const Vector2_f prev_pt(features.mx[feature_idx], features.my[feature_idx]);
 
     // Weight per feature.
-    const float f_w = PatchDescriptorIRLSWeight(*feature) * irls_denom;
+    const float f_w = features.w[feature_idx] *
+                      features.patch_scale[feature_idx] * irls_denom;
 
     // Scale feature point by weight.
     Vector2_f pt_w = pt * f_w;
-    const float* mix_weights = row_weights.RowWeightsClamped(feature->y());
 
     // Entries 0 .. 1 are zero.
     mat_row_1[2] = -pt_w.x();
@@ -4215,7 +4264,7 @@ bool TransMixtureHomographyL2DLTSolve(
     rhs_row_2[0] = prev_pt.x() * f_w;
 
     for (int m = 0; m < num_models; ++m, mat_row_1 += 2, mat_row_2 += 2) {
-      const float w = mix_weights[m];
+      const float w = features.mix_weights(feature_idx, m);
       mat_row_1[6] = 0;
       mat_row_1[7] = -f_w * w;
 
@@ -4224,7 +4273,7 @@ bool TransMixtureHomographyL2DLTSolve(
     }
   }
 
-  const int reg_row_start = 2 * feature_list.feature_size();
+  const int reg_row_start = 2 * num_features;
   int constraint_idx = 0;
   for (int m = 0; m < num_models - 1; ++m) {
     for (int p = 0; p < 2; ++p, ++constraint_idx) {
@@ -4245,25 +4294,27 @@ bool TransMixtureHomographyL2DLTSolve(
 // of size num_models, with scale and perspective part (2 + 2 = 4 DOF) being
 // constant across the mixtures.
 bool SkewRotMixtureHomographyL2DLTSolve(
-    const RegionFlowFeatureList& feature_list, int num_models,
-    const MixtureRowWeights& row_weights, float regularizer_lambda,
+    const IrlsFeatureView& features, int num_models,
+    float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
   CHECK(solution);
+  CHECK_EQ(features.mix_weights.cols(), num_models);
 
   // cv::solve can hang for really bad conditioned systems.
-  const double feature_irls_sum = RegionFlowFeatureIRLSSum(feature_list);
+  const double feature_irls_sum = features.w.cast<double>().sum();
   if (feature_irls_sum > kMaxCondition) {
     return false;
   }
 
+  const int num_features = features.size();
   const int num_dof = 4 + 4 * num_models;
   const int num_constraints = 4 * (num_models - 1);
 
   CHECK_EQ(matrix->cols(), num_dof);
   // 2 Rows (x,y) per feature.
-  CHECK_EQ(matrix->rows(), 2 * feature_list.feature_size() + num_constraints);
+  CHECK_EQ(matrix->rows(), 2 * num_features + num_constraints);
   CHECK_EQ(solution->cols(), 1);
   CHECK_EQ(solution->rows(), num_dof);
 
@@ -4272,61 +4323,54 @@ bool SkewRotMixtureHomographyL2DLTSolve(
   Eigen::Matrix<float, Eigen::Dynamic, 1> rhs =
       Eigen::MatrixXf::Zero(matrix->rows(), 1);
 
-  // Create matrix for DLT.
-  int feature_idx = 0;
-
   // Normalize feature sum to 1.
   float irls_denom = 1.0 / (feature_irls_sum + 1e-6);
 
-  for (auto feature = feature_list.feature().begin();
-       feature != feature_list.feature().end(); ++feature, ++feature_idx) {
-    Vector2_f pt = FeatureLocation(*feature);
-    Vector2_f prev_pt = FeatureMatchLocation(*feature);
+  // Weight per feature.
+  const Eigen::ArrayXf f_w = features.w * features.patch_scale * irls_denom;
 
-    // Weight per feature.
-    const float f_w = PatchDescriptorIRLSWeight(*feature) * irls_denom;
+  // Scale feature points by weight.
+  const Eigen::ArrayXf x_w = features.x * f_w;
+  const Eigen::ArrayXf y_w = features.y * f_w;
 
-    // Scale feature point by weight.
-    Vector2_f pt_w = pt * f_w;
-    const float* mix_weights = row_weights.RowWeightsClamped(feature->y());
+  // Create matrix for DLT, column by column.
+  const auto x_row = [matrix, num_features](int col) {
+    return FeatureRows(matrix->col(col).data(), 0, num_features);
+  };
+  const auto y_row = [matrix, num_features](int col) {
+    return FeatureRows(matrix->col(col).data(), 1, num_features);
+  };
 
-    // Compare to MixtureHomographyDLTSolve.
-    // Mapping of parameters (from homography to mixture) is as follows:
-    //       0 1 2 3 4 5 6 7
-    //  -->  0 4 6 5 1 7 2 3
+  // Weights sum to one (-> take out of loop).
+  FeatureRows(rhs.data(), 0, num_features) = -features.my * f_w;
+  FeatureRows(rhs.data(), 1, num_features) = features.mx * f_w;
 
-    int feature_row = 2 * feature_idx;
-    // Entry 0 is zero.
-    // Skew is in mixture.
-    (*matrix)(feature_row, 1) = -pt_w.y();
-    (*matrix)(feature_row, 2) = pt_w.x() * prev_pt.y();
-    (*matrix)(feature_row, 3) = pt_w.y() * prev_pt.y();
+  // Compare to MixtureHomographyDLTSolve.
+  // Mapping of parameters (from homography to mixture) is as follows:
+  //       0 1 2 3 4 5 6 7
+  //  -->  0 4 6 5 1 7 2 3
 
-    (*matrix)(feature_row + 1, 0) = pt_w.x();
-    // Entry 1 is zero.
-    (*matrix)(feature_row + 1, 2) = -pt_w.x() * prev_pt.x();
-    (*matrix)(feature_row + 1, 3) = -pt_w.y() * prev_pt.x();
+  // Entry 0 is zero.
+  // Skew is in mixture.
+  x_row(1) = -y_w;
+  x_row(2) = x_w * features.my;
+  x_row(3) = y_w * features.my;
 
-    // Weights sum to one (-> take out of loop).
-    rhs(feature_row, 0) = -prev_pt.y() * f_w;
-    rhs(feature_row + 1, 0) = prev_pt.x() * f_w;
+  y_row(0) = x_w;
+  // Entry 1 is zero.
+  y_row(2) = -x_w * features.mx;
+  y_row(3) = -y_w * features.mx;
 
-    // Is this right?
-    for (int m = 0; m < num_models; ++m) {
-      const float w = mix_weights[m];
-      (*matrix)(feature_row, 4 + 4 * m) = 0.0f;
-      (*matrix)(feature_row, 5 + 4 * m) = -pt_w.x() * w;  // Skew.
-      (*matrix)(feature_row, 6 + 4 * m) = 0.0f;
-      (*matrix)(feature_row, 7 + 4 * m) = -f_w * w;
+  for (int m = 0; m < num_models; ++m) {
+    const Eigen::ArrayXf w = features.mix_weights.col(m).array();
+    x_row(5 + 4 * m) = -x_w * w;  // Skew.
+    x_row(7 + 4 * m) = -f_w * w;
 
-      (*matrix)(feature_row + 1, 4 + 4 * m) = pt_w.y() * w;
-      (*matrix)(feature_row + 1, 5 + 4 * m) = 0.0f;  // Translation.
-      (*matrix)(feature_row + 1, 6 + 4 * m) = f_w * w;
-      (*matrix)(feature_row + 1, 7 + 4 * m) = 0.0f;
-    }
+    y_row(4 + 4 * m) = y_w * w;
+    y_row(6 + 4 * m) = f_w * w;  // Translation.
   }
 
-  const int reg_row_start = 2 * feature_list.feature_size();
+  const int reg_row_start = 2 * num_features;
   int constraint_idx = 0;
   for (int m = 0; m < num_models - 1; ++m) {
     for (int p = 0; p < 4; ++p, ++constraint_idx) {
@@ -4342,6 +4386,29 @@ bool SkewRotMixtureHomographyL2DLTSolve(
   return ((*matrix) * (*solution)).isApprox(rhs, kPrecision);
 }
 
+// Returns the number of degrees of freedom and of adjacency constraints of
+// the mixture system solved for mixture_mode.
+void MixtureSystemSize(MotionEstimationOptions::MixtureModelMode mixture_mode,
+                       int num_mixtures, int* num_dof,
+                       int* adjacency_constraints) {
+  switch (mixture_mode) {
+    case MotionEstimationOptions::FULL_MIXTURE:
+      *num_dof = 8 * num_mixtures;
+      *adjacency_constraints = 8 * (num_mixtures - 1);
+      break;
+    case MotionEstimationOptions::TRANSLATION_MIXTURE:
+      *num_dof = 6 + 2 * num_mixtures;
+      *adjacency_constraints = 2 * (num_mixtures - 1);
+      break;
+    case MotionEstimationOptions::SKEW_ROTATION_MIXTURE:
+      *num_dof = 4 + 4 * num_mixtures;
+      *adjacency_constraints = 4 * (num_mixtures - 1);
+      break;
+    default:
+      LOG(FATAL) << "Unknown MixtureModelMode specified.";
+  }
+}
+
 }  // namespace.
 
 // For plot example for IRLS_WEIGHT_PERIMITER_GAUSSIAN, see: goo.gl/fNzQc
@@ -4941,16 +5008,23 @@ bool MotionEstimation::EstimateHomographyIRLS(
     prev_solution = &norm_model;
   }
 
+  RegionFlowFeatureArrays feature_arrays;
+  GetRegionFlowFeatureArrays(*feature_list, &feature_arrays);
+  const IrlsFeatureView features(feature_arrays);
+
   for (int r = 0; r < irls_rounds; ++r) {
     if (options_.use_exact_homography_estimation()) {
       bool success = false;
 
       success = HomographyL2QRSolve<float>(
-          *feature_list, prev_solution,
+          features, prev_solution,
           options_.homography_perspective_regularizer(), &matrix_e,
           &solution_e);
       if (!success) {
         VLOG(1) << "Could not solve for homography.";
+        // Keep the weights of the previous rounds.
+        SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight,
+                                        feature_list);
         *camera_motion->mutable_homography() = Homography();
         camera_motion->set_flags(camera_motion->flags() |
                                  CameraMotion::FLAG_SINGULAR_ESTIMATION);
@@ -4963,18 +5037,21 @@ bool MotionEstimation::EstimateHomographyIRLS(
       if (options_.use_highest_accuracy_for_normal_equations()) {
         CHECK(!use_float);
         norm_model = HomographyL2NormalEquationSolve<double>(
-            *feature_list, prev_solution,
+            features, prev_solution,
             options_.homography_perspective_regularizer(), &matrix_d, &rhs_d,
             &solution_d, &success);
       } else {
         CHECK(use_float);
         norm_model = HomographyL2NormalEquationSolve<float>(
-            *feature_list, prev_solution,
+            features, prev_solution,
             options_.homography_perspective_regularizer(), &matrix_f, &rhs_f,
             &solution_f, &success);
       }
       if (!success) {
         VLOG(1) << "Could not solve for homography.";
+        // Keep the weights of the previous rounds.
+        SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight,
+                                        feature_list);
         *camera_motion->mutable_homography() = Homography();
         camera_motion->set_flags(camera_motion->flags() |
                                  CameraMotion::FLAG_SINGULAR_ESTIMATION);
@@ -4986,24 +5063,24 @@ bool MotionEstimation::EstimateHomographyIRLS(
     const float one_minus_alpha = 1.0f - alpha;
 
     // Compute weights from registration errors.
-    const auto feature_start = feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != feature_list->mutable_feature()->end(); ++feature) {
+    for (int k = 0; k < feature_arrays.size(); ++k) {
+      float& irls_weight = feature_arrays.irls_weight[k];
       // Ignored features marked as outliers.
-      if (feature->irls_weight() == 0.0f) {
+      if (irls_weight == 0.0f) {
         continue;
       }
 
       // Residual is expressed as geometric difference, that is
       // for a point match (p<->q) with estimated homography p,
       // geometric difference is defined as Hp x q.
-      Vector2_f lhs = HomographyAdapter::TransformPoint(
-          norm_model, FeatureLocation(*feature));
+      const Vector2_f location(feature_arrays.x[k], feature_arrays.y[k]);
+      Vector2_f lhs = HomographyAdapter::TransformPoint(norm_model, location);
       // Map to original coordinate system to evaluate error.
       lhs = LinearSimilarityAdapter::TransformPoint(irls_transform_, lhs);
       const Vector3_f lhs3(lhs.x(), lhs.y(), 1);
       const Vector2_f rhs = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, FeatureMatchLocation(*feature));
+          irls_transform_, Vector2_f(location.x() + feature_arrays.dx[k],
+                                     location.y() + feature_arrays.dy[k]));
 
       const Vector3_f rhs3(rhs.x(), rhs.y(), 1);
       const Vector3_f cross = lhs3.CrossProd(rhs3);
@@ -5012,20 +5089,21 @@ bool MotionEstimation::EstimateHomographyIRLS(
 
       const float numerator =
           alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
+                        : ((*irls_priors)[k] * alpha + one_minus_alpha);
 
       if (irls_use_l0_norm) {
-        feature->set_irls_weight(
-            numerator / (cross2.Norm() * irls_residual_scale + kIrlsEps));
+        irls_weight =
+            numerator / (cross2.Norm() * irls_residual_scale + kIrlsEps);
       } else {
-        feature->set_irls_weight(
+        irls_weight =
             numerator / (std::sqrt(static_cast<double>(cross2.Norm() *
                                                        irls_residual_scale)) +
-                         kIrlsEps));
+                         kIrlsEps);
       }
     }
   }
+  // Write the weights of the last round back to the features.
+  SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight, feature_list);
 
   // Undo pre_transform.
   Homography* model = camera_motion->mutable_homography();
@@ -5095,22 +5173,8 @@ bool MotionEstimation::MixtureHomographyFromFeature(
       options_.mixture_model_mode();
   int num_dof = 0;
   int adjacency_constraints = 0;
-  switch (mixture_mode) {
-    case MotionEstimationOptions::FULL_MIXTURE:
-      num_dof = 8 * num_mixtures;
-      adjacency_constraints = 8 * (num_mixtures - 1);
-      break;
-    case MotionEstimationOptions::TRANSLATION_MIXTURE:
-      num_dof = 6 + 2 * num_mixtures;
-      adjacency_constraints = 2 * (num_mixtures - 1);
-      break;
-    case MotionEstimationOptions::SKEW_ROTATION_MIXTURE:
-      num_dof = 4 + 4 * num_mixtures;
-      adjacency_constraints = 4 * (num_mixtures - 1);
-      break;
-    default:
-      LOG(FATAL) << "Unknown MixtureModelMode specified.";
-  }
+  MixtureSystemSize(mixture_mode, num_mixtures, &num_dof,
+                    &adjacency_constraints);
 
   Eigen::MatrixXf matrix(
       2 * feature_list->feature_size() + adjacency_constraints, num_dof);
@@ -5134,6 +5198,11 @@ bool MotionEstimation::MixtureHomographyFromFeature(
     irls_alphas = &prior_weights->alphas;
   }
 
+  RegionFlowFeatureArrays feature_arrays;
+  GetRegionFlowFeatureArrays(*feature_list, &feature_arrays);
+  IrlsFeatureView features(feature_arrays);
+  GatherMixtureWeights(*feature_list, *row_weights_, &features);
+
   for (int r = 0; r < irls_rounds; ++r) {
     // Unpack solution to mixture homographies, if not full model.
     std::vector<float> solution_unpacked(8 * num_mixtures);
@@ -5141,9 +5210,11 @@ bool MotionEstimation::MixtureHomographyFromFeature(
 
     switch (mixture_mode) {
       case MotionEstimationOptions::FULL_MIXTURE:
-        if (!MixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
-                                         *row_weights_, regularizer, &matrix,
-                                         &solution)) {
+        if (!MixtureHomographyL2DLTSolve(features, num_mixtures, regularizer,
+                                         &matrix, &solution)) {
+          // Keep the weights of the previous rounds.
+          SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight,
+                                          feature_list);
           return false;
         }
         // No need to unpack solution.
@@ -5151,9 +5222,12 @@ bool MotionEstimation::MixtureHomographyFromFeature(
         break;
 
       case MotionEstimationOptions::TRANSLATION_MIXTURE:
-        if (!TransMixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
-                                              *row_weights_, regularizer,
-                                              &matrix, &solution)) {
+        if (!TransMixtureHomographyL2DLTSolve(features, num_mixtures,
+                                              regularizer, &matrix,
+                                              &solution)) {
+          // Keep the weights of the previous rounds.
+          SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight,
+                                          feature_list);
           return false;
         }
         {
@@ -5173,9 +5247,12 @@ bool MotionEstimation::MixtureHomographyFromFeature(
         break;
 
       case MotionEstimationOptions::SKEW_ROTATION_MIXTURE:
-        if (!SkewRotMixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
-                                                *row_weights_, regularizer,
-                                                &matrix, &solution)) {
+        if (!SkewRotMixtureHomographyL2DLTSolve(features, num_mixtures,
+                                                regularizer, &matrix,
+                                                &solution)) {
+          // Keep the weights of the previous rounds.
+          SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight,
+                                          feature_list);
           return false;
         }
         {
@@ -5205,25 +5282,25 @@ bool MotionEstimation::MixtureHomographyFromFeature(
     const float one_minus_alpha = 1.0f - alpha;
 
     // Evaluate IRLS error.
-    const auto feature_start = feature_list->mutable_feature()->begin();
-    for (auto feature = feature_start;
-         feature != feature_list->mutable_feature()->end(); ++feature) {
-      if (feature->irls_weight() == 0.0f) {
+    for (int k = 0; k < feature_arrays.size(); ++k) {
+      float& irls_weight = feature_arrays.irls_weight[k];
+      if (irls_weight == 0.0f) {
         continue;
       }
 
       // Residual is expressed in geometric difference, that is
       // for a point match (p<->q) with estimated homography p,
       // geometric difference is defined as Hp x q.
+      const Vector2_f location(feature_arrays.x[k], feature_arrays.y[k]);
       Vector2_f lhs = MixtureHomographyAdapter::TransformPoint(
-          norm_model, row_weights_->RowWeightsClamped(feature->y()),
-          FeatureLocation(*feature));
+          norm_model, row_weights_->RowWeightsClamped(location.y()), location);
       // Map to original coordinate system to evaluate error.
       lhs = LinearSimilarityAdapter::TransformPoint(irls_transform_, lhs);
 
       const Vector3_f lhs3(lhs.x(), lhs.y(), 1);
       const Vector2_f rhs = LinearSimilarityAdapter::TransformPoint(
-          irls_transform_, FeatureMatchLocation(*feature));
+          irls_transform_, Vector2_f(location.x() + feature_arrays.dx[k],
+                                     location.y() + feature_arrays.dy[k]));
 
       const Vector3_f rhs3(rhs.x(), rhs.y(), 1);
       const Vector3_f cross = lhs3.CrossProd(rhs3);
@@ -5233,18 +5310,19 @@ bool MotionEstimation::MixtureHomographyFromFeature(
 
       const float numerator =
           alpha == 0.0f ? 1.0f
-                        : ((*irls_priors)[feature - feature_start] * alpha +
-                           one_minus_alpha);
+                        : ((*irls_priors)[k] * alpha + one_minus_alpha);
 
       if (irls_use_l0_norm) {
-        feature->set_irls_weight(numerator / (cross2.Norm() + kIrlsEps));
+        irls_weight = numerator / (cross2.Norm() + kIrlsEps);
       } else {
-        feature->set_irls_weight(
+        irls_weight =
             numerator /
-            (std::sqrt(static_cast<double>(cross2.Norm())) + kIrlsEps));
+            (std::sqrt(static_cast<double>(cross2.Norm())) + kIrlsEps);
       }
     }
   }
+  // Write the weights of the last round back to the features.
+  SetRegionFlowFeatureIRLSWeights(feature_arrays.irls_weight, feature_list);
 
   // Undo pre_transform.
   *mix_homography = MixtureHomographyAdapter::ComposeLeft(
@@ -5269,6 +5347,45 @@ bool MotionEstimation::MixtureHomographyFromFeature(
   return true;
 }
 
+std::vector<float> MotionEstimation::MixtureHomographySolutionForTesting(
+    const RegionFlowFeatureList& feature_list) const {
+  const int num_mixtures = options_.num_mixtures();
+  int num_dof = 0;
+  int adjacency_constraints = 0;
+  MixtureSystemSize(options_.mixture_model_mode(), num_mixtures, &num_dof,
+                    &adjacency_constraints);
+  Eigen::MatrixXf matrix(
+      2 * feature_list.feature_size() + adjacency_constraints, num_dof);
+  Eigen::MatrixXf solution(num_dof, 1);
+
+  RegionFlowFeatureArrays feature_arrays;
+  GetRegionFlowFeatureArrays(feature_list, &feature_arrays);
+  IrlsFeatureView features(feature_arrays);
+  GatherMixtureWeights(feature_list, *row_weights_, &features);
+
+  // The precision check of the solvers is ignored on purpose.
+  switch (options_.mixture_model_mode()) {
+    case MotionEstimationOptions::FULL_MIXTURE:
+      MixtureHomographyL2DLTSolve(features, num_mixtures,
+                                  options_.mixture_regularizer(), &matrix,
+                                  &solution);
+      break;
+    case MotionEstimationOptions::TRANSLATION_MIXTURE:
+      TransMixtureHomographyL2DLTSolve(features, num_mixtures,
+                                       options_.mixture_regularizer(), &matrix,
+                                       &solution);
+      break;
+    case MotionEstimationOptions::SKEW_ROTATION_MIXTURE:
+      SkewRotMixtureHomographyL2DLTSolve(features, num_mixtures,
+                                         options_.mixture_regularizer(),
+                                         &matrix, &solution);
+      break;
+    default:
+      LOG(FATAL) << "Unknown MixtureModelMode specified.";
+  }
+  return std::vector<float>(solution.data(), solution.data() + num_dof);
+}
+
 bool MotionEstimation::EstimateMixtureHomographyIRLS(
     int irls_rounds, bool compute_stability, float regularizer,
     int spectrum_idx, const PriorFeatureWeights* prior_weights,
@@ -171,6 +171,13 @@ class MotionEstimation {
                                 bool flag_as_unstable_model,
                                 CameraMotion* camera_motion);
 
+  // Returns the solution of the first IRLS round of the linear system solved
+  // by EstimateMixtureHomography for options.mixture_model_mode(), whether or
+  // not the system could be solved. Used to test the mixture solvers on
+  // features for which the estimation fails.
+  std::vector<float> MixtureHomographySolutionForTesting(
+      const RegionFlowFeatureList& feature_list) const;
+
  private:
   // Simple enum indicating with motion model should be estimated, mapped from
   // MotionEstimationOptions.
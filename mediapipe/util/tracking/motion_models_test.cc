@@ -14,6 +14,9 @@
 
 #include "mediapipe/util/tracking/motion_models.h"
 
+#include <cmath>
+#include <vector>
+
 #include "mediapipe/framework/deps/message_matchers.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -331,5 +334,241 @@ TEST_F(MotionModelsTest, ProjectModels) {
   // TODO: Investigate how ProjectViaFit can yield similar result.
 }
 
+// Expects both models to map a grid over a 100 x 100 frame to within the
+// given tolerance (in pixels).
+template <class Model>
+void ExpectEqualTransforms(const Model& expected, const Model& actual,
+                           float tolerance) {
+  for (float y = 0; y <= 100; y += 20) {
+    for (float x = 0; x <= 100; x += 20) {
+      const Vector2_f expected_pt =
+          ModelAdapter<Model>::TransformPoint(expected, Vector2_f(x, y));
+      const Vector2_f actual_pt =
+          ModelAdapter<Model>::TransformPoint(actual, Vector2_f(x, y));
+      EXPECT_NEAR(expected_pt.x(), actual_pt.x(), tolerance);
+      EXPECT_NEAR(expected_pt.y(), actual_pt.y(), tolerance);
+    }
+  }
+}
+
+// The IRLS solvers build their systems from all features at once. Fits to
+// exact correspondences recover the model up to rounding.
+TEST_F(MotionModelsTest, FitModels) {
+  LinearSimilarityModel center_trans =
+      LinearSimilarityAdapter::FromArgs(50, 50, 1, 0);
+  LinearSimilarityModel inv_center_trans =
+      LinearSimilarityAdapter::FromArgs(-50, -50, 1, 0);
+
+  AffineModel affine = AffineAdapter::FromArgs(10, 20, 1.1, 0.1, -0.05, 0.9);
+  AffineModel affine_center =
+      ModelCompose3(LinearSimilarityAdapter::ToAffine(center_trans), affine,
+                    LinearSimilarityAdapter::ToAffine(inv_center_trans));
+  ExpectEqualTransforms(
+      affine_center, ProjectViaFit<AffineModel>(affine_center, 100, 100),
+      1e-2);
+
+  Homography homog =
+      HomographyAdapter::FromArgs(1.1, 0.1, 10, -0.05, 0.9, 20, 5e-4, 1e-4);
+  Homography homog_center =
+      ModelCompose3(HomographyAdapter::Embed(center_trans), homog,
+                    HomographyAdapter::Embed(inv_center_trans));
+  // Via normal equations.
+  ExpectEqualTransforms(
+      homog_center, ProjectViaFit<Homography>(homog_center, 100, 100), 1e-2);
+
+  // Via QR decomposition.
+  RegionFlowFeatureList grid_features;
+  grid_features.set_frame_width(100);
+  grid_features.set_frame_height(100);
+  for (int y = 0; y <= 100; y += 10) {
+    for (int x = 0; x <= 100; x += 10) {
+      auto* feature = grid_features.add_feature();
+      feature->set_x(x);
+      feature->set_y(y);
+    }
+  }
+  RegionFlowFeatureListViaTransform(homog_center, &grid_features, 1.0f, 0.0f,
+                                    false);
+  NormalizeRegionFlowFeatureList(&grid_features);
+
+  MotionEstimationOptions options;
+  options.set_irls_rounds(1);
+  MotionEstimation motion_estimation(options, 100, 100);
+  CameraMotion camera_motion;
+  ASSERT_TRUE(
+      motion_estimation.EstimateHomography(&grid_features, &camera_motion));
+  ExpectEqualTransforms(homog_center, camera_motion.homography(), 1e-2);
+
+  // Every model of a mixture fit to a global homography equals it.
+  grid_features.clear_feature();
+  for (int y = 5; y < 100; y += 10) {
+    for (int x = 5; x < 100; x += 10) {
+      auto* feature = grid_features.add_feature();
+      feature->set_x(x);
+      feature->set_y(y);
+      for (int d = 0; d < 10; ++d) {
+        feature->mutable_feature_descriptor()->add_data(((x + y + d) % 9) *
+                                                        0.05f);
+      }
+    }
+  }
+  RegionFlowFeatureListViaTransform(homog_center, &grid_features, 1.0f, 0.0f,
+                                    false);
+  NormalizeRegionFlowFeatureList(&grid_features);
+  options.set_mix_homography_estimation(
+      MotionEstimationOptions::ESTIMATION_HOMOG_MIX_IRLS);
+  MotionEstimation mixture_estimation(options, 100, 100);
+  MotionEstimation::ResetMotionModels(options, &camera_motion);
+  ASSERT_TRUE(mixture_estimation.EstimateMixtureHomography(&grid_features,
+                                                           &camera_motion));
+  ASSERT_GT(camera_motion.mixture_homography().model_size(), 0);
+  for (const Homography& model : camera_motion.mixture_homography().model()) {
+    ExpectEqualTransforms(homog_center, model, 0.1f);
+  }
+}
+
+// Returns normalized features on a 100 x 100 frame, moving by a homography
+// plus a row dependent shift (as from a rolling shutter), with small
+// deterministic perturbations, a few outliers and varying weights.
+RegionFlowFeatureList MakeNoisyFeatures() {
+  RegionFlowFeatureList features;
+  features.set_frame_width(100);
+  features.set_frame_height(100);
+  const Homography homog =
+      HomographyAdapter::FromArgs(1.02, 0.03, 4, -0.02, 0.98, -3, 2e-4, -1e-4);
+  int idx = 0;
+  for (int y = 2; y < 100; y += 5) {
+    for (int x = 3; x < 100; x += 7, ++idx) {
+      RegionFlowFeature* feature = features.add_feature();
+      feature->set_x(x);
+      feature->set_y(y);
+      const Vector2_f match =
+          HomographyAdapter::TransformPoint(homog, Vector2_f(x, y));
+      const float shift = 0.5f * std::sin(y * 0.08f);
+      const float noise_x = ((idx * 37) % 11 - 5) * 0.01f;
+      const float noise_y = ((idx * 53) % 13 - 6) * 0.01f;
+      const bool outlier = idx % 17 == 0;
+      feature->set_dx(match.x() - x + shift + noise_x + (outlier ? 4 : 0));
+      feature->set_dy(match.y() - y + noise_y - (outlier ? 3 : 0));
+      feature->set_irls_weight(0.5f + (idx % 7) * 0.1f);
+      for (int d = 0; d < 10; ++d) {
+        feature->mutable_feature_descriptor()->add_data(((idx + d) % 9) *
+                                                        0.05f);
+      }
+    }
+  }
+  NormalizeRegionFlowFeatureList(&features);
+  return features;
+}
+
+// Compares the IRLS solvers on noisy features against outputs recorded
+// before their systems were vectorized. Only float normal equations differ
+// beyond rounding, since they sum in a different order.
+TEST_F(MotionModelsTest, IrlsSolversMatchRecordedOutputs) {
+  MotionEstimationOptions options;
+  CameraMotion camera_motion;
+  RegionFlowFeatureList features = MakeNoisyFeatures();
+  ASSERT_TRUE(MotionEstimation(options, 100, 100)
+                  .EstimateAffineModel(&features, &camera_motion));
+  ExpectEqualTransforms(
+      AffineAdapter::FromArgs(4.5330987, -2.80245996, 1.00259614, 0.0317979604,
+                              -0.027173968, 0.979427099),
+      camera_motion.affine(), 1e-2);
+
+  struct HomographyCase {
+    bool use_exact_homography_estimation;
+    bool use_highest_accuracy_for_normal_equations;
+    Homography expected;
+  };
+  const HomographyCase homography_cases[] = {
+      // Normal equations in float.
+      {false, false,
+       HomographyAdapter::FromArgs(1.01878929, 0.0261503477, 4.34112787,
+                                   -0.0201931708, 0.978046536, -2.97190952,
+                                   0.000196286725, -0.0001191927)},
+      // Normal equations in double.
+      {false, true,
+       HomographyAdapter::FromArgs(1.01879716, 0.0261544865, 4.34102964,
+                                   -0.0201898832, 0.978059232, -2.97218728,
+                                   0.000196349851, -0.000119083241)},
+      // QR decomposition.
+      {true, true,
+       HomographyAdapter::FromArgs(1.01908088, 0.026232481, 4.43715668,
+                                   -0.0192352515, 0.976190269, -2.97416997,
+                                   0.000210272949, -0.000141951168)},
+  };
+  for (const HomographyCase& test_case : homography_cases) {
+    options.set_use_exact_homography_estimation(
+        test_case.use_exact_homography_estimation);
+    options.set_use_highest_accuracy_for_normal_equations(
+        test_case.use_highest_accuracy_for_normal_equations);
+    features = MakeNoisyFeatures();
+    ASSERT_TRUE(MotionEstimation(options, 100, 100)
+                    .EstimateHomography(&features, &camera_motion));
+    ExpectEqualTransforms(test_case.expected, camera_motion.homography(),
+                          1e-2);
+  }
+
+  options = MotionEstimationOptions();
+  options.set_mix_homography_estimation(
+      MotionEstimationOptions::ESTIMATION_HOMOG_MIX_IRLS);
+  // The full and translation mixture systems were rejected for these
+  // features before vectorization, and still are. Their solutions are
+  // compared instead, which only have two non-zero coefficients (see the note
+  // in MixtureHomographyL2DLTSolve).
+  struct MixtureCase {
+    MotionEstimationOptions::MixtureModelMode mode;
+    int num_dof;
+    float expected[2];
+  };
+  const MixtureCase mixture_cases[] = {
+      {MotionEstimationOptions::FULL_MIXTURE, 80,
+       {0.0437238514, -0.000753085129}},
+      {MotionEstimationOptions::TRANSLATION_MIXTURE, 26,
+       {0.180257678, 0.140660077}},
+  };
+  for (const MixtureCase& test_case : mixture_cases) {
+    options.set_mixture_model_mode(test_case.mode);
+    features = MakeNoisyFeatures();
+    MotionEstimation::ResetMotionModels(options, &camera_motion);
+    EXPECT_FALSE(MotionEstimation(options, 100, 100)
+                     .EstimateMixtureHomography(&features, &camera_motion));
+
+    const std::vector<float> solution =
+        MotionEstimation(options, 100, 100)
+            .MixtureHomographySolutionForTesting(MakeNoisyFeatures());
+    ASSERT_EQ(test_case.num_dof, solution.size());
+    EXPECT_NEAR(test_case.expected[0], solution[0], 1e-6);
+    EXPECT_NEAR(test_case.expected[1], solution[1], 1e-6);
+    for (int i = 2; i < solution.size(); ++i) {
+      EXPECT_EQ(0, solution[i]) << "Coefficient " << i;
+    }
+  }
+
+  options.set_mixture_model_mode(
+      MotionEstimationOptions::SKEW_ROTATION_MIXTURE);
+  features = MakeNoisyFeatures();
+  MotionEstimation::ResetMotionModels(options, &camera_motion);
+  ASSERT_TRUE(MotionEstimation(options, 100, 100)
+                  .EstimateMixtureHomography(&features, &camera_motion));
+  const MixtureHomography& mixture = camera_motion.mixture_homography();
+  ASSERT_EQ(10, mixture.model_size());
+  ExpectEqualTransforms(
+      HomographyAdapter::FromArgs(1.02002692, 0.0508558899, 3.85329771,
+                                  -0.0179401748, 0.983037293, -3.08509803,
+                                  0.00020015621, -0.000101306505),
+      mixture.model(0), 1e-2);
+  ExpectEqualTransforms(
+      HomographyAdapter::FromArgs(1.02002692, 0.0455348082, 2.96649647,
+                                  -0.0189151838, 0.983037293, -3.17747593,
+                                  0.00020015621, -0.000101306505),
+      mixture.model(4), 1e-2);
+  ExpectEqualTransforms(
+      HomographyAdapter::FromArgs(1.02002692, 0.0459316596, 2.98398066,
+                                  -0.0210811365, 0.983037293, -3.26956701,
+                                  0.00020015621, -0.000101306505),
+      mixture.model(9), 1e-2);
+}
+
 }  // namespace
 }  // namespace mediapipe
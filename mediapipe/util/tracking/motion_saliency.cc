@@ -673,10 +673,13 @@ void ForegroundWeightsFromFeatures(const RegionFlowFeatureList& feature_list,
 
   const float weight_denom = 1.0f / foreground_threshold;
 
+  weights->reserve(feature_list.feature_size());
+
   // Map weights to foreground measure and determine minimum irls weight.
   for (const auto& feature : feature_list.feature()) {
+    const float irls_weight = feature.irls_weight();
     // Skip marked outliers.
-    if (feature.irls_weight() == 0) {
+    if (irls_weight == 0) {
       weights->push_back(0.0f);
       continue;
     }
@@ -685,7 +688,7 @@ void ForegroundWeightsFromFeatures(const RegionFlowFeatureList& feature_list,
     // with values below weight_denom assigned linearly mapped (zero is mapped
     // ot 1). Avoid mapping to zero as it used to mark outliers.
     const float foreground_measure =
-        std::max(0.0f, 1.0f - feature.irls_weight() * weight_denom);
+        std::max(0.0f, 1.0f - irls_weight * weight_denom);
 
     if (std::abs(foreground_gamma - 1.0f) < 1e-3f) {
       weights->push_back(std::max(kEpsilon, foreground_measure));
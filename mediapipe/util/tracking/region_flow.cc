@@ -221,6 +221,26 @@ void SetRegionFlowFeatureIRLSWeights(const std::vector<float>& irls_weights,
   }
 }
 
+void GetRegionFlowFeatureArrays(const RegionFlowFeatureList& flow_feature_list,
+                                RegionFlowFeatureArrays* arrays) {
+  CHECK(arrays != nullptr);
+  const int num_features = flow_feature_list.feature_size();
+  arrays->x.resize(num_features);
+  arrays->y.resize(num_features);
+  arrays->dx.resize(num_features);
+  arrays->dy.resize(num_features);
+  arrays->irls_weight.resize(num_features);
+  int idx = 0;
+  for (const auto& feature : flow_feature_list.feature()) {
+    arrays->x[idx] = feature.x();
+    arrays->y[idx] = feature.y();
+    arrays->dx[idx] = feature.dx();
+    arrays->dy[idx] = feature.dy();
+    arrays->irls_weight[idx] = feature.irls_weight();
+    ++idx;
+  }
+}
+
 int CountIgnoredRegionFlowFeatures(
     const RegionFlowFeatureList& flow_feature_list, float threshold) {
   int count = 0;
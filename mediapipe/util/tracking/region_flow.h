@@ -146,6 +146,26 @@ void GetRegionFlowFeatureIRLSWeights(
 void SetRegionFlowFeatureIRLSWeights(const std::vector<float>& irls_weights,
                                      RegionFlowFeatureList* flow_feature_list);
 
+// Struct of arrays holding the locations, flow and irls weights of the
+// features in a RegionFlowFeatureList, where index i refers to feature(i).
+// Per feature loops over these arrays run on contiguous memory instead of
+// proto accessors, and can be vectorized. Stages convert from and to the
+// proto only at their boundaries.
+struct RegionFlowFeatureArrays {
+  int size() const { return x.size(); }
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> dx;
+  std::vector<float> dy;
+  std::vector<float> irls_weight;
+};
+
+// Copies all features of flow_feature_list into arrays. Irls weights are
+// written back via SetRegionFlowFeatureIRLSWeights(arrays.irls_weight, ...).
+void GetRegionFlowFeatureArrays(const RegionFlowFeatureList& flow_feature_list,
+                                RegionFlowFeatureArrays* arrays);
+
 // Counts number of region flow features with an irls weight of less than or
 // equal to threshold.
 int CountIgnoredRegionFlowFeatures(
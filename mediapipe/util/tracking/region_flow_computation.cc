@@ -284,7 +284,9 @@ struct RegionFlowComputation::FrameTrackingData {
   cv::Mat frame;
 
   // Pyramid used for tracking. Just contains the a single image if old
-  // c-interface is used.
+  // c-interface is used. Built once by InitFrame, and reused for every pair
+  // the frame is tracked in while it is in data_queue_. Its buffers are reused
+  // when the FrameTrackingData is recycled for a later frame.
   std::vector<cv::Mat> pyramid;
   cv::Mat blur_data;
   cv::Mat tiny_image;  // Used if visual consistency verification is performed.
@@ -2496,6 +2498,64 @@ int RegionFlowComputation::InplaceFeatureSelection(
   return num_selected_features;
 }
 
+#if CV_MAJOR_VERSION == 3
+namespace {
+
+// Same as cv::calcOpticalFlowPyrLK, but tracks the features in batches of
+// batch_size, using ParallelFor. Each feature is tracked independently of the
+// others, so the results match a single call. A batch_size of zero tracks all
+// features in one call. Otherwise both frames must be pyramids, so that they
+// are not rebuilt for every batch.
+void ParallelCalcOpticalFlowPyrLK(const cv::_InputArray& frame1,
+                                  const cv::_InputArray& frame2,
+                                  const std::vector<cv::Point2f>& features1,
+                                  std::vector<cv::Point2f>* features2,
+                                  std::vector<uint8>* status,
+                                  std::vector<float>* error,
+                                  const cv::Size& window_size, int max_level,
+                                  const cv::TermCriteria& criteria, int flags,
+                                  int batch_size) {
+  const int num_features = features1.size();
+  if (batch_size <= 0 || num_features <= batch_size) {
+    cv::calcOpticalFlowPyrLK(frame1, frame2, features1, *features2, *status,
+                             *error, window_size, max_level, criteria, flags);
+    return;
+  }
+
+  DCHECK_EQ(frame1.kind(), cv::_InputArray::STD_VECTOR_MAT);
+  DCHECK_EQ(frame2.kind(), cv::_InputArray::STD_VECTOR_MAT);
+  features2->resize(num_features);
+  status->resize(num_features);
+  error->resize(num_features);
+  const int num_batches = (num_features + batch_size - 1) / batch_size;
+  ParallelFor(0, num_batches, 1, [&](const BlockedRange& range) {
+    std::vector<cv::Point2f> batch_features1;
+    std::vector<cv::Point2f> batch_features2;
+    std::vector<uint8> batch_status;
+    std::vector<float> batch_error;
+    for (int b = range.begin(); b < range.end(); ++b) {
+      const int begin = b * batch_size;
+      const int end = std::min(num_features, begin + batch_size);
+      batch_features1.assign(features1.begin() + begin,
+                             features1.begin() + end);
+      batch_features2.assign(features2->begin() + begin,
+                             features2->begin() + end);
+      cv::calcOpticalFlowPyrLK(frame1, frame2, batch_features1,
+                               batch_features2, batch_status, batch_error,
+                               window_size, max_level, criteria, flags);
+      std::copy(batch_features2.begin(), batch_features2.end(),
+                features2->begin() + begin);
+      std::copy(batch_status.begin(), batch_status.end(),
+                status->begin() + begin);
+      std::copy(batch_error.begin(), batch_error.end(),
+                error->begin() + begin);
+    }
+  });
+}
+
+}  // namespace.
+#endif
+
 void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
                                           FrameTrackingData* to_data_ptr,
                                           bool* gain_correction_ptr,
@@ -2601,19 +2661,28 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
   if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION == 3
     if (gain_correction) {
+      // Single calls track on the plain image, which calcOpticalFlowPyrLK
+      // turns into a pyramid itself. Batched calls share a pyramid built the
+      // same way, so that tracking results do not change.
+      cv::_InputArray gain_frame(*gain_image_);
+      if (options_.tracking_options().tracking_batch_size() > 0) {
+        cv::buildOpticalFlowPyramid(*gain_image_, gain_cv_pyramid_,
+                                    cv_window_size, pyramid_levels_, false);
+        gain_frame = cv::_InputArray(gain_cv_pyramid_);
+      }
       if (!frame1_gain_reference) {
-        input_frame1 = cv::_InputArray(*gain_image_);
+        input_frame1 = gain_frame;
       } else {
-        input_frame2 = cv::_InputArray(*gain_image_);
+        input_frame2 = gain_frame;
       }
     }
 
     if (options_.tracking_options().klt_tracker_implementation() ==
         TrackingOptions::KLT_OPENCV) {
-      cv::calcOpticalFlowPyrLK(input_frame1, input_frame2, features1, features2,
-                               feature_status_, feature_track_error_,
-                               cv_window_size, pyramid_levels_, cv_criteria,
-                               tracking_flags);
+      ParallelCalcOpticalFlowPyrLK(
+          input_frame1, input_frame2, features1, &features2, &feature_status_,
+          &feature_track_error_, cv_window_size, pyramid_levels_, cv_criteria,
+          tracking_flags, options_.tracking_options().tracking_batch_size());
     } else {
       LOG(ERROR) << "Tracking method unspecified.";
       return;
@@ -2789,10 +2858,11 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION == 3
-      cv::calcOpticalFlowPyrLK(input_frame2, input_frame1, verify_features,
-                               verify_features_tracked, feature_status_,
-                               verify_track_error, cv_window_size,
-                               pyramid_levels_, cv_criteria, tracking_flags);
+      ParallelCalcOpticalFlowPyrLK(
+          input_frame2, input_frame1, verify_features, &verify_features_tracked,
+          &feature_status_, &verify_track_error, cv_window_size,
+          pyramid_levels_, cv_criteria, tracking_flags,
+          options_.tracking_options().tracking_batch_size());
 #endif
     } else {
       LOG(ERROR) << "only cv tracking is supported.";
@@ -418,6 +418,10 @@ class RegionFlowComputation {
   // Gain adapted version.
   std::unique_ptr<cv::Mat> gain_image_;
   std::unique_ptr<cv::Mat> gain_pyramid_;
+  // Tracking pyramid of gain_image_ for batched cv tracking, shared by the
+  // forward and the verification pass of each TrackFeatures call. The buffers
+  // are reused across calls.
+  std::vector<cv::Mat> gain_cv_pyramid_;
 
   // Temporary buffers.
   std::unique_ptr<cv::Mat> corner_values_;
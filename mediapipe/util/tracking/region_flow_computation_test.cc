@@ -24,6 +24,7 @@
 #include "absl/flags/flag.h"
 #include "absl/time/clock.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/logging.h"
@@ -32,12 +33,15 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 
 // To ensure that the selected thresholds are robust, it is recommend
 // to run this test mutiple times with time seed, if changes are made.
 ABSL_FLAG(bool, time_seed, false, "Activate to test thresholds");
+ABSL_FLAG(int, region_flow_threads, 4,
+          "Number of parallel invoker threads for BM_RegionFlowComputation");
 
 namespace mediapipe {
 namespace {
@@ -300,5 +304,98 @@ TEST_P(RegionFlowComputationTest, ResolutionTests) {
   }
 }
 
+TEST_P(RegionFlowComputationTest, BatchedTrackingMatchesSingleCall) {
+  std::vector<cv::Mat> movie;
+  std::vector<Vector2_f> positions;
+  const int num_frames = 5;
+  MakeMovie(num_frames, RegionFlowComputationOptions::FORMAT_RGB, &movie,
+            &positions);
+
+  // Exercise the backward verification and the gain corrected frame, which
+  // single calls track as a plain image and batches as a pre-built pyramid.
+  base_options_.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  base_options_.set_verify_features(true);
+  base_options_.set_gain_correction(true);
+  RegionFlowComputationOptions single_options = base_options_;
+  single_options.mutable_tracking_options()->set_tracking_batch_size(0);
+  RegionFlowComputationOptions batched_options = base_options_;
+  batched_options.mutable_tracking_options()->set_tracking_batch_size(16);
+
+  const int frame_width = movie[0].cols;
+  const int frame_height = movie[0].rows;
+  RegionFlowComputation single(single_options, frame_width, frame_height);
+  RegionFlowComputation batched(batched_options, frame_width, frame_height);
+  for (int i = 0; i < num_frames; ++i) {
+    single.AddImage(movie[i], 0);
+    batched.AddImage(movie[i], 0);
+    if (i == 0) {
+      continue;
+    }
+    std::unique_ptr<RegionFlowFeatureList> single_features(
+        single.RetrieveRegionFlowFeatureList(false, false, nullptr, nullptr));
+    std::unique_ptr<RegionFlowFeatureList> batched_features(
+        batched.RetrieveRegionFlowFeatureList(false, false, nullptr, nullptr));
+    EXPECT_GT(single_features->feature_size(), 16);
+    ASSERT_EQ(single_features->feature_size(),
+              batched_features->feature_size());
+    for (int k = 0; k < single_features->feature_size(); ++k) {
+      const auto& expected = single_features->feature(k);
+      const auto& actual = batched_features->feature(k);
+      EXPECT_EQ(expected.x(), actual.x());
+      EXPECT_EQ(expected.y(), actual.y());
+      EXPECT_EQ(expected.dx(), actual.dx());
+      EXPECT_EQ(expected.dy(), actual.dy());
+    }
+  }
+}
+
+// Tracks a 1080p video of shifted frames, and reports frames per second for
+// single call and batched tracking. The parallel invoker's thread pool is
+// created once per process, so compare thread counts across runs, e.g.
+//   --gtest_filter=-* --benchmark_filter=all --region_flow_threads=8
+void BM_RegionFlowComputation(benchmark::State& state) {
+  flags_parallel_invoker_max_threads = absl::GetFlag(FLAGS_region_flow_threads);
+  std::string png_data;
+  MEDIAPIPE_CHECK_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/",
+                     "stabilize_test.png"),
+      &png_data));
+  std::vector<char> buffer(png_data.begin(), png_data.end());
+  cv::Mat image = cv::imdecode(cv::Mat(buffer), 1);
+  const int border = 40;
+  cv::resize(image, image, cv::Size(1920 + 2 * border, 1080 + 2 * border));
+
+  const int num_frames = 30;
+  RandomEngine random(900913);
+  std::uniform_int_distribution<> uniform_dist(0, 2 * border);
+  std::vector<cv::Mat> movie(num_frames);
+  for (auto& frame : movie) {
+    const int x = uniform_dist(random);
+    const int y = uniform_dist(random);
+    image(cv::Range(y, y + 1080), cv::Range(x, x + 1920)).copyTo(frame);
+  }
+
+  RegionFlowComputationOptions options;
+  options.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+  options.set_verify_features(true);
+  options.mutable_tracking_options()->set_tracking_batch_size(state.range(0));
+  for (auto _ : state) {
+    RegionFlowComputation flow_computation(options, 1920, 1080);
+    for (const cv::Mat& frame : movie) {
+      flow_computation.AddImage(frame, 0);
+      delete flow_computation.RetrieveRegionFlow();
+    }
+  }
+  state.counters["fps"] = benchmark::Counter(
+      state.iterations() * num_frames, benchmark::Counter::kIsRate);
+  state.counters["threads"] = flags_parallel_invoker_max_threads;
+}
+BENCHMARK(BM_RegionFlowComputation)
+    ->ArgName("batch_size")
+    ->Arg(0)
+    ->Arg(256)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace mediapipe
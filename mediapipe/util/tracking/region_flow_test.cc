@@ -0,0 +1,70 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/region_flow.h"
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(RegionFlowFeatureArraysTest, RoundTripsFeatures) {
+  RegionFlowFeatureList feature_list;
+  for (int k = 0; k < 5; ++k) {
+    RegionFlowFeature* feature = feature_list.add_feature();
+    feature->set_x(10.0f * k);
+    feature->set_y(20.0f * k + 1);
+    feature->set_dx(0.5f * k - 1);
+    feature->set_dy(-0.25f * k);
+    feature->set_irls_weight(1.0f + k);
+  }
+
+  RegionFlowFeatureArrays arrays;
+  GetRegionFlowFeatureArrays(feature_list, &arrays);
+  ASSERT_EQ(feature_list.feature_size(), arrays.size());
+  for (int k = 0; k < arrays.size(); ++k) {
+    const RegionFlowFeature& feature = feature_list.feature(k);
+    EXPECT_EQ(feature.x(), arrays.x[k]);
+    EXPECT_EQ(feature.y(), arrays.y[k]);
+    EXPECT_EQ(feature.dx(), arrays.dx[k]);
+    EXPECT_EQ(feature.dy(), arrays.dy[k]);
+    EXPECT_EQ(feature.irls_weight(), arrays.irls_weight[k]);
+  }
+
+  // Weights updated in the arrays are written back to the features, which are
+  // otherwise unchanged.
+  const RegionFlowFeatureList original = feature_list;
+  for (float& irls_weight : arrays.irls_weight) {
+    irls_weight *= 0.5f;
+  }
+  SetRegionFlowFeatureIRLSWeights(arrays.irls_weight, &feature_list);
+  for (int k = 0; k < feature_list.feature_size(); ++k) {
+    const RegionFlowFeature& feature = feature_list.feature(k);
+    EXPECT_EQ(0.5f * original.feature(k).irls_weight(), feature.irls_weight());
+    EXPECT_EQ(original.feature(k).x(), feature.x());
+    EXPECT_EQ(original.feature(k).y(), feature.y());
+    EXPECT_EQ(original.feature(k).dx(), feature.dx());
+    EXPECT_EQ(original.feature(k).dy(), feature.dy());
+  }
+
+  // Arrays are resized to the features on reuse.
+  feature_list.mutable_feature()->RemoveLast();
+  GetRegionFlowFeatureArrays(feature_list, &arrays);
+  EXPECT_EQ(4, arrays.size());
+  EXPECT_EQ(4, arrays.irls_weight.size());
+}
+
+}  // namespace
+}  // namespace mediapipe